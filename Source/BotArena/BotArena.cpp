@@ -2,9 +2,35 @@
 
 #include "BotArena.h"
 #include "LogBotArena.h"
+#include "GenericTeamAgentInterface.h"
 #include "Modules/ModuleManager.h"
 
 // Define the log category declared in LogBotArena.h
 DEFINE_LOG_CATEGORY(LogBotArena);
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, BotArena, "BotArena" );
+// Bots of the same team are friends, bots of different teams are enemies, and anything without a team is neutral
+static ETeamAttitude::Type SolveBotTeamAttitude(FGenericTeamId A, FGenericTeamId B)
+{
+    if (A == FGenericTeamId::NoTeam || B == FGenericTeamId::NoTeam)
+    {
+        return ETeamAttitude::Neutral;
+    }
+
+    return A == B ? ETeamAttitude::Friendly : ETeamAttitude::Hostile;
+}
+
+void FBotArenaModule::StartupModule()
+{
+    FDefaultGameModuleImpl::StartupModule();
+
+    FGenericTeamId::SetAttitudeSolver(&SolveBotTeamAttitude);
+}
+
+void FBotArenaModule::ShutdownModule()
+{
+    FGenericTeamId::ResetAttitudeSolver();
+
+    FDefaultGameModuleImpl::ShutdownModule();
+}
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FBotArenaModule, BotArena, "BotArena" );
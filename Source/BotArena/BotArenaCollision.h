@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Custom collision channels, declared in the [/Script/Engine.CollisionProfile] section of DefaultEngine.ini.
+// The slot numbers must match the ini.
+
+// Object type of the bot capsules
+#define ECC_BotCapsule ECC_GameTraceChannel1
+
+// Object type of the projectiles fired by the bots
+#define ECC_BotProjectile ECC_GameTraceChannel2
+
+// Object type of the pickup triggers
+#define ECC_Pickup ECC_GameTraceChannel3
+
+// Trace channel for line of sight. Blocked by the level geometry and the bots, ignored by projectiles and pickups
+#define ECC_LOSBlocker ECC_GameTraceChannel4
+
+// Collision profiles using the channels above
+namespace BotArenaCollisionProfiles
+{
+    static const FName BotCapsule(TEXT("BotCapsule"));
+    static const FName BotProjectile(TEXT("BotProjectile"));
+    static const FName Pickup(TEXT("Pickup"));
+}
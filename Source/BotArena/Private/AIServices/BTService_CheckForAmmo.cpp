@@ -5,6 +5,7 @@
 #include "Controllers/BotController.h"
 #include "Components/BotWeaponComponent.h"
 #include "Components/BotBehaviorComponent.h"
+#include "Subsystems/BotAmmoRegistrySubsystem.h"
 
 void UBTService_CheckForAmmo::TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
 {
@@ -37,6 +38,15 @@ void UBTService_CheckForAmmo::TickNode(UBehaviorTreeComponent& OwnerComp, uint8*
         IsLowOnAmmo = Bot->LowOnAmmo();
     }
 
+    // A bot that got enough ammo doesn't need its ammo box anymore
+    if (!IsLowOnAmmo)
+    {
+        if (UBotAmmoRegistrySubsystem* AmmoRegistry = UWorld::GetSubsystem<UBotAmmoRegistrySubsystem>(Bot->GetWorld()))
+        {
+            AmmoRegistry->ReleaseReservation(Bot);
+        }
+    }
+
     // Update the blackboard value
     UBotBehaviorComponent* BehaviorComponent = BotController->GetBotBehaviorComponent();
     if (BehaviorComponent)
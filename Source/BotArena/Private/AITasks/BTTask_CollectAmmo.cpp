@@ -4,8 +4,7 @@
 #include "Characters/AICharacter.h"
 #include "Controllers/BotController.h"
 #include "Components/BotBehaviorComponent.h"
-#include "CollisionQueryParams.h"
-#include "WorldCollision.h"
+#include "Subsystems/BotAmmoRegistrySubsystem.h"
 #include "Engine/World.h"
 #include "MiscClasses/AmmoBox.h"
 
@@ -13,52 +12,42 @@ EBTNodeResult::Type UBTTask_CollectAmmo::ExecuteTask(UBehaviorTreeComponent& Own
 {
     Super::ExecuteTask(OwnerComp, NodeMemory);
 
-    AActor* Bot = OwnerComp.GetOwner();
-    if (!Bot)
+    ABotController* BotController = Cast<ABotController>(OwnerComp.GetAIOwner());
+    if (!BotController)
     {
         return EBTNodeResult::Failed;
     }
 
-    // Set up collision parameters
-    FCollisionObjectQueryParams CollisionObjectParams = FCollisionObjectQueryParams(ECollisionChannel::ECC_WorldDynamic);
-
-    FCollisionShape CollisionShape = FCollisionShape();
-    CollisionShape.ShapeType = ECollisionShape::Sphere;
-    CollisionShape.SetSphere(SearchRadius);
-
-    TArray<FHitResult> OutHits;
+    APawn* Bot = BotController->GetPawn();
+    if (!Bot)
+    {
+        return EBTNodeResult::Failed;
+    }
 
-    ABotController* BotController = Cast<ABotController>(OwnerComp.GetAIOwner());
-    if (!BotController)
+    UBotAmmoRegistrySubsystem* AmmoRegistry = UWorld::GetSubsystem<UBotAmmoRegistrySubsystem>(GetWorld());
+    if (!AmmoRegistry)
     {
         return EBTNodeResult::Failed;
     }
 
-    // Perform a Sphere Sweep with the according radius to find a nearby Ammo box
-    if (GetWorld()->SweepMultiByObjectType(OutHits, Bot->GetActorLocation(), Bot->GetActorLocation() + FVector(150.f), FQuat(), CollisionObjectParams, CollisionShape))
+    // Find the closest ammo box that no other bot is heading to and claim it
+    AAmmoBox* Box = AmmoRegistry->FindNearestAvailable(Bot, SearchRadius);
+    if (!Box || !AmmoRegistry->Reserve(Box, Bot))
     {
-        for (int32 Hit = 0; Hit < OutHits.Num(); Hit++)
-        {
-            if (OutHits[Hit].GetActor() && Cast<AAmmoBox>(OutHits[Hit].GetActor()))
-            {
-                AAmmoBox* Box = Cast<AAmmoBox>(OutHits[Hit].GetActor());
-                
-                // Try to use the behavior component first
-                UBotBehaviorComponent* BehaviorComponent = BotController->GetBotBehaviorComponent();
-                if (BehaviorComponent)
-                {
-                    BehaviorComponent->SetAmmoBox(Box);
-                }
-                else
-                {
-                    // Fall back to the controller method for backward compatibility
-                    BotController->SetAmmoBox(Box);
-                }
+        return EBTNodeResult::Failed;
+    }
 
-                return EBTNodeResult::Succeeded;
-            }
-        }
+    // Try to use the behavior component first
+    UBotBehaviorComponent* BehaviorComponent = BotController->GetBotBehaviorComponent();
+    if (BehaviorComponent)
+    {
+        BehaviorComponent->SetAmmoBox(Box);
+    }
+    else
+    {
+        // Fall back to the controller method for backward compatibility
+        BotController->SetAmmoBox(Box);
     }
 
-    return EBTNodeResult::Failed;
+    return EBTNodeResult::Succeeded;
 }
\ No newline at end of file
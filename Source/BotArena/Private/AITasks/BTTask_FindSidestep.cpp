@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AITasks/BTTask_FindSidestep.h"
+#include "AIController.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Vector.h"
+#include "Characters/AICharacter.h"
+#include "Controllers/BotController.h"
+#include "Subsystems/BotSidestepSubsystem.h"
+
+UBTTask_FindSidestep::UBTTask_FindSidestep(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+    bNotifyTick = true;
+
+    SidestepLocationKey.AddVectorFilter(this, GET_MEMBER_NAME_CHECKED(UBTTask_FindSidestep, SidestepLocationKey));
+}
+
+uint16 UBTTask_FindSidestep::GetInstanceMemorySize() const
+{
+    return sizeof(FBTFindSidestepMemory);
+}
+
+void UBTTask_FindSidestep::InitializeFromAsset(UBehaviorTree& Asset)
+{
+    Super::InitializeFromAsset(Asset);
+
+    if (UBlackboardData* BBAsset = GetBlackboardAsset())
+    {
+        SidestepLocationKey.ResolveSelectedKey(*BBAsset);
+    }
+}
+
+EBTNodeResult::Type UBTTask_FindSidestep::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+    FBTFindSidestepMemory* Memory = CastInstanceNodeMemory<FBTFindSidestepMemory>(NodeMemory);
+    Memory->RequestId = 0;
+
+    ABotController* BotController = Cast<ABotController>(OwnerComp.GetAIOwner());
+    if (!BotController)
+    {
+        return EBTNodeResult::Failed;
+    }
+
+    AAICharacter* Bot = Cast<AAICharacter>(BotController->GetPawn());
+    if (!Bot)
+    {
+        return EBTNodeResult::Failed;
+    }
+
+    UBotSidestepSubsystem* Sidestep = UWorld::GetSubsystem<UBotSidestepSubsystem>(GetWorld());
+    if (!Sidestep)
+    {
+        return EBTNodeResult::Failed;
+    }
+
+    FBotSidestepParams Params;
+    Params.PointsDistance = PointsDistance;
+    Params.DegreesGap = DegreesGap;
+    Params.AngleStep = AngleStep;
+    Params.MaxRange = MaxRange;
+    Params.AllySpacing = AllySpacing;
+
+    Memory->RequestId = Sidestep->RequestSidestep(Bot, BotController->GetSelectedTarget(), Params);
+
+    return Memory->RequestId != 0 ? EBTNodeResult::InProgress : EBTNodeResult::Failed;
+}
+
+void UBTTask_FindSidestep::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
+{
+    FBTFindSidestepMemory* Memory = CastInstanceNodeMemory<FBTFindSidestepMemory>(NodeMemory);
+
+    UBotSidestepSubsystem* Sidestep = UWorld::GetSubsystem<UBotSidestepSubsystem>(GetWorld());
+    if (!Sidestep)
+    {
+        FinishLatentTask(OwnerComp, EBTNodeResult::Failed);
+        return;
+    }
+
+    FVector SidestepLocation;
+    const EBotSidestepStatus Status = Sidestep->PollSidestep(Memory->RequestId, SidestepLocation);
+    if (Status == EBotSidestepStatus::Pending)
+    {
+        return;
+    }
+
+    Memory->RequestId = 0;
+
+    UBlackboardComponent* BlackboardComp = OwnerComp.GetBlackboardComponent();
+    if (Status != EBotSidestepStatus::Succeeded || !BlackboardComp)
+    {
+        FinishLatentTask(OwnerComp, EBTNodeResult::Failed);
+        return;
+    }
+
+    BlackboardComp->SetValue<UBlackboardKeyType_Vector>(SidestepLocationKey.GetSelectedKeyID(), SidestepLocation);
+    FinishLatentTask(OwnerComp, EBTNodeResult::Succeeded);
+}
+
+EBTNodeResult::Type UBTTask_FindSidestep::AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+    FBTFindSidestepMemory* Memory = CastInstanceNodeMemory<FBTFindSidestepMemory>(NodeMemory);
+
+    if (UBotSidestepSubsystem* Sidestep = UWorld::GetSubsystem<UBotSidestepSubsystem>(GetWorld()))
+    {
+        Sidestep->CancelSidestep(Memory->RequestId);
+    }
+    Memory->RequestId = 0;
+
+    return Super::AbortTask(OwnerComp, NodeMemory);
+}
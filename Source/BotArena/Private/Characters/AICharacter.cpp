@@ -6,12 +6,18 @@
 #include "Components/BotTeamComponent.h"
 #include "Components/BotMovementComponent.h"
 #include "Controllers/BotController.h"
+#include "Subsystems/BotRegistrySubsystem.h"
+#include "Subsystems/BotVisibilitySubsystem.h"
+#include "Components/CapsuleComponent.h"
+#include "AISystem.h"
+#include "BotArenaCollision.h"
+#include "CollisionQueryParams.h"
 
 // Sets default values
 AAICharacter::AAICharacter()
 {
-    // Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-    PrimaryActorTick.bCanEverTick = true;
+    // The per frame work of the bot runs in UBotTickManagerSubsystem
+    PrimaryActorTick.bCanEverTick = false;
 
     // Create components
     HealthComponent = CreateDefaultSubobject<UBotHealthComponent>(TEXT("HealthComponent"));
@@ -19,6 +25,9 @@ AAICharacter::AAICharacter()
     TeamComponent = CreateDefaultSubobject<UBotTeamComponent>(TEXT("TeamComponent"));
     BotMovementComponent = CreateDefaultSubobject<UBotMovementComponent>(TEXT("BotMovementComponent"));
 
+    // Bots get their own object type so queries can tell them apart from other pawns
+    GetCapsuleComponent()->SetCollisionProfileName(BotArenaCollisionProfiles::BotCapsule);
+
     // Set auto possess AI
     AutoPossessAI = EAutoPossessAI::PlacedInWorldOrSpawned;
 }
@@ -27,12 +36,22 @@ AAICharacter::AAICharacter()
 void AAICharacter::BeginPlay()
 {
     Super::BeginPlay();
+    
+    // Make this bot visible to the spatial queries of the other bots
+    if (UBotRegistrySubsystem* Registry = UWorld::GetSubsystem<UBotRegistrySubsystem>(GetWorld()))
+    {
+        Registry->RegisterBot(this);
+    }
 }
 
-// Called every frame
-void AAICharacter::Tick(float DeltaTime)
+void AAICharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-    Super::Tick(DeltaTime);
+    if (UBotRegistrySubsystem* Registry = UWorld::GetSubsystem<UBotRegistrySubsystem>(GetWorld()))
+    {
+        Registry->UnregisterBot(this);
+    }
+    
+    Super::EndPlay(EndPlayReason);
 }
 
 // Called to bind functionality to input
@@ -63,6 +82,39 @@ void AAICharacter::OnConstruction(const FTransform& Transform)
     }
 }
 
+UAISense_Sight::EVisibilityResult AAICharacter::CanBeSeenFrom(const FCanBeSeenFromContext& Context, FVector& OutSeenLocation, int32& OutNumberOfLoSChecksPerformed,
+    int32& OutNumberOfAsyncLosCheckRequested, float& OutSightStrength, int32* UserData, const FOnPendingVisibilityQueryProcessedDelegate* Delegate)
+{
+    OutNumberOfLoSChecksPerformed = 0;
+    OutNumberOfAsyncLosCheckRequested = 0;
+    OutSightStrength = 0.f;
+
+    const FVector TargetLocation = GetActorLocation();
+
+    // Walls between the two cells, no need to trace
+    UBotVisibilitySubsystem* Visibility = UWorld::GetSubsystem<UBotVisibilitySubsystem>(GetWorld());
+    if (Visibility && !Visibility->IsPotentiallyVisible(Context.ObserverLocation, TargetLocation))
+    {
+        return UAISense_Sight::EVisibilityResult::NotVisible;
+    }
+
+    // Same test as the default sight sense
+    FHitResult HitResult;
+    const bool bHit = GetWorld()->LineTraceSingleByChannel(HitResult, Context.ObserverLocation, TargetLocation, GET_AI_CONFIG_VAR(DefaultSightCollisionChannel),
+        FCollisionQueryParams(SCENE_QUERY_STAT(AILineOfSight), true, Context.IgnoreActor));
+    OutNumberOfLoSChecksPerformed = 1;
+
+    const AActor* HitActor = HitResult.GetActor();
+    if (bHit && !(HitActor && HitActor->IsOwnedBy(this)))
+    {
+        return UAISense_Sight::EVisibilityResult::NotVisible;
+    }
+
+    OutSeenLocation = TargetLocation;
+    OutSightStrength = 1.f;
+    return UAISense_Sight::EVisibilityResult::Visible;
+}
+
 // Delegate methods implementation
 void AAICharacter::FireWeapon()
 {
@@ -110,6 +162,19 @@ ETeam AAICharacter::GetTeam() const
     return TeamComponent ? TeamComponent->GetTeam() : ETeam::E_Team1;
 }
 
+void AAICharacter::SetGenericTeamId(const FGenericTeamId& NewTeamID)
+{
+    if (TeamComponent && NewTeamID != FGenericTeamId::NoTeam)
+    {
+        TeamComponent->SetTeam(static_cast<ETeam>(NewTeamID.GetId()));
+    }
+}
+
+FGenericTeamId AAICharacter::GetGenericTeamId() const
+{
+    return FGenericTeamId(static_cast<uint8>(GetTeam()));
+}
+
 bool AAICharacter::SameTeam(const AAICharacter* OtherCharacter) const
 {
     return IsFriendly(OtherCharacter);
@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Commandlets/BotArenaBakeCommandlet.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+#include "UObject/SavePackage.h"
+#include "LogBotArena.h"
+
+UBotArenaBakeCommandlet::UBotArenaBakeCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = true;
+    LogToConsole = true;
+}
+
+int32 UBotArenaBakeCommandlet::Main(const FString& Params)
+{
+    FString MapPackageName = DefaultMap;
+    FParse::Value(*Params, TEXT("Map="), MapPackageName);
+
+    UWorld* World = LoadWorld(MapPackageName);
+    if (!World)
+    {
+        UE_LOG(LogBotArena, Error, TEXT("%s: Couldn't load map %s"), *GetClass()->GetName(), *MapPackageName);
+        return 1;
+    }
+
+    const int32 Result = Bake(*World, Params);
+
+    UnloadWorld(World);
+
+    return Result;
+}
+
+UWorld* UBotArenaBakeCommandlet::LoadWorld(const FString& MapPackageName) const
+{
+    UPackage* Package = LoadPackage(nullptr, *MapPackageName, LOAD_None);
+    UWorld* World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+    if (!World)
+    {
+        return nullptr;
+    }
+
+    World->WorldType = EWorldType::Editor;
+    World->AddToRoot();
+
+    FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Editor);
+    WorldContext.SetCurrentWorld(World);
+
+    if (!World->bIsWorldInitialized)
+    {
+        // Only the collision of the level is needed
+        UWorld::InitializationValues InitValues;
+        InitValues.InitializeScenes(false)
+            .AllowAudioPlayback(false)
+            .RequiresHitProxies(false)
+            .CreatePhysicsScene(true)
+            .CreateNavigation(false)
+            .CreateAISystem(false)
+            .ShouldSimulatePhysics(false)
+            .EnableTraceCollision(true)
+            .SetTransactional(false)
+            .CreateFXSystem(false);
+
+        World->InitWorld(InitValues);
+    }
+
+    World->UpdateWorldComponents(true, false);
+
+    return World;
+}
+
+void UBotArenaBakeCommandlet::UnloadWorld(UWorld* World) const
+{
+    if (!World)
+    {
+        return;
+    }
+
+    GEngine->DestroyWorldContext(World);
+    World->DestroyWorld(false);
+    World->RemoveFromRoot();
+}
+
+bool UBotArenaBakeCommandlet::SaveAsset(UObject* Asset) const
+{
+#if WITH_EDITOR
+    UPackage* Package = Asset ? Asset->GetPackage() : nullptr;
+    if (!Package)
+    {
+        return false;
+    }
+
+    Package->MarkPackageDirty();
+
+    const FString FileName = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension());
+
+    FSavePackageArgs SaveArgs;
+    SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+    SaveArgs.SaveFlags = SAVE_NoError;
+
+    if (!UPackage::SavePackage(Package, Asset, *FileName, SaveArgs))
+    {
+        UE_LOG(LogBotArena, Error, TEXT("%s: Couldn't save %s"), *GetClass()->GetName(), *FileName);
+        return false;
+    }
+
+    UE_LOG(LogBotArena, Display, TEXT("%s: Saved %s"), *GetClass()->GetName(), *FileName);
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,157 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Commandlets/BotCoverBakeCommandlet.h"
+#include "Environment/BotCoverData.h"
+#include "NavMesh/NavMeshBoundsVolume.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "CollisionQueryParams.h"
+#include "LogBotArena.h"
+
+// Headroom a floor needs so that a bot can stand on it
+static constexpr float CoverMinHeadroom = 180.f;
+
+// How far below a floor the search for the next one starts
+static constexpr float CoverFloorStep = 10.f;
+
+// Get the unit vector of a direction of the exposure mask
+static FVector GetCoverDirection(int32 DirectionIndex)
+{
+    float Sin, Cos;
+    FMath::SinCos(&Sin, &Cos, DirectionIndex * (UE_TWO_PI / FBotCoverPoint::NumDirections));
+    return FVector(Cos, Sin, 0.f);
+}
+
+int32 UBotCoverBakeCommandlet::Bake(UWorld& World, const FString& Params)
+{
+    FParse::Value(*Params, TEXT("Spacing="), Spacing);
+    FParse::Value(*Params, TEXT("CoverHeight="), CoverHeight);
+    FParse::Value(*Params, TEXT("ExposureRange="), ExposureRange);
+    Spacing = FMath::Max(Spacing, 25.f);
+
+    // The nav area is the union of the nav mesh bounds volumes
+    FBox Bounds(ForceInit);
+    for (TActorIterator<ANavMeshBoundsVolume> It(&World); It; ++It)
+    {
+        Bounds += It->GetComponentsBoundingBox(true);
+    }
+
+    if (!Bounds.IsValid)
+    {
+        UE_LOG(LogBotArena, Error, TEXT("UBotCoverBakeCommandlet: No nav mesh bounds volume in %s"), *World.GetName());
+        return 1;
+    }
+
+    const int32 NumX = FMath::CeilToInt32(Bounds.GetSize().X / Spacing);
+    const int32 NumY = FMath::CeilToInt32(Bounds.GetSize().Y / Spacing);
+
+    TArray<FBotCoverPoint> Points;
+    TArray<float> FloorZ;
+    int32 NumSamples = 0;
+
+    for (int32 Y = 0; Y < NumY; Y++)
+    {
+        for (int32 X = 0; X < NumX; X++)
+        {
+            const FVector2D Sample(Bounds.Min.X + (X + 0.5f) * Spacing, Bounds.Min.Y + (Y + 0.5f) * Spacing);
+            FindFloors(World, Sample, Bounds, FloorZ);
+
+            for (const float Z : FloorZ)
+            {
+                NumSamples++;
+
+                FBotCoverPoint Point;
+                if (MakeCoverPoint(World, FVector(Sample, Z), Point))
+                {
+                    Points.Add(Point);
+                }
+            }
+        }
+    }
+
+    // Cells of a few meters keep the query down to a handful of cells around the bot
+    const float CellSize = 1000.f;
+    const FIntPoint Dimensions(
+        FMath::CeilToInt32(Bounds.GetSize().X / CellSize),
+        FMath::CeilToInt32(Bounds.GetSize().Y / CellSize));
+
+    UE_LOG(LogBotArena, Display, TEXT("UBotCoverBakeCommandlet: %d cover points out of %d floor samples"), Points.Num(), NumSamples);
+
+    UBotCoverData* Cover = CreateAsset<UBotCoverData>(UBotCoverData::GetPackageNameForMap(World.GetOutermost()->GetName()));
+    Cover->SetPoints(MoveTemp(Points), Bounds.Min, CellSize, Dimensions);
+
+    return SaveAsset(Cover) ? 0 : 1;
+}
+
+void UBotCoverBakeCommandlet::FindFloors(UWorld& World, const FVector2D& Location, const FBox& Bounds, TArray<float>& OutFloorZ) const
+{
+    OutFloorZ.Reset();
+
+    const FCollisionObjectQueryParams ObjectQueryParams(ECC_WorldStatic);
+    const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(BotCoverFloor), true);
+
+    // Keep tracing down from just below the last floor until nothing is left
+    float StartZ = Bounds.Max.Z;
+    FHitResult Floor;
+    while (StartZ > Bounds.Min.Z
+        && World.LineTraceSingleByObjectType(Floor, FVector(Location, StartZ), FVector(Location, Bounds.Min.Z), ObjectQueryParams, QueryParams))
+    {
+        // Started inside the slab of the previous floor, step through it
+        if (Floor.bStartPenetrating)
+        {
+            StartZ -= CoverFloorStep;
+            continue;
+        }
+
+        const FVector FloorLocation = Floor.ImpactPoint;
+
+        // Walkable and with enough headroom for a bot to stand there
+        if (Floor.ImpactNormal.Z > 0.7f
+            && !World.LineTestByObjectType(FloorLocation + FVector(0.f, 0.f, 1.f), FloorLocation + FVector(0.f, 0.f, CoverMinHeadroom), ObjectQueryParams, QueryParams))
+        {
+            OutFloorZ.Add(FloorLocation.Z);
+        }
+
+        StartZ = FloorLocation.Z - CoverFloorStep;
+    }
+}
+
+bool UBotCoverBakeCommandlet::MakeCoverPoint(UWorld& World, const FVector& FloorLocation, FBotCoverPoint& OutPoint) const
+{
+    const FCollisionObjectQueryParams ObjectQueryParams(ECC_WorldStatic);
+    const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(BotCoverBake), true);
+
+    // Probe just below the cover height, a wall reaching it hides a crouching bot
+    const FVector Probe = FloorLocation + FVector(0.f, 0.f, CoverHeight * 0.9f);
+
+    FVector WallNormal = FVector::ZeroVector;
+    uint16 ExposureMask = 0;
+
+    for (int32 Direction = 0; Direction < FBotCoverPoint::NumDirections; Direction++)
+    {
+        const FVector Ray = GetCoverDirection(Direction);
+
+        FHitResult Wall;
+        if (World.LineTraceSingleByObjectType(Wall, Probe, Probe + Ray * WallDistance, ObjectQueryParams, QueryParams))
+        {
+            WallNormal += Wall.ImpactNormal;
+        }
+
+        // Exposed to that direction when a bot standing further away could look at the point
+        if (!World.LineTestByObjectType(Probe, Probe + Ray * ExposureRange, ObjectQueryParams, QueryParams))
+        {
+            ExposureMask |= 1u << Direction;
+        }
+    }
+
+    WallNormal.Z = 0.f;
+    if (!WallNormal.Normalize() || ExposureMask == MAX_uint16)
+    {
+        return false;
+    }
+
+    OutPoint.Location = FVector3f(FloorLocation);
+    OutPoint.Normal = FVector3f(WallNormal);
+    OutPoint.ExposureMask = ExposureMask;
+    return true;
+}
@@ -0,0 +1,179 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Commandlets/BotPVSBakeCommandlet.h"
+#include "Environment/BotPVSData.h"
+#include "NavMesh/NavMeshBoundsVolume.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "CollisionQueryParams.h"
+#include "LogBotArena.h"
+
+// Offsets of the sample points of a cell, in cell units from its center: the center, the corners and the middle of
+// the edges. Center first, so most visible pairs are found by the first trace
+static const FVector2D PVSSampleOffsets[] =
+{
+    FVector2D(0.f, 0.f),
+    FVector2D(-0.5f, -0.5f),
+    FVector2D(0.5f, -0.5f),
+    FVector2D(-0.5f, 0.5f),
+    FVector2D(0.5f, 0.5f),
+    FVector2D(0.f, -0.5f),
+    FVector2D(0.f, 0.5f),
+    FVector2D(-0.5f, 0.f),
+    FVector2D(0.5f, 0.f)
+};
+
+// Floor value of the cells that see everything
+static constexpr float PVSUnknownFloor = TNumericLimits<float>::Lowest();
+
+int32 UBotPVSBakeCommandlet::Bake(UWorld& World, const FString& Params)
+{
+    FParse::Value(*Params, TEXT("CellSize="), CellSize);
+    CellSize = FMath::Max(CellSize, 50.f);
+
+    FString HeightsParam;
+    if (FParse::Value(*Params, TEXT("SampleHeights="), HeightsParam, false))
+    {
+        TArray<FString> Heights;
+        HeightsParam.ParseIntoArray(Heights, TEXT(","));
+
+        SampleHeights.Reset();
+        for (const FString& Height : Heights)
+        {
+            SampleHeights.Add(FCString::Atof(*Height));
+        }
+    }
+
+    if (SampleHeights.Num() == 0)
+    {
+        UE_LOG(LogBotArena, Error, TEXT("UBotPVSBakeCommandlet: No sample height"));
+        return 1;
+    }
+
+    // The nav area is the union of the nav mesh bounds volumes
+    FBox Bounds(ForceInit);
+    for (TActorIterator<ANavMeshBoundsVolume> It(&World); It; ++It)
+    {
+        Bounds += It->GetComponentsBoundingBox(true);
+    }
+
+    if (!Bounds.IsValid)
+    {
+        UE_LOG(LogBotArena, Error, TEXT("UBotPVSBakeCommandlet: No nav mesh bounds volume in %s"), *World.GetName());
+        return 1;
+    }
+
+    const FIntPoint Dimensions(
+        FMath::CeilToInt32(Bounds.GetSize().X / CellSize),
+        FMath::CeilToInt32(Bounds.GetSize().Y / CellSize));
+
+    UBotPVSData* PVS = CreateAsset<UBotPVSData>(UBotPVSData::GetPackageNameForMap(World.GetOutermost()->GetName()));
+    PVS->InitializeGrid(Bounds.Min, CellSize, Dimensions);
+
+    TArray<float> FloorZ;
+    FindCellFloors(World, *PVS, Bounds, FloorZ);
+
+    const int32 NumCells = PVS->GetNumCells();
+    int32 NumVisiblePairs = 0;
+
+    for (int32 CellA = 0; CellA < NumCells; CellA++)
+    {
+        if (FloorZ[CellA] == PVSUnknownFloor)
+        {
+            continue;
+        }
+
+        PVS->SetCellsVisible(CellA, CellA);
+
+        // The bits are symmetric so every pair is only traced once
+        for (int32 CellB = CellA + 1; CellB < NumCells; CellB++)
+        {
+            if (FloorZ[CellB] != PVSUnknownFloor && CanCellsSee(World, *PVS, CellA, CellB, FloorZ))
+            {
+                PVS->SetCellsVisible(CellA, CellB);
+                NumVisiblePairs++;
+            }
+        }
+    }
+
+    const int32 NumPairs = NumCells * (NumCells - 1) / 2;
+    UE_LOG(LogBotArena, Display, TEXT("UBotPVSBakeCommandlet: %d x %d cells, %d of %d pairs potentially visible"),
+        Dimensions.X, Dimensions.Y, NumVisiblePairs, NumPairs);
+
+    return SaveAsset(PVS) ? 0 : 1;
+}
+
+void UBotPVSBakeCommandlet::FindCellFloors(UWorld& World, UBotPVSData& PVS, const FBox& Bounds, TArray<float>& OutFloorZ) const
+{
+    const int32 NumCells = PVS.GetNumCells();
+    OutFloorZ.SetNumUninitialized(NumCells);
+
+    const FCollisionObjectQueryParams ObjectQueryParams(ECC_WorldStatic);
+    const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(BotPVSFloor), true);
+
+    for (int32 Cell = 0; Cell < NumCells; Cell++)
+    {
+        const FVector2D Center = PVS.GetCellCenter(Cell);
+
+        FHitResult Floor;
+        if (!World.LineTraceSingleByObjectType(Floor, FVector(Center, Bounds.Max.Z), FVector(Center, Bounds.Min.Z), ObjectQueryParams, QueryParams))
+        {
+            OutFloorZ[Cell] = PVSUnknownFloor;
+            continue;
+        }
+
+        // A second floor below the first one means a bot in this column may be on either of them,
+        // a single bit per cell can't tell them apart so the cell has to see everything
+        FHitResult LowerFloor;
+        const FVector BelowFloor(Center, Floor.ImpactPoint.Z - FMath::Max(SampleHeights) * 2.f);
+        if (BelowFloor.Z > Bounds.Min.Z
+            && World.LineTraceSingleByObjectType(LowerFloor, BelowFloor, FVector(Center, Bounds.Min.Z), ObjectQueryParams, QueryParams))
+        {
+            OutFloorZ[Cell] = PVSUnknownFloor;
+            continue;
+        }
+
+        OutFloorZ[Cell] = Floor.ImpactPoint.Z;
+    }
+
+    for (int32 Cell = 0; Cell < NumCells; Cell++)
+    {
+        if (OutFloorZ[Cell] == PVSUnknownFloor)
+        {
+            PVS.SetCellVisibleFromEverywhere(Cell);
+        }
+    }
+}
+
+bool UBotPVSBakeCommandlet::CanCellsSee(UWorld& World, const UBotPVSData& PVS, int32 CellA, int32 CellB, const TArray<float>& FloorZ) const
+{
+    const FCollisionObjectQueryParams ObjectQueryParams(ECC_WorldStatic);
+    const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(BotPVSBake), true);
+
+    const FVector2D CenterA = PVS.GetCellCenter(CellA);
+    const FVector2D CenterB = PVS.GetCellCenter(CellB);
+
+    // A single clear line between any pair of sample points is enough, the bit is only cleared when all of them are blocked
+    for (const float HeightA : SampleHeights)
+    {
+        for (const FVector2D& OffsetA : PVSSampleOffsets)
+        {
+            const FVector SampleA(CenterA + OffsetA * CellSize, FloorZ[CellA] + HeightA);
+
+            for (const float HeightB : SampleHeights)
+            {
+                for (const FVector2D& OffsetB : PVSSampleOffsets)
+                {
+                    const FVector SampleB(CenterB + OffsetB * CellSize, FloorZ[CellB] + HeightB);
+
+                    if (!World.LineTestByObjectType(SampleA, SampleB, ObjectQueryParams, QueryParams))
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+
+    return false;
+}
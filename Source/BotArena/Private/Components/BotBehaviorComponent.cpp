@@ -5,6 +5,9 @@
 #include "BehaviorTree/BlackboardComponent.h"
 #include "BehaviorTree/BehaviorTree.h"
 #include "MiscClasses/AmmoBox.h"
+#include "Characters/AICharacter.h"
+#include "Subsystems/BotCoverSubsystem.h"
+#include "Engine/World.h"
 
 UBotBehaviorComponent::UBotBehaviorComponent()
 {
@@ -14,6 +17,7 @@ UBotBehaviorComponent::UBotBehaviorComponent()
     BlackboardKey_MoveLocation = FName("MoveLocation");
     BlackboardKey_SelectedTarget = FName("SelectedTarget");
     BlackboardKey_ShouldRetreat = FName("ShouldRetreat");
+    BlackboardKey_RetreatLocation = FName("RetreatLocation");
     BlackboardKey_CollectAmmo = FName("CollectAmmo");
     BlackboardKey_AmmoBox = FName("AmmoBox");
 }
@@ -84,6 +88,43 @@ void UBotBehaviorComponent::InitiateRetreat()
     }
 }
 
+void UBotBehaviorComponent::InitiateRetreatFrom(const FVector& ThreatLocation)
+{
+    ABotController* BotController = GetBotController();
+    if (!BotController)
+    {
+        return;
+    }
+    
+    UBlackboardComponent* BlackboardComp = BotController->GetBlackboardComponent();
+    if (!BlackboardComp)
+    {
+        return;
+    }
+    
+    // Without baked cover the tree falls back to its own retreat logic
+    const AAICharacter* Bot = Cast<AAICharacter>(BotController->GetPawn());
+    const UBotCoverSubsystem* Cover = UWorld::GetSubsystem<UBotCoverSubsystem>(GetWorld());
+    const bool bHasRetreatKey = BlackboardComp->GetKeyID(BlackboardKey_RetreatLocation) != FBlackboard::InvalidKey;
+    
+    FVector CoverLocation;
+    if (Bot && Cover && Cover->FindCoverFrom(Bot->GetActorLocation(), ThreatLocation, Bot->GetTeam(), CoverLocation))
+    {
+        // The tree moves to MoveLocation, the cover has to be there before the retreat flag wakes its observers up
+        BlackboardComp->SetValueAsVector(BlackboardKey_MoveLocation, CoverLocation);
+        if (bHasRetreatKey)
+        {
+            BlackboardComp->SetValueAsVector(BlackboardKey_RetreatLocation, CoverLocation);
+        }
+    }
+    else if (bHasRetreatKey)
+    {
+        BlackboardComp->ClearValue(BlackboardKey_RetreatLocation);
+    }
+    
+    BlackboardComp->SetValueAsBool(BlackboardKey_ShouldRetreat, true);
+}
+
 void UBotBehaviorComponent::SetCollectAmmoStatus(bool NewStatus)
 {
     ABotController* BotController = GetBotController();
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Components/BotBehaviorTreeComponent.h"
+#include "Subsystems/BotBrainSchedulerSubsystem.h"
+#include "Subsystems/BotFrameBudgetSubsystem.h"
+#include "AIController.h"
+#include "Engine/World.h"
+
+void UBotBehaviorTreeComponent::BeginPlay()
+{
+    Super::BeginPlay();
+    
+    if (UBotBrainSchedulerSubsystem* Scheduler = UWorld::GetSubsystem<UBotBrainSchedulerSubsystem>(GetWorld()))
+    {
+        Bucket = Scheduler->RegisterBrain();
+    }
+}
+
+void UBotBehaviorTreeComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UBotBrainSchedulerSubsystem* Scheduler = UWorld::GetSubsystem<UBotBrainSchedulerSubsystem>(GetWorld()))
+    {
+        Scheduler->UnregisterBrain(Bucket);
+    }
+    
+    Bucket = INDEX_NONE;
+    
+    Super::EndPlay(EndPlayReason);
+}
+
+void UBotBehaviorTreeComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    // A tree on a tick interval already skips frames, holding it back would cost it a whole interval
+    const bool bWantsEveryFrame = GetComponentTickInterval() <= UE_KINDA_SMALL_NUMBER;
+    
+    const UBotBrainSchedulerSubsystem* Scheduler = UWorld::GetSubsystem<UBotBrainSchedulerSubsystem>(GetWorld());
+    if (bWantsEveryFrame && Scheduler && !IsPromoted())
+    {
+        // Over the behavior budget the least significant bots also skip turns of their bucket
+        const UBotFrameBudgetSubsystem* Budget = UWorld::GetSubsystem<UBotFrameBudgetSubsystem>(GetWorld());
+        const AAIController* Controller = Cast<AAIController>(GetOwner());
+        const int32 Stride = Budget && Controller ? Budget->GetBrainStride(Controller->GetPawn()) : 1;
+        
+        if (!Scheduler->IsBucketDue(Bucket, Stride))
+        {
+            SkippedDeltaTime += DeltaTime;
+            return;
+        }
+    }
+    
+    const float TreeDeltaTime = DeltaTime + SkippedDeltaTime;
+    SkippedDeltaTime = 0.0f;
+    
+    FBotBudgetScope BudgetScope(GetWorld(), EBotBudgetDomain::Behavior);
+    Super::TickComponent(TreeDeltaTime, TickType, ThisTickFunction);
+}
+
+void UBotBehaviorTreeComponent::PromoteFor(float Duration)
+{
+    if (const UWorld* World = GetWorld())
+    {
+        PromotedUntil = FMath::Max(PromotedUntil, World->GetTimeSeconds() + Duration);
+    }
+}
+
+bool UBotBehaviorTreeComponent::IsPromoted() const
+{
+    const UWorld* World = GetWorld();
+    return World && World->GetTimeSeconds() < PromotedUntil;
+}
@@ -6,7 +6,7 @@
 
 UBotCoreComponent::UBotCoreComponent()
 {
-    PrimaryComponentTick.bCanEverTick = true;
+    PrimaryComponentTick.bCanEverTick = false;
     AICharacterOwner = nullptr;
     BotControllerOwner = nullptr;
 }
@@ -17,11 +17,6 @@ void UBotCoreComponent::BeginPlay()
     InitializeComponent();
 }
 
-void UBotCoreComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
-{
-    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
-}
-
 void UBotCoreComponent::InitializeComponent()
 {
     AICharacterOwner = Cast<AAICharacter>(GetOwner());
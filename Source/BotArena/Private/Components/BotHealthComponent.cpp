@@ -3,13 +3,18 @@
 #include "Components/BotHealthComponent.h"
 #include "Characters/AICharacter.h"
 #include "Controllers/BotController.h"
+#include "Components/BotPerceptionComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Components/CapsuleComponent.h"
 #include "MiscClasses/BotCounter.h"
-#include "TimerManager.h"
 #include "Kismet/GameplayStatics.h"
 #include "LogBotArena.h"
+#include "BotArenaCollision.h"
 #include "Utils/BotArenaUtils.h"
+#include "Subsystems/BotRegistrySubsystem.h"
+#include "Subsystems/BotAmmoRegistrySubsystem.h"
+#include "Subsystems/BotTimerSubsystem.h"
+#include "Subsystems/BotDormancySubsystem.h"
 
 UBotHealthComponent::UBotHealthComponent()
 {
@@ -20,6 +25,7 @@ UBotHealthComponent::UBotHealthComponent()
     Health = MaxHealth;
     RetreatHealthPercentage = 0.2f;
     DestroyActorDelay = 5.0f;
+    LastDamageTime = -1.0f;
 }
 
 void UBotHealthComponent::BeginPlay()
@@ -72,10 +78,27 @@ float UBotHealthComponent::HandleDamage(float Damage, FDamageEvent const& Damage
     // Apply damage
     const float OldHealth = Health;
     Health = FMath::Max(Health - ActualDamage, 0.0f);
+    LastDamageTime = GetWorld()->GetTimeSeconds();
     
     // Broadcast health changed event
     OnHealthChanged.Broadcast(Health, OldHealth - Health);
     
+    // A sleeping bot has to react to being shot
+    if (UBotDormancySubsystem* Dormancy = UWorld::GetSubsystem<UBotDormancySubsystem>(GetWorld()))
+    {
+        Dormancy->WakeUp(GetOwner());
+    }
+    
+    APawn* Attacker = EventInstigator ? EventInstigator->GetPawn() : nullptr;
+    ABotController* BotController = GetBotController();
+    
+    // Remember who hurt us, so the attacker stays a threat even when it can't be seen
+    UBotPerceptionComponent* Perception = BotController ? BotController->GetBotPerceptionComponent() : nullptr;
+    if (Perception && Attacker)
+    {
+        Perception->NoteDamageFrom(Attacker, ActualDamage);
+    }
+    
     UE_LOG(LogBotArena, Log, TEXT("%s: Health changed from %.2f to %.2f"), 
            *GetNameSafe(GetOwner()), OldHealth, Health);
     
@@ -85,8 +108,14 @@ float UBotHealthComponent::HandleDamage(float Damage, FDamageEvent const& Damage
         UE_LOG(LogBotArena, Log, TEXT("%s: Health low, initiating retreat"), 
                *GetNameSafe(GetOwner()));
                
-        ABotController* BotController = GetBotController();
-        if (BotController)
+        // Hide from whoever shot us when we know where they are
+        const AActor* Threat = Attacker ? Attacker : DamageCauser;
+        
+        if (BotController && Threat)
+        {
+            BotController->InitiateRetreatFrom(Threat->GetActorLocation());
+        }
+        else if (BotController)
         {
             BotController->InitiateRetreat();
         }
@@ -132,6 +161,18 @@ void UBotHealthComponent::HandleDeath()
         return;
     }
     
+    // Dead bots must not show up in the spatial queries of the other bots anymore
+    if (UBotRegistrySubsystem* Registry = UWorld::GetSubsystem<UBotRegistrySubsystem>(GetWorld()))
+    {
+        Registry->UnregisterBot(Character);
+    }
+    
+    // Free the ammo box this bot was heading to
+    if (UBotAmmoRegistrySubsystem* AmmoRegistry = UWorld::GetSubsystem<UBotAmmoRegistrySubsystem>(GetWorld()))
+    {
+        AmmoRegistry->ReleaseReservation(Character);
+    }
+    
     // If the bot was crouching while it died, uncrouch first to avoid "funny" ragdoll effects
     UCharacterMovementComponent* MovementComp = FBotArenaUtils::GetComponentSafe<UCharacterMovementComponent>(Character, TEXT("CharacterMovementComponent"));
     if (MovementComp)
@@ -155,6 +196,10 @@ void UBotHealthComponent::HandleDeath()
         Mesh->SetSimulatePhysics(true);
         Mesh->SetCollisionProfileName(FName("Ragdoll"));
         Mesh->SetCollisionResponseToAllChannels(ECR_Block);
+        
+        // Bodies don't hide the living and don't pick anything up
+        Mesh->SetCollisionResponseToChannel(ECC_LOSBlocker, ECR_Ignore);
+        Mesh->SetCollisionResponseToChannel(ECC_Pickup, ECR_Ignore);
     }
     else
     {
@@ -167,6 +212,9 @@ void UBotHealthComponent::HandleDeath()
     {
         UE_LOG(LogBotArena, Verbose, TEXT("%s: Adjusting capsule collision"), *GetNameSafe(Character));
         CapsuleComp->SetCollisionResponseToChannel(ECC_Pawn, ECR_Overlap);
+        CapsuleComp->SetCollisionResponseToChannel(ECC_BotCapsule, ECR_Overlap);
+        CapsuleComp->SetCollisionResponseToChannel(ECC_Pickup, ECR_Ignore);
+        CapsuleComp->SetCollisionResponseToChannel(ECC_LOSBlocker, ECR_Ignore);
     }
     else
     {
@@ -211,26 +259,25 @@ void UBotHealthComponent::HandleDeath()
             }
             
             // Destroy the actor after a delay using a weak pointer for safety
-            FTimerHandle DestroyTimer;
-            FTimerDelegate DestroyDelegate;
-            
-            // Use a weak pointer to avoid dangling references if the character is destroyed early
-            TWeakObjectPtr<AAICharacter> WeakCharacter(Character);
-            
-            DestroyDelegate.BindLambda([WeakCharacter, this]() {
-                if (WeakCharacter.IsValid())
-                {
-                    UE_LOG(LogBotArena, Log, TEXT("%s: Destroying character after death delay"), 
-                           *GetNameSafe(WeakCharacter.Get()));
-                    WeakCharacter->Destroy();
-                }
-                else
-                {
-                    UE_LOG(LogBotArena, Warning, TEXT("HandleDeath: Character already destroyed before timer expired"));
-                }
-            });
-            
-            World->GetTimerManager().SetTimer(DestroyTimer, DestroyDelegate, DestroyActorDelay, false);
+            UBotTimerSubsystem* Timers = UWorld::GetSubsystem<UBotTimerSubsystem>(World);
+            if (Timers)
+            {
+                // Use a weak pointer to avoid dangling references if the character is destroyed early
+                TWeakObjectPtr<AAICharacter> WeakCharacter(Character);
+                
+                Timers->SetTimer(DestroyActorDelay, [WeakCharacter]() {
+                    if (WeakCharacter.IsValid())
+                    {
+                        UE_LOG(LogBotArena, Log, TEXT("%s: Destroying character after death delay"), 
+                               *GetNameSafe(WeakCharacter.Get()));
+                        WeakCharacter->Destroy();
+                    }
+                    else
+                    {
+                        UE_LOG(LogBotArena, Warning, TEXT("HandleDeath: Character already destroyed before timer expired"));
+                    }
+                });
+            }
         }
         
         BotController->UnPossess();
@@ -4,6 +4,8 @@
 #include "Characters/AICharacter.h"
 #include "Controllers/BotController.h"
 #include "Components/BotPathFollowingComponent.h"
+#include "Subsystems/BotTickManagerSubsystem.h"
+#include "Subsystems/BotFrameBudgetSubsystem.h"
 #include "GameFramework/CharacterMovementComponent.h"
 
 UBotMovementComponent::UBotMovementComponent()
@@ -20,12 +22,30 @@ void UBotMovementComponent::BeginPlay()
     
     // Initialize movement when the component begins play
     InitializeMovement();
+    
+    UBotTickManagerSubsystem* TickManager = UWorld::GetSubsystem<UBotTickManagerSubsystem>(GetWorld());
+    if (TickManager && TickManager->IsEnabled())
+    {
+        TickManager->RegisterMovement(this);
+    }
+}
+
+void UBotMovementComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UBotTickManagerSubsystem* TickManager = UWorld::GetSubsystem<UBotTickManagerSubsystem>(GetWorld()))
+    {
+        TickManager->UnregisterMovement(this);
+    }
+    
+    Super::EndPlay(EndPlayReason);
 }
 
 void UBotMovementComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
     Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
     
+    FBotBudgetScope BudgetScope(GetWorld(), EBotBudgetDomain::Movement);
+    
     // Adjust mesh for crouch if needed
     AdjustMeshForCrouch();
 }
@@ -48,6 +68,18 @@ void UBotMovementComponent::InitializeMovement()
     }
 }
 
+void UBotMovementComponent::SetDormant(bool bInDormant)
+{
+    bDormant = bInDormant;
+    
+    // The tick manager skips dormant components, the others stop their own tick
+    UBotTickManagerSubsystem* TickManager = UWorld::GetSubsystem<UBotTickManagerSubsystem>(GetWorld());
+    if (!TickManager || !TickManager->IsRegistered(this))
+    {
+        SetComponentTickEnabled(!bDormant);
+    }
+}
+
 void UBotMovementComponent::AdjustMeshForCrouch()
 {
     AAICharacter* Character = GetAICharacterOwner();
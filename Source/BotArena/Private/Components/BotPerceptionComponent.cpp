@@ -9,6 +9,8 @@
 #include "Perception/AISenseConfig.h"
 #include "Perception/AISenseConfig_Sight.h"
 #include "Perception/AIPerceptionTypes.h"
+#include "Senses/AISense_BotSight.h"
+#include "Senses/AISenseConfig_BotSight.h"
 #include "Components/BotTeamComponent.h"
 #include "Components/BotHealthComponent.h"
 #include "Components/BotWeaponComponent.h"
@@ -16,7 +18,32 @@
 #include "Kismet/KismetMathLibrary.h"
 #include "LogBotArena.h"
 #include "Utils/BotArenaUtils.h"
+#include "Subsystems/BotTargetSelectionSubsystem.h"
+#include "Subsystems/BotSquadKnowledgeSubsystem.h"
+#include "Subsystems/BotTickManagerSubsystem.h"
+#include "Subsystems/BotBrainSchedulerSubsystem.h"
+#include "Subsystems/BotFrameBudgetSubsystem.h"
+#include "Components/BotBehaviorTreeComponent.h"
 #include "DrawDebugHelpers.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<bool> CVarBotSightCustom(
+    TEXT("BotArena.Sight.Custom"),
+    true,
+    TEXT("Sense other bots with the budgeted BotArena sight instead of the stock sight sense: 0=off, 1=on. Read when a bot is possessed."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotThreatsForgetTime(
+    TEXT("BotArena.Threats.ForgetTime"),
+    10.f,
+    TEXT("Seconds after which a bot forgets a threat it doesn't sense anymore"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotThreatsDamageHalfLife(
+    TEXT("BotArena.Threats.DamageHalfLife"),
+    5.f,
+    TEXT("Seconds after which the damage a bot remembers from a threat has faded to half"),
+    ECVF_Default);
 
 UBotPerceptionComponent::UBotPerceptionComponent()
 {
@@ -25,7 +52,7 @@ UBotPerceptionComponent::UBotPerceptionComponent()
     // Default values
     SelectTargetInterval = 5.0f;
     SelectTargetRotationSpeed = 1.0f;
-    TimeSinceTargetSelection = 0.0f;
+    TargetSelectionTime = 0.0;
 }
 
 void UBotPerceptionComponent::BeginPlay()
@@ -34,6 +61,33 @@ void UBotPerceptionComponent::BeginPlay()
     
     // Initialize perception when the component begins play
     InitializePerception();
+    ResetTargetSelectionTimer();
+    
+    if (UBotTargetSelectionSubsystem* TargetSelection = UWorld::GetSubsystem<UBotTargetSelectionSubsystem>(GetWorld()))
+    {
+        TargetSelection->RegisterPerception(this);
+    }
+    
+    UBotTickManagerSubsystem* TickManager = UWorld::GetSubsystem<UBotTickManagerSubsystem>(GetWorld());
+    if (TickManager && TickManager->IsEnabled())
+    {
+        TickManager->RegisterPerception(this);
+    }
+}
+
+void UBotPerceptionComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UBotTargetSelectionSubsystem* TargetSelection = UWorld::GetSubsystem<UBotTargetSelectionSubsystem>(GetWorld()))
+    {
+        TargetSelection->UnregisterPerception(this);
+    }
+    
+    if (UBotTickManagerSubsystem* TickManager = UWorld::GetSubsystem<UBotTickManagerSubsystem>(GetWorld()))
+    {
+        TickManager->UnregisterPerception(this);
+    }
+    
+    Super::EndPlay(EndPlayReason);
 }
 
 void UBotPerceptionComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
@@ -46,24 +100,66 @@ void UBotPerceptionComponent::TickComponent(float DeltaTime, ELevelTick TickType
         return;
     }
     
-    // Update time since last target selection
-    TimeSinceTargetSelection += DeltaTime;
+    FBotBudgetScope BudgetScope(GetWorld(), EBotBudgetDomain::Perception);
+    
+    // Only ticks by itself when the tick manager is disabled, which otherwise runs the phases for every bot
+    SenseTick(DeltaTime);
+    ThinkTick();
+    ActTick(DeltaTime);
+}
+
+void UBotPerceptionComponent::SenseTick(float DeltaTime)
+{
+    // Process perception updates in the game thread. Picking up the latest update only swaps a slot index
+    if (SensedActorsBuffer.IsDirty())
+    {
+        SensedActorsBuffer.SwapReadBuffers();
+        ProcessSensedActors();
+    }
+    
+    // Track the visible threats and forget the stale ones even on frames without a perception update
+    ThreatTable.Update(GetWorld()->GetTimeSeconds(), DeltaTime, CVarBotThreatsForgetTime.GetValueOnGameThread(), 
+                       CVarBotThreatsDamageHalfLife.GetValueOnGameThread());
     
-    // Process perception updates in the game thread
-    if (bHasPendingPerceptionUpdate)
+    ThreatTable.RemoveAll([](const FBotThreatEntry& Threat)
+    {
+        const AAICharacter* Bot = Cast<AAICharacter>(Threat.Actor.Get());
+        return Bot && !Bot->IsAlive();
+    });
+    
+    // Keep the brain reacting every frame while the target is in sight
+    const AActor* SelectedTarget = GetSelectedTarget();
+    const FBotThreatEntry* Threat = SelectedTarget ? ThreatTable.Find(SelectedTarget) : nullptr;
+    if (Threat && Threat->bVisible)
+    {
+        PromoteBrain();
+    }
+}
+
+void UBotPerceptionComponent::ThinkTick()
+{
+    // The batched selection pass runs once per frame for every bot and reads the table itself
+    if (!UBotTargetSelectionSubsystem::IsBatchingEnabled() && (bTargetCandidatesChanged || IsTargetSelectionIntervalExpired()))
     {
-        TArray<AActor*> LocalSensedActors;
+        bTargetCandidatesChanged = false;
+        
+        SelectTargetScratch.Reset();
+        for (const FBotThreatEntry& Threat : ThreatTable)
         {
-            // Use a critical section to safely copy the data
-            FScopeLock Lock(&PerceptionLock);
-            LocalSensedActors = PendingSensedActors;
-            bHasPendingPerceptionUpdate = false;
+            AActor* Actor = Threat.Actor.Get();
+            if (Actor && Threat.bVisible)
+            {
+                SelectTargetScratch.Add(Actor);
+            }
         }
         
-        // Process the perception update in the game thread
-        SelectTarget(LocalSensedActors);
+        AppendSquadTargets(SelectTargetScratch);
+        SelectTarget(SelectTargetScratch);
     }
-    
+}
+
+void UBotPerceptionComponent::ActTick(float DeltaTime)
+{
     // Handle smooth rotation towards target
     ABotController* BotController = GetBotController();
     if (!BotController)
@@ -118,10 +214,65 @@ void UBotPerceptionComponent::InitializePerception()
         UAISenseConfig_Sight* SightConfig = Cast<UAISenseConfig_Sight>(PerceptionComp->GetSenseConfig(UAISense::GetSenseID<UAISense_Sight>()));
         if (SightConfig)
         {
+            // Bots report their team, so the sight sense drops allies before running any line of sight test
             SightConfig->DetectionByAffiliation.bDetectEnemies = true;
-            SightConfig->DetectionByAffiliation.bDetectFriendlies = true;
-            SightConfig->DetectionByAffiliation.bDetectNeutrals = true;
+            SightConfig->DetectionByAffiliation.bDetectFriendlies = false;
+            SightConfig->DetectionByAffiliation.bDetectNeutrals = false;
         }
+        
+        // A controller blueprint saving its own senses config replaces the native one, the budgeted sight is missing from it then
+        UAISenseConfig_BotSight* BotSightConfig = Cast<UAISenseConfig_BotSight>(PerceptionComp->GetSenseConfig(UAISense::GetSenseID<UAISense_BotSight>()));
+        if (!BotSightConfig && CVarBotSightCustom.GetValueOnGameThread())
+        {
+            // Once is enough, every bot of the class is in the same situation
+            static bool bWarnedMissingBotSight = false;
+            if (!bWarnedMissingBotSight)
+            {
+                UE_LOG(LogBotArena, Warning, TEXT("No BotArena sight in the senses config of %s, adding it at runtime. Add it to the blueprint to get rid of this warning"),
+                    *GetNameSafe(BotController->GetClass()));
+                bWarnedMissingBotSight = true;
+            }
+            
+            BotSightConfig = NewObject<UAISenseConfig_BotSight>(PerceptionComp);
+            PerceptionComp->ConfigureSense(*BotSightConfig);
+        }
+        
+        // The budgeted sight uses the ranges tuned on the stock sight config
+        if (BotSightConfig && SightConfig)
+        {
+            BotSightConfig->SightRadius = SightConfig->SightRadius;
+            BotSightConfig->LoseSightRadius = SightConfig->LoseSightRadius;
+            BotSightConfig->PeripheralVisionAngleDegrees = SightConfig->PeripheralVisionAngleDegrees;
+            BotSightConfig->SetMaxAge(SightConfig->GetMaxAge());
+        }
+        
+        // Only one of the two sight senses runs
+        const bool bUseBotSight = BotSightConfig && CVarBotSightCustom.GetValueOnGameThread();
+        if (SightConfig)
+        {
+            PerceptionComp->SetSenseEnabled(UAISense_Sight::StaticClass(), !bUseBotSight);
+        }
+        if (BotSightConfig)
+        {
+            PerceptionComp->SetSenseEnabled(UAISense_BotSight::StaticClass(), bUseBotSight);
+        }
+        
+        if (bUseBotSight)
+        {
+            ActiveSightSense = UAISense_BotSight::StaticClass();
+        }
+        else if (SightConfig)
+        {
+            ActiveSightSense = UAISense_Sight::StaticClass();
+        }
+        
+        if (ActiveSightSense)
+        {
+            PerceptionComp->SetDominantSense(ActiveSightSense);
+        }
+        
+        // The senses digest their config when the listener registers, refresh it
+        PerceptionComp->RequestStimuliListenerUpdate();
     }
 }
 
@@ -155,12 +306,12 @@ void UBotPerceptionComponent::SelectTarget(const TArray<AActor*>& TargetList)
     
     // Only select a new target if we don't have one or enough time has passed
     AActor* CurrentTarget = GetSelectedTarget();
-    bool bNeedsNewTarget = !CurrentTarget || TimeSinceTargetSelection >= SelectTargetInterval;
+    bool bNeedsNewTarget = !CurrentTarget || IsTargetSelectionIntervalExpired();
     
     if (!bNeedsNewTarget)
     {
         UE_LOG(LogBotArena, Verbose, TEXT("%s: Skipping target selection, current target: %s, time since selection: %.2f"), 
-               *GetNameSafe(GetOwner()), *GetNameSafe(CurrentTarget), TimeSinceTargetSelection);
+               *GetNameSafe(GetOwner()), *GetNameSafe(CurrentTarget), GetTimeSinceTargetSelection());
         return;
     }
     
@@ -225,22 +376,7 @@ void UBotPerceptionComponent::SelectTarget(const TArray<AActor*>& TargetList)
     // Update blackboard with the selected target
     if (SelectedTarget)
     {
-        UE_LOG(LogBotArena, Log, TEXT("%s: Selected target %s at distance %.2f"), 
-               *GetNameSafe(GetOwner()), *GetNameSafe(SelectedTarget), ClosestDistance);
-        
-        UBlackboardComponent* BlackboardComp = BotController->GetBlackboardComponent();
-        if (BlackboardComp)
-        {
-            BlackboardComp->SetValueAsObject(FName("SelectedTarget"), SelectedTarget);
-            
-            // Reset timer and broadcast event
-            TimeSinceTargetSelection = 0.0f;
-            OnTargetSelected.Broadcast(SelectedTarget);
-        }
-        else
-        {
-            UE_LOG(LogBotArena, Warning, TEXT("%s: Missing BlackboardComponent"), *GetNameSafe(BotController));
-        }
+        ApplySelectedTarget(SelectedTarget, ClosestDistance);
     }
     else
     {
@@ -248,6 +384,32 @@ void UBotPerceptionComponent::SelectTarget(const TArray<AActor*>& TargetList)
     }
 }
 
+void UBotPerceptionComponent::ApplySelectedTarget(AActor* NewTarget, float Distance)
+{
+    ABotController* BotController = GetBotController();
+    if (!BotController || !NewTarget)
+    {
+        return;
+    }
+    
+    UE_LOG(LogBotArena, Log, TEXT("%s: Selected target %s at distance %.2f"), 
+           *GetNameSafe(GetOwner()), *GetNameSafe(NewTarget), Distance);
+    
+    UBlackboardComponent* BlackboardComp = BotController->GetBlackboardComponent();
+    if (BlackboardComp)
+    {
+        BlackboardComp->SetValueAsObject(FName("SelectedTarget"), NewTarget);
+        
+        // Reset timer and broadcast event
+        ResetTargetSelectionTimer();
+        OnTargetSelected.Broadcast(NewTarget);
+    }
+    else
+    {
+        UE_LOG(LogBotArena, Warning, TEXT("%s: Missing BlackboardComponent"), *GetNameSafe(BotController));
+    }
+}
+
 AActor* UBotPerceptionComponent::GetSelectedTarget() const
 {
     ABotController* BotController = GetBotController();
@@ -343,14 +505,146 @@ void UBotPerceptionComponent::DebugDrawPerception(float DeltaTime)
 #endif
 }
 
+void UBotPerceptionComponent::ResetTargetSelectionTimer()
+{
+    // A timestamp instead of a counter, nothing to advance on frames without a selection
+    TargetSelectionTime = GetWorld()->GetTimeSeconds();
+}
+
+float UBotPerceptionComponent::GetTimeSinceTargetSelection() const
+{
+    return GetWorld()->GetTimeSeconds() - TargetSelectionTime;
+}
+
+void UBotPerceptionComponent::SetDormant(bool bInDormant)
+{
+    bDormant = bInDormant;
+    
+    // The tick manager skips dormant components, the others stop their own tick
+    UBotTickManagerSubsystem* TickManager = UWorld::GetSubsystem<UBotTickManagerSubsystem>(GetWorld());
+    if (!TickManager || !TickManager->IsRegistered(this))
+    {
+        SetComponentTickEnabled(!bDormant);
+    }
+    
+    // The sight sense drops the listener while it is disabled, a dormant bot costs no sight checks under either sense
+    if (PerceptionComp && ActiveSightSense)
+    {
+        PerceptionComp->SetSenseEnabled(ActiveSightSense, !bDormant);
+    }
+    
+    // Whatever happened while asleep has to be looked at again
+    if (!bDormant)
+    {
+        MarkTargetCandidatesChanged();
+    }
+}
+
+void UBotPerceptionComponent::SetPerceptionLOD(float TickInterval, float InSelectTargetIntervalScale)
+{
+    SelectTargetIntervalScale = InSelectTargetIntervalScale;
+    
+    // Changing the interval reschedules the tick function, skip it when the rate barely moves
+    if (!FMath::IsNearlyEqual(GetComponentTickInterval(), TickInterval, 0.01f))
+    {
+        SetComponentTickInterval(TickInterval);
+    }
+}
+
+void UBotPerceptionComponent::NoteDamageFrom(AActor* Attacker, float Damage)
+{
+    ABotController* BotController = GetBotController();
+    if (!Attacker || !BotController || BotController->GetTeamAttitudeTowards(*Attacker) != ETeamAttitude::Hostile)
+    {
+        return;
+    }
+    
+    ThreatTable.NoteDamage(Attacker, Attacker->GetActorLocation(), Damage, GetWorld()->GetTimeSeconds());
+    PromoteBrain();
+}
+
+void UBotPerceptionComponent::PromoteBrain()
+{
+    ABotController* BotController = GetBotController();
+    UBotBehaviorTreeComponent* Brain = BotController ? BotController->GetBotBehaviorTreeComponent() : nullptr;
+    if (Brain)
+    {
+        Brain->PromoteFor(UBotBrainSchedulerSubsystem::GetPromotionTime());
+    }
+}
+
+void UBotPerceptionComponent::AppendSquadTargets(TArray<AActor*>& TargetList) const
+{
+    const UBotSquadKnowledgeSubsystem* SquadKnowledge = UWorld::GetSubsystem<UBotSquadKnowledgeSubsystem>(GetWorld());
+    const AAICharacter* Character = GetAICharacterOwner();
+    if (!SquadKnowledge || !Character || !UBotSquadKnowledgeSubsystem::IsEnabled())
+    {
+        return;
+    }
+    
+    const FVector CharacterLocation = Character->GetActorLocation();
+    const float ShareRadiusSquared = FMath::Square(UBotSquadKnowledgeSubsystem::GetShareRadius());
+    
+    // Enemies currently seen by a teammate, close enough to matter to this bot
+    for (const FBotSharedThreat& Known : SquadKnowledge->GetKnownEnemies(Character->GetTeam()))
+    {
+        AAICharacter* Enemy = Known.Bot.Get();
+        if (Enemy && Known.NumSpotters > 0 && FVector::DistSquared(Known.LastSeenLocation, CharacterLocation) <= ShareRadiusSquared)
+        {
+            TargetList.AddUnique(Enemy);
+        }
+    }
+}
+
+void UBotPerceptionComponent::NoteGunfireFrom(AActor* Shooter, const FVector& Location)
+{
+    if (Shooter)
+    {
+        ThreatTable.NoteHeard(Shooter, Location, GetWorld()->GetTimeSeconds());
+    }
+}
+
+void UBotPerceptionComponent::ProcessSensedActors()
+{
+    ABotController* BotController = GetBotController();
+    if (!PerceptionComp || !BotController)
+    {
+        return;
+    }
+    
+    const double Now = GetWorld()->GetTimeSeconds();
+    
+    for (const TWeakObjectPtr<AActor>& SensedActor : SensedActorsBuffer.Read())
+    {
+        AActor* Actor = SensedActor.Get();
+        if (!Actor || BotController->GetTeamAttitudeTowards(*Actor) != ETeamAttitude::Hostile)
+        {
+            continue;
+        }
+        
+        const FActorPerceptionInfo* Info = PerceptionComp->GetActorInfo(*Actor);
+        if (!Info)
+        {
+            continue;
+        }
+        
+        // Lost actors stay in the table at their last known location until they are forgotten
+        if (ThreatTable.NoteSighting(Actor, Info->GetLastStimulusLocation(), Now, Info->HasAnyCurrentStimulus()))
+        {
+            bTargetCandidatesChanged = true;
+        }
+    }
+}
+
 void UBotPerceptionComponent::OnPerceptionUpdated(const TArray<AActor*>& SensedActors)
 {
-    // Use a critical section to prevent race conditions
-    FScopeLock Lock(&PerceptionLock);
+    // Fill the write slot in place, it keeps its allocation from the previous updates
+    TArray<TWeakObjectPtr<AActor>>& WriteSlot = SensedActorsBuffer.GetWriteBuffer();
+    WriteSlot.Reset();
+    WriteSlot.Append(SensedActors);
     
-    // Store a copy of the sensed actors
-    PendingSensedActors = SensedActors;
-    bHasPendingPerceptionUpdate = true;
+    // Publish it, an update the tick didn't pick up yet is simply replaced
+    SensedActorsBuffer.SwapWriteBuffers();
     
     UE_LOG(LogBotArena, Verbose, TEXT("%s: Perception updated with %d actors"), 
            *GetNameSafe(GetOwner()), SensedActors.Num());
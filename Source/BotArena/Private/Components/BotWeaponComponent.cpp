@@ -10,10 +10,16 @@
 #include "Components/BotTeamComponent.h"
 #include "LogBotArena.h"
 #include "Utils/BotArenaUtils.h"
+#include "Subsystems/BotVisibilitySubsystem.h"
+#include "Subsystems/BotInfluenceMapSubsystem.h"
+#include "Subsystems/BotGunfireSubsystem.h"
+#include "Subsystems/BotTimerSubsystem.h"
+#include "Subsystems/BotFrameBudgetSubsystem.h"
+#include "Subsystems/BotDormancySubsystem.h"
 
 UBotWeaponComponent::UBotWeaponComponent()
 {
-    PrimaryComponentTick.bCanEverTick = true;
+    PrimaryComponentTick.bCanEverTick = false;
     
     // Create weapon mesh
     WeaponMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("WeaponMesh"));
@@ -27,7 +33,7 @@ UBotWeaponComponent::UBotWeaponComponent()
     CurrentAmmo = 30;
     FireDelay = 0.35f;
     DeactivateParticleDelay = 0.2f;
-    LastFireWeaponTime = 0.0f;
+    LastFireWeaponTime = 0.0;
     LowAmmoThreshold = 5;
 }
 
@@ -47,20 +53,19 @@ void UBotWeaponComponent::BeginPlay()
             WeaponFireFX->SetWorldLocation(WeaponMesh->GetSocketLocation("BulletSocket"));
         }
     }
+    
+    // The cooldown counts from spawn, like a weapon that was just fired
+    LastFireWeaponTime = GetWorld()->GetTimeSeconds();
 }
 
-void UBotWeaponComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+void UBotWeaponComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
-    
-    // Update last fire time
-    LastFireWeaponTime += DeltaTime;
-    
-    // Deactivate particle effect after delay
-    if (LastFireWeaponTime >= DeactivateParticleDelay)
+    if (UBotTimerSubsystem* Timers = UWorld::GetSubsystem<UBotTimerSubsystem>(GetWorld()))
     {
-        DeactivateFireWeaponParticle();
+        Timers->ClearTimer(DeactivateParticleTimer);
     }
+    
+    Super::EndPlay(EndPlayReason);
 }
 
 void UBotWeaponComponent::FireWeapon()
@@ -71,6 +76,8 @@ void UBotWeaponComponent::FireWeapon()
         return;
     }
     
+    FBotBudgetScope BudgetScope(GetWorld(), EBotBudgetDomain::Weapon);
+    
     if (!WeaponMesh)
     {
         UE_LOG(LogBotArena, Warning, TEXT("%s: WeaponMesh is null"), *GetNameSafe(GetOwner()));
@@ -132,15 +139,44 @@ void UBotWeaponComponent::FireWeapon()
         // Activate the particle and adjust its end point
         WeaponFireFX->Activate();
         WeaponFireFX->SetBeamEndPoint(0, BulletEndLocation);
+        
+        // Deactivate the particle effect after a delay, restarting the delay of an earlier shot
+        if (UBotTimerSubsystem* Timers = UWorld::GetSubsystem<UBotTimerSubsystem>(GetWorld()))
+        {
+            TWeakObjectPtr<UBotWeaponComponent> WeakThis(this);
+            Timers->ClearTimer(DeactivateParticleTimer);
+            DeactivateParticleTimer = Timers->SetTimer(DeactivateParticleDelay, [WeakThis]()
+            {
+                if (UBotWeaponComponent* Weapon = WeakThis.Get())
+                {
+                    Weapon->DeactivateFireWeaponParticle();
+                }
+            });
+        }
     }
     
     // Reduce ammo and reset fire timer
     CurrentAmmo--;
-    LastFireWeaponTime = 0.0f;
+    LastFireWeaponTime = GetWorld()->GetTimeSeconds();
     
     // Broadcast weapon fired event
     OnWeaponFired.Broadcast();
     OnAmmoChanged.Broadcast(CurrentAmmo);
+    NotifyAmmoThreshold(CurrentAmmo + 1);
+    
+    // Let the other teams know shots came from here
+    AAICharacter* Shooter = GetAICharacterOwner();
+    UBotInfluenceMapSubsystem* InfluenceMap = UWorld::GetSubsystem<UBotInfluenceMapSubsystem>(GetWorld());
+    if (Shooter && InfluenceMap)
+    {
+        InfluenceMap->AddFireEvent(Shooter->GetTeam(), Shooter->GetActorLocation());
+    }
+    
+    UBotGunfireSubsystem* Gunfire = UWorld::GetSubsystem<UBotGunfireSubsystem>(GetWorld());
+    if (Shooter && Gunfire)
+    {
+        Gunfire->ReportShot(Shooter, Shooter->GetActorLocation());
+    }
     
     UE_LOG(LogBotArena, Log, TEXT("%s: Weapon fired, %d ammo remaining"), 
            *GetNameSafe(GetOwner()), CurrentAmmo);
@@ -162,7 +198,7 @@ bool UBotWeaponComponent::CanFireWeapon() const
     }
     
     // Check if enough time has passed since last fire
-    if (LastFireWeaponTime < FireDelay)
+    if (GetWorld()->GetTimeSeconds() - LastFireWeaponTime < FireDelay)
     {
         UE_LOG(LogBotArena, Verbose, TEXT("%s: Cannot fire weapon - on cooldown"), *GetNameSafe(GetOwner()));
         return false;
@@ -203,52 +239,41 @@ bool UBotWeaponComponent::CanSeeSelectedTarget() const
         return false;
     }
     
-    // Get target location
-    FVector TargetLocation = BotController->GetSelectedTargetLocation();
-    FVector StartLocation = GetOwner()->GetActorLocation();
-    
-    // Perform line trace to check if we can see the target
-    FCollisionObjectQueryParams CollisionObjectQueryParams = FCollisionObjectQueryParams(ECC_WorldDynamic);
-    CollisionObjectQueryParams.AddObjectTypesToQuery(ECC_WorldStatic);
-    CollisionObjectQueryParams.AddObjectTypesToQuery(ECC_Pawn);
+    AAICharacter* TargetCharacter = Cast<AAICharacter>(SelectedTarget);
+    if (!TargetCharacter)
+    {
+        UE_LOG(LogBotArena, Verbose, TEXT("%s: Selected target %s is not a character"), 
+               *GetNameSafe(GetOwner()), *GetNameSafe(SelectedTarget));
+        return false;
+    }
     
-    FHitResult HitResult;
-    FCollisionQueryParams CollisionQueryParams = FCollisionQueryParams(FName("BotLineTrace"));
-    CollisionQueryParams.AddIgnoredActor(GetOwner());
+    AAICharacter* OwnerCharacter = Cast<AAICharacter>(GetOwner());
+    if (!OwnerCharacter)
+    {
+        UE_LOG(LogBotArena, Warning, TEXT("%s: Owner is not an AICharacter"), *GetNameSafe(GetOwner()));
+        return false;
+    }
     
-    UWorld* World = GetWorld();
-    if (!World)
+    UBotVisibilitySubsystem* Visibility = UWorld::GetSubsystem<UBotVisibilitySubsystem>(GetWorld());
+    if (!Visibility)
     {
-        UE_LOG(LogBotArena, Warning, TEXT("%s: Invalid World"), *GetNameSafe(GetOwner()));
+        UE_LOG(LogBotArena, Warning, TEXT("%s: Missing BotVisibilitySubsystem"), *GetNameSafe(GetOwner()));
         return false;
     }
     
-    if (World->LineTraceSingleByObjectType(HitResult, StartLocation, TargetLocation, CollisionObjectQueryParams, CollisionQueryParams))
+    // The line of sight is shared with the target, which asks the very same question when it shoots back.
+    // The cache never traces synchronously, a stale pair gets refreshed asynchronously
+    if (!Visibility->CanSee(OwnerCharacter, TargetCharacter))
     {
-        AAICharacter* Character = Cast<AAICharacter>(HitResult.GetActor());
-        if (!Character)
-        {
-            // Hit something that's not a character
-            UE_LOG(LogBotArena, Verbose, TEXT("%s: Line trace hit non-character: %s"), 
-                   *GetNameSafe(GetOwner()), *GetNameSafe(HitResult.GetActor()));
-            return false;
-        }
-        
-        AAICharacter* OwnerCharacter = Cast<AAICharacter>(GetOwner());
-        if (!OwnerCharacter)
-        {
-            UE_LOG(LogBotArena, Warning, TEXT("%s: Owner is not an AICharacter"), *GetNameSafe(GetOwner()));
-            return false;
-        }
-        
-        bool bIsHostile = OwnerCharacter->IsHostile(Character);
-        UE_LOG(LogBotArena, Verbose, TEXT("%s: Can see character %s, hostile: %s"), 
-               *GetNameSafe(GetOwner()), *GetNameSafe(Character), bIsHostile ? TEXT("true") : TEXT("false"));
-        return bIsHostile;
+        UE_LOG(LogBotArena, Verbose, TEXT("%s: No line of sight to %s"), 
+               *GetNameSafe(GetOwner()), *GetNameSafe(TargetCharacter));
+        return false;
     }
     
-    UE_LOG(LogBotArena, Verbose, TEXT("%s: Line trace did not hit target"), *GetNameSafe(GetOwner()));
-    return false;
+    bool bIsHostile = OwnerCharacter->IsHostile(TargetCharacter);
+    UE_LOG(LogBotArena, Verbose, TEXT("%s: Can see character %s, hostile: %s"), 
+           *GetNameSafe(GetOwner()), *GetNameSafe(TargetCharacter), bIsHostile ? TEXT("true") : TEXT("false"));
+    return bIsHostile;
 }
 
 void UBotWeaponComponent::AddAmmo(int32 AmmoAmount)
@@ -281,6 +306,7 @@ void UBotWeaponComponent::AddAmmo(int32 AmmoAmount)
         UE_LOG(LogBotArena, Log, TEXT("%s: Ammo changed from %d to %d"), 
                *GetNameSafe(GetOwner()), OldAmmo, CurrentAmmo);
         OnAmmoChanged.Broadcast(CurrentAmmo);
+        NotifyAmmoThreshold(OldAmmo);
     }
 }
 
@@ -289,6 +315,20 @@ bool UBotWeaponComponent::LowOnAmmo() const
     return CurrentAmmo <= LowAmmoThreshold;
 }
 
+void UBotWeaponComponent::NotifyAmmoThreshold(int32 OldAmmo)
+{
+    // A sleeping bot has to go look for ammo, or back to fighting once it got some
+    if ((OldAmmo <= LowAmmoThreshold) == LowOnAmmo())
+    {
+        return;
+    }
+
+    if (UBotDormancySubsystem* Dormancy = UWorld::GetSubsystem<UBotDormancySubsystem>(GetWorld()))
+    {
+        Dormancy->WakeUp(GetOwner());
+    }
+}
+
 void UBotWeaponComponent::DeactivateFireWeaponParticle()
 {
     if (WeaponFireFX)
@@ -3,10 +3,13 @@
 #include "Controllers/BotController.h"
 #include "Components/BotPerceptionComponent.h"
 #include "Components/BotBehaviorComponent.h"
+#include "Components/BotBehaviorTreeComponent.h"
 #include "Components/BotPathFollowingComponent.h"
 #include "Perception/AIPerceptionComponent.h"
 #include "Perception/AIPerceptionStimuliSourceComponent.h"
+#include "Senses/AISenseConfig_BotSight.h"
 #include "MiscClasses/AmmoBox.h"
+#include "Characters/AICharacter.h"
 
 ABotController::ABotController()
 {
@@ -19,11 +22,20 @@ ABotController::ABotController()
     if (PerceptionComp)
     {
         SetPerceptionComponent(*PerceptionComp);
+        
+        // Budgeted sight, replaces the stock sight sense configured in the blueprint (see UBotPerceptionComponent::InitializePerception)
+        UAISenseConfig_BotSight* BotSightConfig = CreateDefaultSubobject<UAISenseConfig_BotSight>(TEXT("BotSightConfig"));
+        PerceptionComp->ConfigureSense(*BotSightConfig);
+        PerceptionComp->SetDominantSense(BotSightConfig->GetSenseImplementation());
     }
     
     // Create stimuli source component (kept for compatibility)
     StimuliSourceComp = CreateDefaultSubobject<UAIPerceptionStimuliSourceComponent>(TEXT("StimuliSourceComp"));
     
+    // Create the brain up front, RunBehaviorTree only creates a stock behavior tree component when there's none
+    BotBehaviorTreeComp = CreateDefaultSubobject<UBotBehaviorTreeComponent>(TEXT("BotBehaviorTreeComp"));
+    BrainComponent = BotBehaviorTreeComp;
+    
     // Create path following component
     BotPathFollowingComp = CreateDefaultSubobject<UBotPathFollowingComponent>(TEXT("BotPathFollowingComp"));
 }
@@ -39,15 +51,21 @@ void ABotController::BeginPlay()
     }
 }
 
-void ABotController::Tick(float DeltaTime)
-{
-    Super::Tick(DeltaTime);
-}
-
 void ABotController::OnPossess(APawn* InPawn)
 {
     Super::OnPossess(InPawn);
     
+    // Report the team of the bot so the perception system can filter by affiliation
+    if (AAICharacter* Bot = Cast<AAICharacter>(InPawn))
+    {
+        SetGenericTeamId(Bot->GetGenericTeamId());
+        
+        if (UBotTeamComponent* TeamComponent = Bot->GetTeamComponent())
+        {
+            TeamComponent->OnTeamChanged.AddUniqueDynamic(this, &ABotController::OnPawnTeamChanged);
+        }
+    }
+    
     // Initialize behavior
     if (BotBehaviorComponent)
     {
@@ -63,12 +81,31 @@ void ABotController::OnPossess(APawn* InPawn)
 
 void ABotController::OnUnPossess()
 {
+    if (const AAICharacter* Bot = Cast<AAICharacter>(GetPawn()))
+    {
+        if (UBotTeamComponent* TeamComponent = Bot->GetTeamComponent())
+        {
+            TeamComponent->OnTeamChanged.RemoveDynamic(this, &ABotController::OnPawnTeamChanged);
+        }
+    }
+    
     Super::OnUnPossess();
     
     // By default the controller will stay in the level so manually destroy this actor
     Destroy();
 }
 
+void ABotController::OnPawnTeamChanged(ETeam NewTeam)
+{
+    SetGenericTeamId(FGenericTeamId(static_cast<uint8>(NewTeam)));
+    
+    // The listener caches its team when it registers
+    if (PerceptionComp)
+    {
+        PerceptionComp->RequestStimuliListenerUpdate();
+    }
+}
+
 FVector ABotController::GetSelectedTargetLocation() const
 {
     if (BotPerceptionComponent)
@@ -123,6 +160,14 @@ void ABotController::InitiateRetreat()
     }
 }
 
+void ABotController::InitiateRetreatFrom(const FVector& ThreatLocation)
+{
+    if (BotBehaviorComponent)
+    {
+        BotBehaviorComponent->InitiateRetreatFrom(ThreatLocation);
+    }
+}
+
 void ABotController::SetCollectAmmoStatus(bool NewStatus)
 {
     if (BotBehaviorComponent)
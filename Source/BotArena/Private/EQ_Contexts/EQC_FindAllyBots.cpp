@@ -5,12 +5,10 @@
 #include "EnvironmentQuery/EnvQueryTypes.h"
 #include "EnvironmentQuery/Items/EnvQueryItemType_Actor.h"
 #include "Characters/AICharacter.h"
-#include "CollisionQueryParams.h"
-#include "WorldCollision.h"
+#include "Subsystems/BotRegistrySubsystem.h"
+#include "Subsystems/BotEQSSubsystem.h"
 #include "Engine/World.h"
 
-#include "DrawDebugHelpers.h"
-
 void UEQC_FindAllyBots::ProvideContext(FEnvQueryInstance& QueryInstance, FEnvQueryContextData& ContextData) const
 {
 	Super::ProvideContext(QueryInstance, ContextData);
@@ -21,63 +19,60 @@ void UEQC_FindAllyBots::ProvideContext(FEnvQueryInstance& QueryInstance, FEnvQue
 	{
 		AAICharacter* OwnerActor = Cast<AAICharacter>(QueryOwner);
 
-		if (OwnerActor)
-		{
-			ETeam CurrentTeam = OwnerActor->GetTeam();
-
-			FCollisionObjectQueryParams CollisionObjectParams = FCollisionObjectQueryParams(ECC_Pawn);
+		UBotRegistrySubsystem* Registry = UWorld::GetSubsystem<UBotRegistrySubsystem>(QueryOwner->GetWorld());
 
-			FCollisionShape CollisionShape = FCollisionShape();
-			CollisionShape.ShapeType = ECollisionShape::Sphere;
-			CollisionShape.SetSphere(350.f);
+		if (OwnerActor && Registry)
+		{
+			UBotEQSSubsystem* EQSSubsystem = UWorld::GetSubsystem<UBotEQSSubsystem>(QueryOwner->GetWorld());
 
-			TArray<FHitResult> OutHits;
-			TArray<AActor*> AllyBots;
-			
-			/*DrawDebugSphere(GetWorld(), ((OwnerActor->GetActorLocation() + FVector(150.f) - OwnerActor->GetActorLocation()) / 2) + OwnerActor->GetActorLocation(), 350.f, 10, FColor::Green, true);*/
+			if (!EQSSubsystem || !UBotEQSSubsystem::IsResultCacheEnabled())
+			{
+				//Only the bucket of our own team is visited and each registered bot appears once,
+				//so the querier is the only actor we have to exclude
+				Registry->GetAlliesInRadius(OwnerActor, AllySearchRadius, AllyBotsBuffer);
 
-			//Perform a sweep for nearby bots
-			if (GetWorld()->SweepMultiByObjectType(OutHits, OwnerActor->GetActorLocation(), OwnerActor->GetActorLocation()+FVector(150.f), FQuat(), CollisionObjectParams, CollisionShape))
+				AllyActorsBuffer.Reset();
+				AllyActorsBuffer.Append(AllyBotsBuffer);
+			}
+			else
 			{
-				for (int32 HitIndex = 0; HitIndex < OutHits.Num(); HitIndex++)
+				const FBotEQSResultKey Key = UBotEQSSubsystem::MakeResultKey(this, OwnerActor->GetActorLocation(),
+					static_cast<uint8>(OwnerActor->GetTeam()), GetTypeHash(AllySearchRadius));
+
+				const TArray<TWeakObjectPtr<AActor>>* SharedAllies = EQSSubsystem->FindCachedActors(Key);
+				if (!SharedAllies)
 				{
-					AAICharacter* HitActor = Cast<AAICharacter>(OutHits[HitIndex].GetActor());
+					//Search wide enough for any bot of the cell and keep ourselves in the list, we're an ally of our squad mates
+					const float SharedRadius = AllySearchRadius + UBotEQSSubsystem::GetResultCacheCellSize() * UE_SQRT_2;
+					Registry->GetAlliesInRadius(OwnerActor, SharedRadius, AllyBotsBuffer);
+
+					AllyActorsBuffer.Reset();
+					AllyActorsBuffer.Append(AllyBotsBuffer);
+					AllyActorsBuffer.Add(OwnerActor);
+
+					SharedAllies = &EQSSubsystem->StoreCachedActors(Key, AllyActorsBuffer);
+				}
 
-					//Only include valid bots in our final contexts;
-					//We want to exclude the actor that performs the query plus any duplicate actors
-					if (HitActor && HitActor!=OwnerActor && 
-						OwnerActor->SameTeam(HitActor) && !AlreadyTracedActor(AllyBots,*HitActor))
+				//Keep the shared allies that are actually within our own radius
+				const FVector OwnerLocation = OwnerActor->GetActorLocation();
+				const float RadiusSquared = FMath::Square(AllySearchRadius);
+
+				AllyActorsBuffer.Reset();
+				for (const TWeakObjectPtr<AActor>& SharedAlly : *SharedAllies)
+				{
+					AActor* Ally = SharedAlly.Get();
+					if (Ally && Ally != OwnerActor && FVector::DistSquared(Ally->GetActorLocation(), OwnerLocation) <= RadiusSquared)
 					{
-						AllyBots.Add(HitActor);
+						AllyActorsBuffer.Add(Ally);
 					}
 				}
 			}
 
-			/*GLog->Log("ally bots found : " + FString::FromInt(AllyBots.Num() - 1));
-			GLog->Log("ally bots of: " + OwnerActor->GetName());
-			for (int32 i = 0; i < AllyBots.Num(); i++)
-			{
-				GLog->Log(AllyBots[i]->GetName());
-			}*/
-
-			//Include the bots we found on the previous sweep in our context
-			UEnvQueryItemType_Actor::SetContextHelper(ContextData, AllyBots);
+			//Include the bots we found in our context
+			UEnvQueryItemType_Actor::SetContextHelper(ContextData, AllyActorsBuffer);
 
 		}
 		
 	}
 
-}
-
-bool UEQC_FindAllyBots::AlreadyTracedActor(const TArray<AActor*>& TracedActors, const AActor& ActorToCheck) const
-{
-	for (int32 ActorIndex = 0; ActorIndex < TracedActors.Num(); ActorIndex++)
-	{
-		if (TracedActors[ActorIndex]->GetName() == ActorToCheck.GetName())
-		{
-			//GLog->Log("already traced this actor!");
-			return true;
-		}
-	}
-	return false;
 }
\ No newline at end of file
@@ -2,31 +2,148 @@
 
 
 #include "EQ_Generators/EQG_NearbyPoints.h"
+#include "Subsystems/BotEQSSubsystem.h"
+#include "Subsystems/BotFrameBudgetSubsystem.h"
+#include "Subsystems/BotSidestepSubsystem.h"
+#include "Characters/AICharacter.h"
+#include "Controllers/BotController.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
 
 void UEQG_NearbyPoints::GenerateItems(FEnvQueryInstance& QueryInstance) const
 {
-	TArray<FNavLocation> LocationCandidates;
+	LocationCandidates.Reset();
 
 	AActor* AIPawn = Cast<AActor>((QueryInstance.Owner).Get());
 
 	if (!AIPawn || AngleStep <= 0) return;
 
-	FVector PawnLocation = AIPawn->GetActorLocation();
-	FVector PawnForwardVector = AIPawn->GetActorForwardVector();
+	UBotEQSSubsystem* EQSSubsystem = UWorld::GetSubsystem<UBotEQSSubsystem>(AIPawn->GetWorld());
 
-	for (float Angle = DegreesGap; Angle < 360-DegreesGap; Angle += AngleStep)
+	if (!EQSSubsystem) return;
+
+	FBotBudgetScope BudgetScope(AIPawn->GetWorld(), EBotBudgetDomain::EQS);
+
+	//Over the EQS budget the least significant bots get a sparser ring
+	const UBotFrameBudgetSubsystem* Budget = UWorld::GetSubsystem<UBotFrameBudgetSubsystem>(AIPawn->GetWorld());
+	const float SpacingScale = Budget ? Budget->GetEQSSpacingScale(AIPawn) : 1.f;
+	const float ScaledAngleStep = AngleStep * SpacingScale;
+	const float ScaledPointsDistance = PointsDistance * SpacingScale;
+
+	const FBotRingTemplate& Ring = EQSSubsystem->GetRingTemplate(ScaledAngleStep, DegreesGap, ScaledPointsDistance, MaxRange);
+
+	if (!UBotEQSSubsystem::IsResultCacheEnabled())
+	{
+		GenerateProjectedRing(QueryInstance, *AIPawn, AIPawn->GetActorLocation(), AIPawn->GetActorForwardVector(), Ring);
+		ShortlistSidesteps(*AIPawn);
+		StoreNavPoints(LocationCandidates, QueryInstance);
+		return;
+	}
+
+	//The ring is snapped to the center of a small cell and to a heading step, so every bot of the same cell
+	//and heading gets the very same points it would have generated, give or take half a cell and half a step
+	const float CellSize = UBotEQSSubsystem::GetPointsCacheCellSize();
+	const float HeadingStep = FMath::Max(ScaledAngleStep, 1.f);
+	const int32 Heading = FMath::RoundToInt32(AIPawn->GetActorForwardVector().HeadingAngle() / FMath::DegreesToRadians(HeadingStep));
+
+	AAICharacter* Bot = Cast<AAICharacter>(AIPawn);
+	const uint8 Team = Bot ? static_cast<uint8>(Bot->GetTeam()) : MAX_uint8;
+
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(AIPawn->GetWorld());
+	const ANavigationData* NavData = NavSys ? NavSys->GetNavDataForActor(*AIPawn) : nullptr;
+
+	//Everything the generated points depend on besides the cell
+	uint32 ContextHash = GetTypeHash(ScaledPointsDistance);
+	ContextHash = HashCombine(ContextHash, GetTypeHash(ScaledAngleStep));
+	ContextHash = HashCombine(ContextHash, GetTypeHash(DegreesGap));
+	ContextHash = HashCombine(ContextHash, GetTypeHash(MaxRange));
+	ContextHash = HashCombine(ContextHash, GetTypeHash(Heading));
+	ContextHash = HashCombine(ContextHash, GetTypeHash(NavData));
+	ContextHash = HashCombine(ContextHash, GetTypeHash(static_cast<uint8>(ProjectionData.TraceMode.GetValue())));
+	ContextHash = HashCombine(ContextHash, GetTypeHash(ProjectionData.NavigationFilter.Get()));
+	ContextHash = HashCombine(ContextHash, GetTypeHash(ProjectionData.ExtentX));
+	ContextHash = HashCombine(ContextHash, GetTypeHash(ProjectionData.ExtentY));
+	ContextHash = HashCombine(ContextHash, GetTypeHash(ProjectionData.ExtentZ));
+	ContextHash = HashCombine(ContextHash, GetTypeHash(ProjectionData.ProjectUp));
+	ContextHash = HashCombine(ContextHash, GetTypeHash(ProjectionData.ProjectDown));
+	ContextHash = HashCombine(ContextHash, GetTypeHash(ProjectionData.PostProjectionVerticalOffset));
+	ContextHash = HashCombine(ContextHash, GetTypeHash(static_cast<uint8>(ProjectionData.TraceShape.GetValue())));
+	ContextHash = HashCombine(ContextHash, GetTypeHash(static_cast<uint8>(ProjectionData.TraceChannel.GetValue())));
+	ContextHash = HashCombine(ContextHash, GetTypeHash(static_cast<uint32>(ProjectionData.bTraceComplex)));
+
+	const FBotEQSResultKey Key = UBotEQSSubsystem::MakeResultKey(this, AIPawn->GetActorLocation(), Team, ContextHash, CellSize);
+
+	if (const TArray<FNavLocation>* CachedPoints = EQSSubsystem->FindCachedPoints(Key))
+	{
+		LocationCandidates = *CachedPoints;
+	}
+	else
+	{
+		//Same ring as without the cache, front gap and range included, only snapped
+		const FVector CellCenter = (FVector(Key.Cell) + 0.5) * CellSize;
+		const FVector HeadingForward = FRotator(0., Heading * HeadingStep, 0.).Vector();
+		GenerateProjectedRing(QueryInstance, *AIPawn, CellCenter, HeadingForward, Ring);
+		EQSSubsystem->StoreCachedPoints(Key, LocationCandidates);
+	}
+
+	//After the cache, the shortlist depends on the bot's target
+	ShortlistSidesteps(*AIPawn);
+	StoreNavPoints(LocationCandidates, QueryInstance);
+}
+
+void UEQG_NearbyPoints::ShortlistSidesteps(const AActor& AIPawn) const
+{
+	const int32 ShortlistSize = UBotSidestepSubsystem::GetNearbyPointsShortlistSize();
+	const AAICharacter* Bot = Cast<AAICharacter>(&AIPawn);
+	const UBotSidestepSubsystem* Sidestep = UWorld::GetSubsystem<UBotSidestepSubsystem>(AIPawn.GetWorld());
+
+	if (ShortlistSize <= 0 || !Bot || !Sidestep) return;
+
+	//Without a target there is no line of fire to dodge, the query tests get every point
+	const ABotController* BotController = Cast<ABotController>(Bot->GetController());
+	const AActor* Target = BotController ? BotController->GetSelectedTarget() : nullptr;
+
+	if (!Target) return;
+
+	FBotSidestepParams Params;
+	Params.MaxRange = MaxRange;
+	Params.AllySpacing = AllySpacing;
+
+	Sidestep->ShortlistCandidates(*Bot, Target, Params, LocationCandidates, ShortlistSize);
+}
+
+void UEQG_NearbyPoints::GenerateProjectedRing(FEnvQueryInstance& QueryInstance, AActor& AIPawn, const FVector& PawnLocation, const FVector& PawnForwardVector, const FBotRingTemplate& Ring) const
+{
+	LocationCandidates.Reset();
+
+	//Rotating the forward vector around the up axis, without calling any trig function
+	const FVector SideVector = FVector::CrossProduct(FVector::UpVector, PawnForwardVector);
+	const FVector UpComponent = FVector::UpVector * PawnForwardVector.Z;
+
+	LocationCandidates.Reserve(Ring.GetNumPoints());
+
+	for (const FVector2f& Direction : Ring.Directions)
 	{
-		FVector RightVector = PawnForwardVector.RotateAngleAxis(Angle, FVector::UpVector);
+		FVector RightVector = PawnForwardVector * Direction.X + SideVector * Direction.Y + UpComponent * (1.f - Direction.X);
 
-		for (float Distance = PointsDistance; Distance < MaxRange; Distance += PointsDistance)
+		for (const float Distance : Ring.Distances)
 		{
-			FNavLocation NavLocation = FNavLocation(PawnLocation + RightVector * Distance);
-			LocationCandidates.Add(NavLocation);
+			LocationCandidates.Add(FNavLocation(PawnLocation + RightVector * Distance));
 		}
 
 	}
 
-	//Project the generated points and store them as the result of this generator
-	ProjectAndFilterNavPoints(LocationCandidates, QueryInstance);
-	StoreNavPoints(LocationCandidates, QueryInstance);
+	//Project the generated points
+	UBotEQSSubsystem* EQSSubsystem = UWorld::GetSubsystem<UBotEQSSubsystem>(AIPawn.GetWorld());
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(AIPawn.GetWorld());
+	const ANavigationData* NavData = NavSys ? NavSys->GetNavDataForActor(AIPawn) : nullptr;
+
+	if (EQSSubsystem && NavData && ProjectionData.TraceMode == EEnvQueryTrace::Navigation)
+	{
+		EQSSubsystem->ProjectPoints(*NavData, AIPawn, ProjectionData, LocationCandidates);
+	}
+	else
+	{
+		ProjectAndFilterNavPoints(LocationCandidates, QueryInstance);
+	}
 }
@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Environment/BotCoverData.h"
+#include "Misc/PackageName.h"
+
+int32 FBotCoverPoint::GetDirectionIndex(const FVector& Direction)
+{
+    const float Angle = FMath::Atan2(Direction.Y, Direction.X);
+    const int32 Index = FMath::RoundToInt32(Angle / (UE_TWO_PI / NumDirections));
+    return (Index + NumDirections) % NumDirections;
+}
+
+FString UBotCoverData::GetPackageNameForMap(const FString& MapName)
+{
+    return FString::Printf(TEXT("/Game/AI/Cover/Cover_%s"), *FPackageName::GetShortName(MapName));
+}
+
+void UBotCoverData::SetPoints(TArray<FBotCoverPoint>&& InPoints, const FVector& InOrigin, float InCellSize, const FIntPoint& InDimensions)
+{
+    Origin = InOrigin;
+    CellSize = FMath::Max(InCellSize, 1.f);
+    Dimensions = FIntPoint(FMath::Max(InDimensions.X, 1), FMath::Max(InDimensions.Y, 1));
+    Points = MoveTemp(InPoints);
+
+    const auto GetCellIndex = [this](const FBotCoverPoint& Point)
+    {
+        const FIntPoint Cell = GetCell(FVector(Point.Location));
+        return Cell.Y * Dimensions.X + Cell.X;
+    };
+
+    Points.StableSort([&GetCellIndex](const FBotCoverPoint& A, const FBotCoverPoint& B)
+    {
+        return GetCellIndex(A) < GetCellIndex(B);
+    });
+
+    // Count the points of every cell then turn the counts into start offsets
+    const int32 NumCells = Dimensions.X * Dimensions.Y;
+    CellStart.Reset();
+    CellStart.SetNumZeroed(NumCells + 1);
+
+    for (const FBotCoverPoint& Point : Points)
+    {
+        CellStart[GetCellIndex(Point) + 1]++;
+    }
+
+    for (int32 Cell = 0; Cell < NumCells; Cell++)
+    {
+        CellStart[Cell + 1] += CellStart[Cell];
+    }
+}
+
+FIntPoint UBotCoverData::GetCell(const FVector& Location) const
+{
+    return FIntPoint(
+        FMath::Clamp(FMath::FloorToInt32((Location.X - Origin.X) / CellSize), 0, Dimensions.X - 1),
+        FMath::Clamp(FMath::FloorToInt32((Location.Y - Origin.Y) / CellSize), 0, Dimensions.Y - 1));
+}
+
+bool UBotCoverData::FindBestCover(const FVector& BotLocation, const FVector& ThreatLocation, float MaxDistance, TFunctionRef<float(const FVector&)> GetPenalty, FBotCoverPoint& OutPoint) const
+{
+    if (Points.Num() == 0 || CellStart.Num() != Dimensions.X * Dimensions.Y + 1)
+    {
+        return false;
+    }
+
+    const FVector3f Bot(BotLocation);
+    const FVector3f Threat(ThreatLocation);
+    const float MaxDistanceSquared = FMath::Square(MaxDistance);
+
+    const FIntPoint MinCell = GetCell(BotLocation - FVector(MaxDistance, MaxDistance, 0.f));
+    const FIntPoint MaxCell = GetCell(BotLocation + FVector(MaxDistance, MaxDistance, 0.f));
+
+    const FBotCoverPoint* BestPoint = nullptr;
+    float BestScore = -MAX_flt;
+
+    for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; CellY++)
+    {
+        for (int32 CellX = MinCell.X; CellX <= MaxCell.X; CellX++)
+        {
+            const int32 Cell = CellY * Dimensions.X + CellX;
+
+            for (int32 Index = CellStart[Cell]; Index < CellStart[Cell + 1]; Index++)
+            {
+                const FBotCoverPoint& Point = Points[Index];
+
+                const float BotDistanceSquared = FVector3f::DistSquared(Point.Location, Bot);
+                if (BotDistanceSquared > MaxDistanceSquared)
+                {
+                    continue;
+                }
+
+                // The geometry has to stand between the point and the threat
+                const FVector3f ToThreat = Threat - Point.Location;
+                if (Point.IsExposedFrom(FBotCoverPoint::GetDirectionIndex(FVector(ToThreat))))
+                {
+                    continue;
+                }
+
+                // Close to the bot, away from the threat, with the wall squarely facing it
+                const float ThreatDistance = ToThreat.Size();
+                const float Facing = -FVector3f::DotProduct(Point.Normal, ToThreat / FMath::Max(ThreatDistance, 1.f));
+                const float Score = Facing - FMath::Sqrt(BotDistanceSquared) / FMath::Max(MaxDistance, 1.f) + FMath::Min(ThreatDistance / FMath::Max(MaxDistance, 1.f), 1.f)
+                    - GetPenalty(FVector(Point.Location));
+
+                if (Score > BestScore)
+                {
+                    BestScore = Score;
+                    BestPoint = &Point;
+                }
+            }
+        }
+    }
+
+    if (!BestPoint)
+    {
+        return false;
+    }
+
+    OutPoint = *BestPoint;
+    return true;
+}
@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Environment/BotPVSData.h"
+#include "Misc/PackageName.h"
+
+FString UBotPVSData::GetPackageNameForMap(const FString& MapName)
+{
+    return FString::Printf(TEXT("/Game/AI/PVS/PVS_%s"), *FPackageName::GetShortName(MapName));
+}
+
+void UBotPVSData::InitializeGrid(const FVector& InOrigin, float InCellSize, const FIntPoint& InDimensions)
+{
+    Origin = InOrigin;
+    CellSize = FMath::Max(InCellSize, 1.f);
+    Dimensions = FIntPoint(FMath::Max(InDimensions.X, 0), FMath::Max(InDimensions.Y, 0));
+
+    const int64 NumBits = static_cast<int64>(GetNumCells()) * GetNumCells();
+    VisibilityBits.Reset();
+    VisibilityBits.SetNumZeroed(static_cast<int32>((NumBits + 31) / 32));
+}
+
+void UBotPVSData::SetCellsVisible(int32 CellA, int32 CellB)
+{
+    const int32 NumCells = GetNumCells();
+    if (!ensure(CellA >= 0 && CellA < NumCells && CellB >= 0 && CellB < NumCells))
+    {
+        return;
+    }
+
+    const int64 BitAB = static_cast<int64>(CellA) * NumCells + CellB;
+    const int64 BitBA = static_cast<int64>(CellB) * NumCells + CellA;
+    VisibilityBits[BitAB >> 5] |= 1u << (BitAB & 31);
+    VisibilityBits[BitBA >> 5] |= 1u << (BitBA & 31);
+}
+
+void UBotPVSData::SetCellVisibleFromEverywhere(int32 Cell)
+{
+    for (int32 Other = 0; Other < GetNumCells(); Other++)
+    {
+        SetCellsVisible(Cell, Other);
+    }
+}
+
+int32 UBotPVSData::GetCellIndex(const FVector& Location) const
+{
+    const int32 X = FMath::FloorToInt32((Location.X - Origin.X) / CellSize);
+    const int32 Y = FMath::FloorToInt32((Location.Y - Origin.Y) / CellSize);
+    if (X < 0 || Y < 0 || X >= Dimensions.X || Y >= Dimensions.Y)
+    {
+        return INDEX_NONE;
+    }
+
+    return Y * Dimensions.X + X;
+}
+
+FVector2D UBotPVSData::GetCellCenter(int32 Cell) const
+{
+    const int32 X = Cell % Dimensions.X;
+    const int32 Y = Cell / Dimensions.X;
+    return FVector2D(Origin.X + (X + 0.5f) * CellSize, Origin.Y + (Y + 0.5f) * CellSize);
+}
+
+bool UBotPVSData::CanCellsSee(int32 CellA, int32 CellB) const
+{
+    const int64 Bit = static_cast<int64>(CellA) * GetNumCells() + CellB;
+    return (VisibilityBits[Bit >> 5] & (1u << (Bit & 31))) != 0;
+}
+
+bool UBotPVSData::IsPotentiallyVisible(const FVector& From, const FVector& To) const
+{
+    const int32 CellA = GetCellIndex(From);
+    const int32 CellB = GetCellIndex(To);
+
+    // Nothing is known about locations outside of the baked area
+    if (CellA == INDEX_NONE || CellB == INDEX_NONE)
+    {
+        return true;
+    }
+
+    return CanCellsSee(CellA, CellB);
+}
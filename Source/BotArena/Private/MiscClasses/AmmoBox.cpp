@@ -4,6 +4,8 @@
 #include "MiscClasses/AmmoBox.h"
 #include "Components/BoxComponent.h"
 #include "Characters/AICharacter.h"
+#include "Subsystems/BotAmmoRegistrySubsystem.h"
+#include "BotArenaCollision.h"
 
 void AAmmoBox::OnComponentBeginOverlap(UPrimitiveComponent* OveralappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
@@ -14,6 +16,13 @@ void AAmmoBox::OnComponentBeginOverlap(UPrimitiveComponent* OveralappedComponent
 		{
 			//A bot came and collected this ammo box
 			Bot->AddAmmo(FMath::RandRange(MinAmmo, MaxAmmo));
+
+			//Leave the registry right away so no other bot gets sent here
+			if (UBotAmmoRegistrySubsystem* AmmoRegistry = UWorld::GetSubsystem<UBotAmmoRegistrySubsystem>(GetWorld()))
+			{
+				AmmoRegistry->UnregisterAmmoBox(this);
+			}
+
 			Destroy();
 		}
 	}
@@ -22,8 +31,8 @@ void AAmmoBox::OnComponentBeginOverlap(UPrimitiveComponent* OveralappedComponent
 // Sets default values
 AAmmoBox::AAmmoBox()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Nothing to do per frame
+	PrimaryActorTick.bCanEverTick = false;
 
 	AmmoBoxSM = CreateDefaultSubobject<UStaticMeshComponent>(FName("AmmoBoxSM"));
 
@@ -36,6 +45,9 @@ AAmmoBox::AAmmoBox()
 	if (CollisionBox)
 	{
 		CollisionBox->AttachToComponent(AmmoBoxSM, FAttachmentTransformRules(EAttachmentRule::SnapToTarget, true));
+
+		//The trigger only overlaps bot capsules
+		CollisionBox->SetCollisionProfileName(BotArenaCollisionProfiles::Pickup);
 	}
 	
 
@@ -50,13 +62,21 @@ void AAmmoBox::BeginPlay()
 	{
 		CollisionBox->OnComponentBeginOverlap.AddDynamic(this, &AAmmoBox::OnComponentBeginOverlap);
 	}
+
+	if (UBotAmmoRegistrySubsystem* AmmoRegistry = UWorld::GetSubsystem<UBotAmmoRegistrySubsystem>(GetWorld()))
+	{
+		AmmoRegistry->RegisterAmmoBox(this);
+	}
 	
 }
 
-// Called every frame
-void AAmmoBox::Tick(float DeltaTime)
+void AAmmoBox::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
+	if (UBotAmmoRegistrySubsystem* AmmoRegistry = UWorld::GetSubsystem<UBotAmmoRegistrySubsystem>(GetWorld()))
+	{
+		AmmoRegistry->UnregisterAmmoBox(this);
+	}
 
+	Super::EndPlay(EndPlayReason);
 }
 
@@ -7,8 +7,8 @@
 // Sets default values
 ABotCounter::ABotCounter()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Nothing to do per frame
+	PrimaryActorTick.bCanEverTick = false;
 
 	// Initialize member variables
 	Blue_Bots = 0;
@@ -22,13 +22,6 @@ void ABotCounter::BeginPlay()
 	
 }
 
-// Called every frame
-void ABotCounter::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-
-}
-
 void ABotCounter::OnBotSpawn(ETeam BotTeam)
 {
 	switch (BotTeam)
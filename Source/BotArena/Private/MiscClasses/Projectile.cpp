@@ -5,6 +5,7 @@
 #include "Components/StaticMeshComponent.h"
 #include "Characters/AICharacter.h"
 #include "Engine/DamageEvents.h"
+#include "BotArenaCollision.h"
 
 void AProjectile::OnProjectileHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComponent, FVector NormalImpulse, const FHitResult& Hit)
 {
@@ -24,14 +25,17 @@ void AProjectile::OnProjectileHit(UPrimitiveComponent* HitComponent, AActor* Oth
 // Sets default values
 AProjectile::AProjectile()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Nothing to do per frame
+	PrimaryActorTick.bCanEverTick = false;
 
 	ProjectileSM = CreateDefaultSubobject<UStaticMeshComponent>(FName("ProjectileSM"));
 	
 	if (ProjectileSM)
 	{
 		SetRootComponent(ProjectileSM);
+
+		//Only the level and the bot capsules stop a projectile
+		ProjectileSM->SetCollisionProfileName(BotArenaCollisionProfiles::BotProjectile);
 	}
 
 	ProjectileMovementComp = CreateDefaultSubobject<UProjectileMovementComponent>(FName("ProjectileMovementComp"));
@@ -57,10 +61,3 @@ void AProjectile::BeginPlay()
 	
 }
 
-// Called every frame
-void AProjectile::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-
-}
-
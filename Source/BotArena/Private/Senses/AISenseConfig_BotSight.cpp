@@ -0,0 +1,16 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Senses/AISenseConfig_BotSight.h"
+
+UAISenseConfig_BotSight::UAISenseConfig_BotSight()
+{
+    DebugColor = FColor::Green;
+    Implementation = UAISense_BotSight::StaticClass();
+
+    DetectionByAffiliation.bDetectEnemies = true;
+}
+
+TSubclassOf<UAISense> UAISenseConfig_BotSight::GetSenseImplementation() const
+{
+    return Implementation;
+}
@@ -0,0 +1,407 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Senses/AISense_BotSight.h"
+#include "Senses/AISenseConfig_BotSight.h"
+#include "Subsystems/BotRegistrySubsystem.h"
+#include "Subsystems/BotVisibilitySubsystem.h"
+#include "Subsystems/BotSquadKnowledgeSubsystem.h"
+#include "Subsystems/BotSignificanceSubsystem.h"
+#include "Subsystems/BotFrameBudgetSubsystem.h"
+#include "Subsystems/BotSceneQuerySubsystem.h"
+#include "Characters/AICharacter.h"
+#include "Controllers/BotController.h"
+#include "Components/BotPerceptionComponent.h"
+#include "Utils/BotSpatialKernels.h"
+#include "Perception/AIPerceptionComponent.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "BotArenaCollision.h"
+#include "LogBotArena.h"
+
+static TAutoConsoleVariable<int32> CVarBotSightTraceBudget(
+    TEXT("BotArena.Sight.TraceBudget"),
+    24,
+    TEXT("Maximum number of line of sight traces the bot sight sense requests per frame"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotSightTargetBonus(
+    TEXT("BotArena.Sight.TargetBonus"),
+    2.0f,
+    TEXT("Priority added to the check of a listener's current target"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotSightAgeWeight(
+    TEXT("BotArena.Sight.AgeWeight"),
+    2.0f,
+    TEXT("Priority added per second since a pair was last checked"),
+    ECVF_Default);
+
+UAISense_BotSight::UAISense_BotSight()
+{
+    OnNewListenerDelegate.BindUObject(this, &UAISense_BotSight::OnNewListenerImpl);
+    OnListenerUpdateDelegate.BindUObject(this, &UAISense_BotSight::OnListenerUpdateImpl);
+    OnListenerRemovedDelegate.BindUObject(this, &UAISense_BotSight::OnListenerRemovedImpl);
+}
+
+void UAISense_BotSight::OnNewListenerImpl(const FPerceptionListener& NewListener)
+{
+    const UAIPerceptionComponent* PerceptionComp = NewListener.Listener.Get();
+    const UAISenseConfig_BotSight* SenseConfig = PerceptionComp ? Cast<const UAISenseConfig_BotSight>(PerceptionComp->GetSenseConfig(GetSenseID())) : nullptr;
+    if (!SenseConfig)
+    {
+        return;
+    }
+
+    FDigestedProperties& Properties = DigestedProperties.FindOrAdd(NewListener.GetListenerID());
+    Properties.SightRadius = SenseConfig->SightRadius;
+    Properties.SightRadiusSquared = FMath::Square(SenseConfig->SightRadius);
+    Properties.LoseSightRadiusSquared = FMath::Square(FMath::Max(SenseConfig->LoseSightRadius, SenseConfig->SightRadius));
+    Properties.PeripheralVisionCos = FMath::Cos(FMath::DegreesToRadians(FMath::Clamp(SenseConfig->PeripheralVisionAngleDegrees, 0.f, 180.f)));
+    Properties.AffiliationFlags = SenseConfig->DetectionByAffiliation.GetAsFlags();
+}
+
+void UAISense_BotSight::OnListenerUpdateImpl(const FPerceptionListener& UpdatedListener)
+{
+    if (UpdatedListener.HasSense(GetSenseID()))
+    {
+        OnNewListenerImpl(UpdatedListener);
+    }
+    else
+    {
+        OnListenerRemovedImpl(UpdatedListener);
+    }
+}
+
+void UAISense_BotSight::OnListenerRemovedImpl(const FPerceptionListener& RemovedListener)
+{
+    const FPerceptionListenerID ListenerId = RemovedListener.GetListenerID();
+    DigestedProperties.Remove(ListenerId);
+
+    for (auto It = PairStates.CreateIterator(); It; ++It)
+    {
+        if (It.Key().ListenerId == ListenerId)
+        {
+            ReleaseTrace(It.Value());
+            It.RemoveCurrent();
+        }
+    }
+}
+
+float UAISense_BotSight::Update()
+{
+    FBotBudgetScope BudgetScope(GetWorld(), EBotBudgetDomain::Perception);
+
+    UBotRegistrySubsystem* Registry = UWorld::GetSubsystem<UBotRegistrySubsystem>(GetWorld());
+    if (!Registry || DigestedProperties.Num() == 0)
+    {
+        return 0.f;
+    }
+
+    Registry->RefreshBots();
+    GatherTargets();
+
+    AIPerception::FListenerMap& Listeners = GetListeners();
+
+    // The traces requested on the previous updates report first
+    CollectTraceResults();
+
+    // Dormant bots disable the sense on their perception component, which removes them from the digested listeners
+    Queue.Reset();
+    for (const TPair<FPerceptionListenerID, FDigestedProperties>& Pair : DigestedProperties)
+    {
+        const FPerceptionListener* Listener = Listeners.Find(Pair.Key);
+        if (Listener)
+        {
+            QueueChecks(*Listener, Pair.Value);
+        }
+    }
+
+    // Pairs that left the range or the cone are lost without a trace
+    ForgetStalePairs();
+
+    UWorld* World = GetWorld();
+    UBotSceneQuerySubsystem* SceneQueries = UWorld::GetSubsystem<UBotSceneQuerySubsystem>(World);
+    if (!SceneQueries)
+    {
+        return 0.f;
+    }
+
+    const double Now = World->GetTimeSeconds();
+    // The frame budget trims the traces when perception runs over, the lowest priority checks wait longer
+    const UBotFrameBudgetSubsystem* Budget = UWorld::GetSubsystem<UBotFrameBudgetSubsystem>(World);
+    const float TraceBudgetScale = Budget ? Budget->GetTraceBudgetScale() : 1.f;
+    const int32 TraceBudget = FMath::CeilToInt32(FMath::Max(CVarBotSightTraceBudget.GetValueOnGameThread(), 0) * TraceBudgetScale);
+    const int32 NumQueued = Queue.Num();
+    const int32 NumToCheck = FMath::Min(TraceBudget, NumQueued);
+
+    // Only the most important checks get a trace, the rest ages and climbs the queue. A heap hands out the best few without ordering the whole queue
+    Queue.Heapify();
+
+    for (int32 Index = 0; Index < NumToCheck; Index++)
+    {
+        FQueuedCheck Check;
+        Queue.HeapPop(Check, EAllowShrinking::No);
+
+        FPerceptionListener* Listener = Listeners.Find(Check.Key.ListenerId);
+        FPairState& State = PairStates.FindChecked(Check.Key);
+        AActor* Target = State.Target.Get();
+        if (!Listener || !Target)
+        {
+            continue;
+        }
+
+        const FVector TargetLocation(TargetX[Check.TargetSlot], TargetY[Check.TargetSlot], TargetZ[Check.TargetSlot]);
+
+        // Merged with the identical traces of the frame and dispatched within the scene query budget, the result is collected on a later update
+        FBotSceneQueryDesc Desc = FBotSceneQueryDesc::LineTraceByChannel(EAsyncTraceType::Single, Listener->CachedLocation, TargetLocation,
+            ECC_LOSBlocker, FName("BotSight"));
+        Desc.IgnoreActor(Listener->GetBodyActor()).IgnoreActor(Target);
+
+        State.PendingTrace = SceneQueries->Request(Desc, EBotSceneQueryPriority::Normal);
+        State.LastCheckTime = Now;
+        PendingTraces.Add(Check.Key);
+    }
+
+    if (NumQueued > NumToCheck)
+    {
+        UE_LOG(LogBotArena, VeryVerbose, TEXT("Bot sight budget of %d exhausted, %d checks deferred"), NumToCheck, NumQueued - NumToCheck);
+    }
+
+    return 0.f;
+}
+
+void UAISense_BotSight::CollectTraceResults()
+{
+    UBotSceneQuerySubsystem* SceneQueries = UWorld::GetSubsystem<UBotSceneQuerySubsystem>(GetWorld());
+    if (!SceneQueries)
+    {
+        return;
+    }
+
+    AIPerception::FListenerMap& Listeners = GetListeners();
+
+    for (int32 Index = PendingTraces.Num() - 1; Index >= 0; Index--)
+    {
+        // Forgotten pairs released their trace already
+        FPairState* State = PairStates.Find(PendingTraces[Index]);
+        if (!State || !State->PendingTrace.IsValid())
+        {
+            PendingTraces.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+            continue;
+        }
+
+        const EBotSceneQueryStatus Status = SceneQueries->GetResult(State->PendingTrace, TraceHits);
+        if (Status == EBotSceneQueryStatus::Pending)
+        {
+            continue;
+        }
+
+        SceneQueries->Release(State->PendingTrace);
+        FPerceptionListener* Listener = Listeners.Find(PendingTraces[Index].ListenerId);
+        PendingTraces.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+        // A lost result leaves the pair as it was, it gets queued again
+        AActor* Target = State->Target.Get();
+        if (Status != EBotSceneQueryStatus::Ready || !Listener || !Target)
+        {
+            continue;
+        }
+
+        bool bVisible = true;
+        for (const FHitResult& Hit : TraceHits)
+        {
+            if (Hit.bBlockingHit)
+            {
+                bVisible = false;
+                break;
+            }
+        }
+
+        // A visible target is reported on every check so the stimulus location stays fresh
+        if (bVisible || State->bVisible)
+        {
+            ReportStimulus(*Listener, Target, bVisible);
+        }
+
+        State->bVisible = bVisible;
+    }
+}
+
+void UAISense_BotSight::ReleaseTrace(FPairState& State)
+{
+    if (!State.PendingTrace.IsValid())
+    {
+        return;
+    }
+
+    if (UBotSceneQuerySubsystem* SceneQueries = UWorld::GetSubsystem<UBotSceneQuerySubsystem>(GetWorld()))
+    {
+        SceneQueries->Release(State.PendingTrace);
+    }
+    State.PendingTrace.Invalidate();
+}
+
+void UAISense_BotSight::GatherTargets()
+{
+    const UBotRegistrySubsystem* Registry = UWorld::GetSubsystem<UBotRegistrySubsystem>(GetWorld());
+    const int32 NumSlots = Registry->GetNumSlots();
+
+    TargetX.SetNumUninitialized(NumSlots, EAllowShrinking::No);
+    TargetY.SetNumUninitialized(NumSlots, EAllowShrinking::No);
+    TargetZ.SetNumUninitialized(NumSlots, EAllowShrinking::No);
+    TargetTeam.SetNumUninitialized(NumSlots, EAllowShrinking::No);
+    TargetAlive.SetNumUninitialized(NumSlots, EAllowShrinking::No);
+
+    for (int32 Slot = 0; Slot < NumSlots; Slot++)
+    {
+        const AAICharacter* Bot = Registry->GetBotAtSlot(Slot);
+        const FVector& Location = Registry->GetLocationAtSlot(Slot);
+
+        TargetX[Slot] = Location.X;
+        TargetY[Slot] = Location.Y;
+        TargetZ[Slot] = Location.Z;
+        TargetTeam[Slot] = static_cast<uint8>(Registry->GetTeamAtSlot(Slot));
+        TargetAlive[Slot] = Bot && Bot->IsAlive();
+    }
+}
+
+void UAISense_BotSight::QueueChecks(const FPerceptionListener& Listener, const FDigestedProperties& Properties)
+{
+    const UBotRegistrySubsystem* Registry = UWorld::GetSubsystem<UBotRegistrySubsystem>(GetWorld());
+    const UBotVisibilitySubsystem* Visibility = UWorld::GetSubsystem<UBotVisibilitySubsystem>(GetWorld());
+    const AActor* Body = Listener.GetBodyActor();
+    const int32 NumSlots = TargetX.Num();
+
+    // Distance and cone for every bot at once
+    const FVector3f Origin(Listener.CachedLocation);
+    const FVector3f Forward(Listener.CachedDirection.GetSafeNormal());
+    DistSquared.SetNumUninitialized(NumSlots, EAllowShrinking::No);
+    ForwardDot.SetNumUninitialized(NumSlots, EAllowShrinking::No);
+    FBotSpatialKernels::DistanceSquared(TargetX.GetData(), TargetY.GetData(), TargetZ.GetData(), NumSlots, Origin, DistSquared.GetData());
+    FBotSpatialKernels::DotDirection(TargetX.GetData(), TargetY.GetData(), TargetZ.GetData(), NumSlots, Origin, Forward, ForwardDot.GetData());
+
+    const UAIPerceptionComponent* PerceptionComp = Listener.Listener.Get();
+    const ABotController* BotController = PerceptionComp ? Cast<ABotController>(PerceptionComp->GetOwner()) : nullptr;
+    const UBotPerceptionComponent* BotPerception = BotController ? BotController->GetBotPerceptionComponent() : nullptr;
+    const AActor* CurrentTarget = BotPerception ? BotPerception->GetSelectedTarget() : nullptr;
+
+    // Squad followers see through their leader most of the time and quiet bots need fewer updates. Their pairs still
+    // pass the prefilter so nothing is lost in between, only their checks are skipped. The listener id staggers the
+    // listeners over the interval
+    const UBotSquadKnowledgeSubsystem* SquadKnowledge = UWorld::GetSubsystem<UBotSquadKnowledgeSubsystem>(GetWorld());
+    const UBotSignificanceSubsystem* Significance = UWorld::GetSubsystem<UBotSignificanceSubsystem>(GetWorld());
+
+    int32 CheckInterval = Significance ? Significance->GetSightInterval(Body) : 1;
+    if (SquadKnowledge && SquadKnowledge->IsFollower(Body))
+    {
+        CheckInterval = FMath::Max(CheckInterval, UBotSquadKnowledgeSubsystem::GetFollowerSightInterval());
+    }
+
+    const bool bSkipChecks = (GFrameCounter + Listener.GetListenerID().Index) % CheckInterval != 0;
+
+    const double Now = GetWorld()->GetTimeSeconds();
+    const float TargetBonus = CVarBotSightTargetBonus.GetValueOnGameThread();
+    const float AgeWeight = CVarBotSightAgeWeight.GetValueOnGameThread();
+    const float CosSquared = FMath::Square(Properties.PeripheralVisionCos);
+    const bool bWideCone = Properties.PeripheralVisionCos < 0.f;
+
+    for (int32 Slot = 0; Slot < NumSlots; Slot++)
+    {
+        if (!TargetAlive[Slot])
+        {
+            continue;
+        }
+
+        AAICharacter* Target = Registry->GetBotAtSlot(Slot);
+        if (Target == Body)
+        {
+            continue;
+        }
+
+        if (!FAISenseAffiliationFilter::ShouldSenseTeam(Listener.TeamIdentifier, FGenericTeamId(TargetTeam[Slot]), Properties.AffiliationFlags))
+        {
+            continue;
+        }
+
+        const FPairKey Key{ Listener.GetListenerID(), FObjectKey(Target) };
+        FPairState* State = PairStates.Find(Key);
+        const bool bWasVisible = State && State->bVisible;
+
+        // Targets already seen are kept up to the lose sight radius
+        const float MaxDistSquared = bWasVisible ? Properties.LoseSightRadiusSquared : Properties.SightRadiusSquared;
+        if (DistSquared[Slot] > MaxDistSquared)
+        {
+            continue;
+        }
+
+        // Inside the cone when cos(angle) >= PeripheralVisionCos, compared squared to avoid the square root
+        const float Dot = ForwardDot[Slot];
+        const bool bInCone = bWideCone
+            ? (Dot >= 0.f || Dot * Dot <= CosSquared * DistSquared[Slot])
+            : (Dot >= 0.f && Dot * Dot >= CosSquared * DistSquared[Slot]);
+        if (!bInCone)
+        {
+            continue;
+        }
+
+        // Static geometry between the two cells, no trace will ever see through it
+        const FVector TargetLocation(TargetX[Slot], TargetY[Slot], TargetZ[Slot]);
+        if (Visibility && !Visibility->IsPotentiallyVisible(Listener.CachedLocation, TargetLocation))
+        {
+            continue;
+        }
+
+        if (!State)
+        {
+            State = &PairStates.Add(Key);
+            State->Target = Target;
+        }
+
+        State->LastCandidateFrame = GFrameCounter;
+
+        // A pair waiting for its trace isn't checked again until the result is in
+        if (bSkipChecks || State->PendingTrace.IsValid())
+        {
+            continue;
+        }
+
+        const float Threat = 1.f - FMath::Min(FMath::Sqrt(DistSquared[Slot]) / FMath::Max(Properties.SightRadius, 1.f), 1.f);
+        const float Age = static_cast<float>(Now - State->LastCheckTime);
+
+        FQueuedCheck& Check = Queue.AddDefaulted_GetRef();
+        Check.Key = Key;
+        Check.TargetSlot = Slot;
+        Check.Priority = Threat + (Target == CurrentTarget ? TargetBonus : 0.f) + AgeWeight * Age;
+    }
+}
+
+void UAISense_BotSight::ReportStimulus(FPerceptionListener& Listener, AActor* Target, bool bVisible)
+{
+    const FVector TargetLocation = Target->GetActorLocation();
+    Listener.RegisterStimulus(Target, FAIStimulus(*this, bVisible ? 1.f : 0.f, TargetLocation, Listener.CachedLocation,
+        bVisible ? FAIStimulus::SensingSucceeded : FAIStimulus::SensingFailed));
+}
+
+void UAISense_BotSight::ForgetStalePairs()
+{
+    AIPerception::FListenerMap& Listeners = GetListeners();
+
+    for (auto It = PairStates.CreateIterator(); It; ++It)
+    {
+        FPairState& State = It.Value();
+        if (State.LastCandidateFrame == GFrameCounter)
+        {
+            continue;
+        }
+
+        AActor* Target = State.Target.Get();
+        FPerceptionListener* Listener = Listeners.Find(It.Key().ListenerId);
+        if (State.bVisible && Target && Listener)
+        {
+            ReportStimulus(*Listener, Target, false);
+        }
+
+        ReleaseTrace(State);
+        It.RemoveCurrent();
+    }
+}
@@ -0,0 +1,209 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/BotAmmoRegistrySubsystem.h"
+#include "Subsystems/BotInfluenceMapSubsystem.h"
+#include "MiscClasses/AmmoBox.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "LogBotArena.h"
+
+static TAutoConsoleVariable<float> CVarBotAmmoCellSize(
+    TEXT("BotArena.Ammo.CellSize"),
+    1000.0f,
+    TEXT("Edge length of an ammo registry grid cell in world units. Read when the world starts."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotAmmoReservationTimeout(
+    TEXT("BotArena.Ammo.ReservationTimeout"),
+    10.0f,
+    TEXT("Seconds after which an ammo box reservation expires if the bot didn't pick the box up"),
+    ECVF_Default);
+
+void UBotAmmoRegistrySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    Grid.SetCellSize(CVarBotAmmoCellSize.GetValueOnGameThread());
+}
+
+void UBotAmmoRegistrySubsystem::Deinitialize()
+{
+    Entries.Reset();
+    FreeSlots.Reset();
+    SlotByBox.Reset();
+    ReservationByBot.Reset();
+    Grid.Reset();
+
+    Super::Deinitialize();
+}
+
+bool UBotAmmoRegistrySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UBotAmmoRegistrySubsystem::RegisterAmmoBox(AAmmoBox* AmmoBox)
+{
+    if (!IsValid(AmmoBox))
+    {
+        UE_LOG(LogBotArena, Warning, TEXT("RegisterAmmoBox: Invalid ammo box"));
+        return;
+    }
+
+    if (SlotByBox.Contains(AmmoBox))
+    {
+        return;
+    }
+
+    const int32 Slot = FreeSlots.Num() > 0 ? FreeSlots.Pop(EAllowShrinking::No) : Entries.AddDefaulted();
+
+    // Ammo boxes don't move, so the location is read once
+    FAmmoBoxEntry& Entry = Entries[Slot];
+    Entry.AmmoBox = AmmoBox;
+    Entry.Location = AmmoBox->GetActorLocation();
+    Entry.Cell = Grid.GetCellCoord(Entry.Location);
+    Entry.bInUse = true;
+
+    Grid.Add(Slot, Entry.Cell);
+    SlotByBox.Add(AmmoBox, Slot);
+
+    if (UBotInfluenceMapSubsystem* InfluenceMap = UWorld::GetSubsystem<UBotInfluenceMapSubsystem>(GetWorld()))
+    {
+        InfluenceMap->AddAmmo(Entry.Location, 1.f);
+    }
+
+    UE_LOG(LogBotArena, Verbose, TEXT("%s: Registered in ammo registry, %d boxes registered"), *GetNameSafe(AmmoBox), SlotByBox.Num());
+}
+
+void UBotAmmoRegistrySubsystem::UnregisterAmmoBox(AAmmoBox* AmmoBox)
+{
+    int32 Slot = INDEX_NONE;
+    if (!SlotByBox.RemoveAndCopyValue(AmmoBox, Slot))
+    {
+        return;
+    }
+
+    ClearReservation(Slot);
+
+    FAmmoBoxEntry& Entry = Entries[Slot];
+    Grid.Remove(Slot, Entry.Cell);
+
+    if (UBotInfluenceMapSubsystem* InfluenceMap = UWorld::GetSubsystem<UBotInfluenceMapSubsystem>(GetWorld()))
+    {
+        InfluenceMap->AddAmmo(Entry.Location, -1.f);
+    }
+    Entry = FAmmoBoxEntry();
+    FreeSlots.Add(Slot);
+
+    UE_LOG(LogBotArena, Verbose, TEXT("%s: Unregistered from ammo registry, %d boxes registered"), *GetNameSafe(AmmoBox), SlotByBox.Num());
+}
+
+AAmmoBox* UBotAmmoRegistrySubsystem::FindNearestAvailable(const AActor* Bot, float Radius) const
+{
+    if (!Bot)
+    {
+        return nullptr;
+    }
+
+    const FVector Origin = Bot->GetActorLocation();
+    const float RadiusSquared = FMath::Square(Radius);
+
+    AAmmoBox* NearestBox = nullptr;
+    float NearestDistSquared = RadiusSquared;
+
+    Grid.ForEachInRadius(Origin, Radius, [&](int32 Slot)
+    {
+        const FAmmoBoxEntry& Entry = Entries[Slot];
+        AAmmoBox* AmmoBox = Entry.AmmoBox.Get();
+        if (!AmmoBox || IsReservedByOther(Entry, Bot))
+        {
+            return;
+        }
+
+        const float DistSquared = FVector::DistSquared(Origin, Entry.Location);
+        if (DistSquared <= NearestDistSquared)
+        {
+            NearestDistSquared = DistSquared;
+            NearestBox = AmmoBox;
+        }
+    });
+
+    return NearestBox;
+}
+
+bool UBotAmmoRegistrySubsystem::Reserve(AAmmoBox* AmmoBox, const AActor* Bot)
+{
+    const int32* Slot = SlotByBox.Find(AmmoBox);
+    if (!Slot || !Bot)
+    {
+        return false;
+    }
+
+    FAmmoBoxEntry& Entry = Entries[*Slot];
+    if (IsReservedByOther(Entry, Bot))
+    {
+        return false;
+    }
+
+    // A bot only heads to one box at a time
+    const int32* PreviousSlot = ReservationByBot.Find(Bot);
+    if (PreviousSlot && *PreviousSlot != *Slot)
+    {
+        ClearReservation(*PreviousSlot);
+    }
+
+    // Drop the expired reservation of another bot before taking over, destroyed holders included
+    if (Entry.ReservationKey && Entry.ReservationKey != Bot)
+    {
+        ClearReservation(*Slot);
+    }
+
+    Entry.ReservedBy = Bot;
+    Entry.ReservationKey = Bot;
+    Entry.ReservationTime = GetWorld()->GetTimeSeconds();
+    ReservationByBot.Add(Bot, *Slot);
+
+    return true;
+}
+
+void UBotAmmoRegistrySubsystem::ReleaseReservation(const AActor* Bot)
+{
+    if (const int32* Slot = ReservationByBot.Find(Bot))
+    {
+        ClearReservation(*Slot);
+    }
+}
+
+AAmmoBox* UBotAmmoRegistrySubsystem::GetReservedAmmoBox(const AActor* Bot) const
+{
+    const int32* Slot = ReservationByBot.Find(Bot);
+    return Slot ? Entries[*Slot].AmmoBox.Get() : nullptr;
+}
+
+bool UBotAmmoRegistrySubsystem::IsReservedByOther(const FAmmoBoxEntry& Entry, const AActor* Bot) const
+{
+    const AActor* ReservedBy = Entry.ReservedBy.Get();
+    if (!ReservedBy || ReservedBy == Bot)
+    {
+        return false;
+    }
+
+    const float Timeout = CVarBotAmmoReservationTimeout.GetValueOnGameThread();
+    return GetWorld()->GetTimeSeconds() - Entry.ReservationTime < Timeout;
+}
+
+void UBotAmmoRegistrySubsystem::ClearReservation(int32 Slot)
+{
+    FAmmoBoxEntry& Entry = Entries[Slot];
+
+    // The key is only compared, so it works for destroyed holders too. Leave it if it moved on to another box
+    const int32* HolderSlot = Entry.ReservationKey ? ReservationByBot.Find(Entry.ReservationKey) : nullptr;
+    if (HolderSlot && *HolderSlot == Slot)
+    {
+        ReservationByBot.Remove(Entry.ReservationKey);
+    }
+
+    Entry.ReservedBy.Reset();
+    Entry.ReservationKey = nullptr;
+    Entry.ReservationTime = 0.f;
+}
@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/BotBrainSchedulerSubsystem.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarBotBrainsNumBuckets(
+    TEXT("BotArena.Brains.NumBuckets"),
+    4,
+    TEXT("Number of buckets the behavior trees of the bots are spread over, one bucket updates per frame. 1 updates every brain every frame. Read when the world starts."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotBrainsPromotionTime(
+    TEXT("BotArena.Brains.PromotionTime"),
+    3.0f,
+    TEXT("Seconds a bot's behavior tree keeps updating every frame after it sees its target or takes damage"),
+    ECVF_Default);
+
+void UBotBrainSchedulerSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    BucketSizes.Init(0, FMath::Max(CVarBotBrainsNumBuckets.GetValueOnGameThread(), 1));
+}
+
+void UBotBrainSchedulerSubsystem::Deinitialize()
+{
+    BucketSizes.Empty();
+
+    Super::Deinitialize();
+}
+
+bool UBotBrainSchedulerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+float UBotBrainSchedulerSubsystem::GetPromotionTime()
+{
+    return CVarBotBrainsPromotionTime.GetValueOnGameThread();
+}
+
+int32 UBotBrainSchedulerSubsystem::RegisterBrain()
+{
+    int32 Bucket = 0;
+    for (int32 Index = 1; Index < BucketSizes.Num(); Index++)
+    {
+        if (BucketSizes[Index] < BucketSizes[Bucket])
+        {
+            Bucket = Index;
+        }
+    }
+
+    BucketSizes[Bucket]++;
+    return Bucket;
+}
+
+void UBotBrainSchedulerSubsystem::UnregisterBrain(int32 Bucket)
+{
+    if (BucketSizes.IsValidIndex(Bucket))
+    {
+        BucketSizes[Bucket] = FMath::Max(BucketSizes[Bucket] - 1, 0);
+    }
+}
+
+bool UBotBrainSchedulerSubsystem::IsBucketDue(int32 Bucket, int32 Stride) const
+{
+    const uint64 NumBuckets = BucketSizes.Num();
+    if (!BucketSizes.IsValidIndex(Bucket))
+    {
+        return true;
+    }
+
+    if (int32(GFrameCounter % NumBuckets) != Bucket)
+    {
+        return false;
+    }
+
+    // Strided brains of a bucket skip turns, offset by bucket so not all of them wait on the same turns
+    return Stride <= 1 || int32((GFrameCounter / NumBuckets) % uint64(Stride)) == Bucket % Stride;
+}
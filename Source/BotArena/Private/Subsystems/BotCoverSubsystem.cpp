@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/BotCoverSubsystem.h"
+#include "Subsystems/BotInfluenceMapSubsystem.h"
+#include "Environment/BotCoverData.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/PackageName.h"
+#include "LogBotArena.h"
+
+static TAutoConsoleVariable<float> CVarBotCoverSearchRadius(
+    TEXT("BotArena.Cover.SearchRadius"),
+    1500.f,
+    TEXT("Cover points further than this from a retreating bot are ignored"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotCoverThreatWeight(
+    TEXT("BotArena.Cover.ThreatWeight"),
+    0.5f,
+    TEXT("How much the threat of the influence map at a cover point lowers its score"),
+    ECVF_Default);
+
+void UBotCoverSubsystem::Deinitialize()
+{
+    CoverData = nullptr;
+
+    Super::Deinitialize();
+}
+
+bool UBotCoverSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UBotCoverSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    // PIE worlds live in a prefixed copy of the map package
+    const FString MapName = UWorld::RemovePIEPrefix(InWorld.GetOutermost()->GetName());
+    const FString PackageName = UBotCoverData::GetPackageNameForMap(MapName);
+
+    if (FPackageName::DoesPackageExist(PackageName))
+    {
+        const FString ObjectPath = PackageName + TEXT(".") + FPackageName::GetShortName(PackageName);
+        CoverData = LoadObject<UBotCoverData>(nullptr, *ObjectPath);
+    }
+
+    if (CoverData)
+    {
+        UE_LOG(LogBotArena, Log, TEXT("Loaded cover %s with %d points"), *PackageName, CoverData->GetNumPoints());
+    }
+    else
+    {
+        UE_LOG(LogBotArena, Log, TEXT("No cover baked for %s, bots will retreat without a destination"), *MapName);
+    }
+}
+
+bool UBotCoverSubsystem::FindCoverFrom(const FVector& BotLocation, const FVector& ThreatLocation, ETeam Team, FVector& OutLocation) const
+{
+    if (!CoverData)
+    {
+        return false;
+    }
+
+    const UBotInfluenceMapSubsystem* InfluenceMap = UWorld::GetSubsystem<UBotInfluenceMapSubsystem>(GetWorld());
+    const float ThreatWeight = CVarBotCoverThreatWeight.GetValueOnGameThread();
+
+    const auto GetPenalty = [InfluenceMap, ThreatWeight, Team](const FVector& Location)
+    {
+        return InfluenceMap ? ThreatWeight * InfluenceMap->GetThreat(Team, Location) : 0.f;
+    };
+
+    FBotCoverPoint Point;
+    if (!CoverData->FindBestCover(BotLocation, ThreatLocation, CVarBotCoverSearchRadius.GetValueOnGameThread(), GetPenalty, Point))
+    {
+        return false;
+    }
+
+    OutLocation = FVector(Point.Location);
+    return true;
+}
@@ -0,0 +1,296 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/BotDormancySubsystem.h"
+#include "Subsystems/BotRegistrySubsystem.h"
+#include "Components/BotPerceptionComponent.h"
+#include "Components/BotHealthComponent.h"
+#include "Components/BotWeaponComponent.h"
+#include "Components/BotMovementComponent.h"
+#include "Controllers/BotController.h"
+#include "Characters/AICharacter.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "BrainComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "LogBotArena.h"
+
+static TAutoConsoleVariable<bool> CVarBotDormancyEnabled(
+    TEXT("BotArena.Dormancy.Enabled"),
+    true,
+    TEXT("Put idle bots to sleep until an event wakes them: 0=off, 1=on. Turning it off wakes every dormant bot"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotDormancyDelay(
+    TEXT("BotArena.Dormancy.Delay"),
+    5.0f,
+    TEXT("Seconds a bot has to stay idle before it falls asleep"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotDormancyCheckInterval(
+    TEXT("BotArena.Dormancy.CheckInterval"),
+    0.5f,
+    TEXT("Seconds between two checks of which awake bots are idle"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotDormancyWakeRadius(
+    TEXT("BotArena.Dormancy.WakeRadius"),
+    3000.0f,
+    TEXT("Bots with an enemy closer than this stay awake, and enemies moving into this range wake them up"),
+    ECVF_Default);
+
+void UBotDormancySubsystem::Deinitialize()
+{
+    DormantBySlot.Empty();
+    IdleTimeBySlot.Empty();
+    BotBySlot.Empty();
+    NearbyBots.Empty();
+    NumDormant = 0;
+
+    Super::Deinitialize();
+}
+
+bool UBotDormancySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UBotDormancySubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    UBotRegistrySubsystem* Registry = UWorld::GetSubsystem<UBotRegistrySubsystem>(GetWorld());
+    if (!Registry)
+    {
+        return;
+    }
+
+    Registry->RefreshBots();
+    RefreshSlots(*Registry);
+
+    if (!IsEnabled())
+    {
+        for (int32 Slot = 0; Slot < DormantBySlot.Num() && NumDormant > 0; Slot++)
+        {
+            AAICharacter* Bot = BotBySlot[Slot].Get();
+            if (Bot && DormantBySlot[Slot])
+            {
+                SetDormant(*Bot, Slot, false);
+            }
+        }
+        return;
+    }
+
+    // Bots that crossed a cell border are the only ones that can have come close to a sleeper
+    if (NumDormant > 0)
+    {
+        for (const int32 Slot : Registry->GetCellChangedSlots())
+        {
+            WakeEnemiesAround(*Registry, Slot);
+        }
+    }
+
+    TimeSinceIdleCheck += DeltaTime;
+    if (TimeSinceIdleCheck < CVarBotDormancyCheckInterval.GetValueOnGameThread())
+    {
+        return;
+    }
+
+    const float Elapsed = TimeSinceIdleCheck;
+    const float Delay = FMath::Max(CVarBotDormancyDelay.GetValueOnGameThread(), 0.f);
+    TimeSinceIdleCheck = 0.f;
+
+    for (int32 Slot = 0; Slot < DormantBySlot.Num(); Slot++)
+    {
+        AAICharacter* Bot = Registry->GetBotAtSlot(Slot);
+        if (!Bot || DormantBySlot[Slot])
+        {
+            continue;
+        }
+
+        if (!IsIdle(*Registry, *Bot))
+        {
+            IdleTimeBySlot[Slot] = 0.f;
+            continue;
+        }
+
+        IdleTimeBySlot[Slot] += Elapsed;
+        if (IdleTimeBySlot[Slot] >= Delay)
+        {
+            SetDormant(*Bot, Slot, true);
+        }
+    }
+}
+
+TStatId UBotDormancySubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UBotDormancySubsystem, STATGROUP_Tickables);
+}
+
+bool UBotDormancySubsystem::IsEnabled()
+{
+    return CVarBotDormancyEnabled.GetValueOnGameThread();
+}
+
+bool UBotDormancySubsystem::IsDormant(const AActor* Bot) const
+{
+    if (NumDormant == 0)
+    {
+        return false;
+    }
+
+    const UBotRegistrySubsystem* Registry = UWorld::GetSubsystem<UBotRegistrySubsystem>(GetWorld());
+    const int32 Slot = Registry ? Registry->FindSlot(Bot) : INDEX_NONE;
+    return DormantBySlot.IsValidIndex(Slot) && DormantBySlot[Slot] && BotBySlot[Slot].Get() == Bot;
+}
+
+void UBotDormancySubsystem::WakeUp(const AActor* Bot)
+{
+    const UBotRegistrySubsystem* Registry = UWorld::GetSubsystem<UBotRegistrySubsystem>(GetWorld());
+    const int32 Slot = Registry ? Registry->FindSlot(Bot) : INDEX_NONE;
+    AAICharacter* SlotBot = BotBySlot.IsValidIndex(Slot) ? BotBySlot[Slot].Get() : nullptr;
+    if (!SlotBot || SlotBot != Bot)
+    {
+        return;
+    }
+
+    IdleTimeBySlot[Slot] = 0.f;
+
+    if (DormantBySlot[Slot])
+    {
+        SetDormant(*SlotBot, Slot, false);
+    }
+}
+
+bool UBotDormancySubsystem::IsIdle(const UBotRegistrySubsystem& Registry, AAICharacter& Bot)
+{
+    if (!Bot.IsAlive())
+    {
+        return false;
+    }
+
+    const ABotController* BotController = Cast<ABotController>(Bot.GetController());
+    const UBotPerceptionComponent* Perception = BotController ? BotController->GetBotPerceptionComponent() : nullptr;
+    if (!Perception || Perception->GetThreatTable().Num() > 0 || Perception->GetSelectedTarget())
+    {
+        return false;
+    }
+
+    const UBotWeaponComponent* Weapon = Bot.GetWeaponComponent();
+    if (Weapon && Weapon->LowOnAmmo())
+    {
+        return false;
+    }
+
+    const UBotHealthComponent* Health = Bot.GetHealthComponent();
+    if (Health && Health->GetHealth() < Health->GetMaxHealth())
+    {
+        return false;
+    }
+
+    // A falling bot would freeze in mid air
+    const UCharacterMovementComponent* CharacterMovement = Bot.GetCharacterMovement();
+    if (!CharacterMovement || !CharacterMovement->IsMovingOnGround())
+    {
+        return false;
+    }
+
+    return Registry.GetEnemiesInRadius(&Bot, CVarBotDormancyWakeRadius.GetValueOnGameThread(), NearbyBots) == 0;
+}
+
+void UBotDormancySubsystem::SetDormant(AAICharacter& Bot, int32 Slot, bool bDormant)
+{
+    if (DormantBySlot[Slot] == bDormant)
+    {
+        return;
+    }
+
+    DormantBySlot[Slot] = bDormant;
+    IdleTimeBySlot[Slot] = 0.f;
+    NumDormant += bDormant ? 1 : -1;
+
+    if (ABotController* BotController = Cast<ABotController>(Bot.GetController()))
+    {
+        if (UBotPerceptionComponent* Perception = BotController->GetBotPerceptionComponent())
+        {
+            Perception->SetDormant(bDormant);
+        }
+
+        // Pause the move instead of stopping it, the behavior tree task waiting on it carries on after the wake up
+        const FAIRequestID MoveRequestID = BotController->GetCurrentMoveRequestID();
+        if (bDormant)
+        {
+            BotController->PauseMove(MoveRequestID);
+        }
+        else
+        {
+            BotController->ResumeMove(MoveRequestID);
+        }
+
+        // The tree turns its tick back off by itself if it has nothing to do after resuming
+        if (UBrainComponent* Brain = BotController->GetBrainComponent())
+        {
+            if (bDormant)
+            {
+                Brain->PauseLogic(TEXT("Dormant"));
+            }
+            else
+            {
+                Brain->ResumeLogic(TEXT("Dormant"));
+            }
+
+            Brain->SetComponentTickEnabled(!bDormant);
+        }
+    }
+
+    if (UBotMovementComponent* Movement = Bot.GetBotMovementComponent())
+    {
+        Movement->SetDormant(bDormant);
+    }
+
+    if (UCharacterMovementComponent* CharacterMovement = Bot.GetCharacterMovement())
+    {
+        CharacterMovement->SetComponentTickEnabled(!bDormant);
+    }
+
+    UE_LOG(LogBotArena, Verbose, TEXT("%s: %s"), *GetNameSafe(&Bot), bDormant ? TEXT("Falling asleep") : TEXT("Waking up"));
+}
+
+void UBotDormancySubsystem::WakeEnemiesAround(const UBotRegistrySubsystem& Registry, int32 Slot)
+{
+    AAICharacter* Bot = Registry.GetBotAtSlot(Slot);
+    if (!Bot || !Bot->IsAlive())
+    {
+        return;
+    }
+
+    Registry.GetEnemiesInRadius(Bot, CVarBotDormancyWakeRadius.GetValueOnGameThread(), NearbyBots);
+
+    for (AAICharacter* Enemy : NearbyBots)
+    {
+        const int32 EnemySlot = Registry.FindSlot(Enemy);
+        if (DormantBySlot.IsValidIndex(EnemySlot) && DormantBySlot[EnemySlot])
+        {
+            SetDormant(*Enemy, EnemySlot, false);
+        }
+    }
+}
+
+void UBotDormancySubsystem::RefreshSlots(const UBotRegistrySubsystem& Registry)
+{
+    const int32 NumSlots = Registry.GetNumSlots();
+    DormantBySlot.SetNum(NumSlots, EAllowShrinking::No);
+    IdleTimeBySlot.SetNum(NumSlots, EAllowShrinking::No);
+    BotBySlot.SetNum(NumSlots, EAllowShrinking::No);
+
+    // A recycled or freed slot starts over awake
+    for (int32 Slot = 0; Slot < NumSlots; Slot++)
+    {
+        AAICharacter* Bot = Registry.GetBotAtSlot(Slot);
+        if (BotBySlot[Slot].Get() != Bot || (!Bot && DormantBySlot[Slot]))
+        {
+            NumDormant -= DormantBySlot[Slot] ? 1 : 0;
+            DormantBySlot[Slot] = false;
+            IdleTimeBySlot[Slot] = 0.f;
+            BotBySlot[Slot] = Bot;
+        }
+    }
+}
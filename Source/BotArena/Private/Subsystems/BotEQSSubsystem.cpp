@@ -0,0 +1,292 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/BotEQSSubsystem.h"
+#include "NavigationData.h"
+#include "NavFilters/NavigationQueryFilter.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "LogBotArena.h"
+
+static TAutoConsoleVariable<float> CVarBotEQSProjectionCellSize(
+    TEXT("BotArena.EQS.ProjectionCellSize"),
+    25.0f,
+    TEXT("Points closer than this (world units, per axis) share a cached nav projection"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotEQSProjectionLifetime(
+    TEXT("BotArena.EQS.ProjectionLifetime"),
+    2.0f,
+    TEXT("Seconds a cached nav projection is reused before it gets projected again. 0 disables the cache"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<bool> CVarBotEQSResultCache(
+    TEXT("BotArena.EQS.ResultCache"),
+    true,
+    TEXT("Share the results of the bot generators and contexts between team mates standing in the same cell: 0=off, 1=on"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotEQSResultCacheCellSize(
+    TEXT("BotArena.EQS.ResultCacheCellSize"),
+    150.0f,
+    TEXT("Bots closer than this (world units, per axis) share their cached EQS context results"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotEQSPointsCacheCellSize(
+    TEXT("BotArena.EQS.PointsCacheCellSize"),
+    25.0f,
+    TEXT("Queries made closer than this (world units, per axis) share their generated points, which are centered on the cell"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotEQSResultCacheLifetime(
+    TEXT("BotArena.EQS.ResultCacheLifetime"),
+    0.5f,
+    TEXT("Seconds a cached EQS result is shared before the query runs again"),
+    ECVF_Default);
+
+void UBotEQSSubsystem::Deinitialize()
+{
+    RingTemplates.Reset();
+    ProjectionCache.Reset();
+    CachedPoints.Reset();
+    CachedActors.Reset();
+
+    Super::Deinitialize();
+}
+
+bool UBotEQSSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UBotEQSSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    // Every now and then drop the projections and results that are too old to be used
+    if (GFrameCounter % 60 != 0)
+    {
+        return;
+    }
+
+    const float Now = GetWorld()->GetTimeSeconds();
+    const float Lifetime = CVarBotEQSProjectionLifetime.GetValueOnGameThread();
+    for (auto It = ProjectionCache.CreateIterator(); It; ++It)
+    {
+        if (Now - It.Value().Time > Lifetime)
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    for (auto It = CachedPoints.CreateIterator(); It; ++It)
+    {
+        if (!IsResultFresh(It.Value().Time))
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    for (auto It = CachedActors.CreateIterator(); It; ++It)
+    {
+        if (!IsResultFresh(It.Value().Time))
+        {
+            It.RemoveCurrent();
+        }
+    }
+}
+
+TStatId UBotEQSSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UBotEQSSubsystem, STATGROUP_Tickables);
+}
+
+const FBotRingTemplate& UBotEQSSubsystem::GetRingTemplate(float AngleStep, float DegreesGap, float PointsDistance, float MaxRange)
+{
+    const FRingKey Key{ AngleStep, DegreesGap, PointsDistance, MaxRange };
+    if (const FBotRingTemplate* Template = RingTemplates.Find(Key))
+    {
+        return *Template;
+    }
+
+    FBotRingTemplate& Template = RingTemplates.Add(Key);
+
+    // Same stepping as the generator always used, so the points don't change
+    if (AngleStep > 0.f)
+    {
+        for (float Angle = DegreesGap; Angle < 360 - DegreesGap; Angle += AngleStep)
+        {
+            float Sin, Cos;
+            FMath::SinCos(&Sin, &Cos, FMath::DegreesToRadians(Angle));
+            Template.Directions.Add(FVector2f(Cos, Sin));
+        }
+    }
+
+    if (PointsDistance > 0.f)
+    {
+        for (float Distance = PointsDistance; Distance < MaxRange; Distance += PointsDistance)
+        {
+            Template.Distances.Add(Distance);
+        }
+    }
+
+    UE_LOG(LogBotArena, Verbose, TEXT("Built ring template with %d points"), Template.GetNumPoints());
+
+    return Template;
+}
+
+void UBotEQSSubsystem::ProjectPoints(const ANavigationData& NavData, const UObject& Querier, const FEnvTraceData& TraceData, TArray<FNavLocation>& InOutPoints)
+{
+    FSharedConstNavQueryFilter NavigationFilter = UNavigationQueryFilter::GetQueryFilter(NavData, &Querier, TraceData.NavigationFilter);
+
+    const FVector VerticalOffset(0.f, 0.f, (TraceData.ProjectUp - TraceData.ProjectDown) / 2);
+    const FVector ProjectionExtent(TraceData.ExtentX, TraceData.ExtentX, (TraceData.ProjectDown + TraceData.ProjectUp) / 2);
+
+    uint32 SettingsHash = GetTypeHash(&NavData);
+    SettingsHash = HashCombine(SettingsHash, GetTypeHash(NavigationFilter.Get()));
+    SettingsHash = HashCombine(SettingsHash, GetTypeHash(ProjectionExtent));
+    SettingsHash = HashCombine(SettingsHash, GetTypeHash(VerticalOffset));
+
+    const float CellSize = FMath::Max(CVarBotEQSProjectionCellSize.GetValueOnGameThread(), 1.f);
+    const float Lifetime = CVarBotEQSProjectionLifetime.GetValueOnGameThread();
+    const float Now = GetWorld()->GetTimeSeconds();
+
+    ProjectionWorkload.Reset();
+    PointKeys.SetNumUninitialized(InOutPoints.Num(), EAllowShrinking::No);
+    WorkloadIndexByPoint.SetNumUninitialized(InOutPoints.Num(), EAllowShrinking::No);
+
+    // Points of the same cell are projected once, whether the cell is already cached or not
+    TMap<FProjectionKey, int32, TInlineSetAllocator<64>> WorkloadIndexByKey;
+
+    for (int32 Index = 0; Index < InOutPoints.Num(); Index++)
+    {
+        const FVector& Location = InOutPoints[Index].Location;
+        FProjectionKey& Key = PointKeys[Index];
+        Key.Cell = FIntVector(
+            FMath::FloorToInt32(Location.X / CellSize),
+            FMath::FloorToInt32(Location.Y / CellSize),
+            FMath::FloorToInt32(Location.Z / CellSize));
+        Key.SettingsHash = SettingsHash;
+
+        WorkloadIndexByPoint[Index] = INDEX_NONE;
+
+        const FProjectionEntry* Cached = ProjectionCache.Find(Key);
+        if (Cached && Lifetime > 0.f && Now - Cached->Time <= Lifetime)
+        {
+            continue;
+        }
+
+        if (const int32* WorkloadIndex = WorkloadIndexByKey.Find(Key))
+        {
+            WorkloadIndexByPoint[Index] = *WorkloadIndex;
+            continue;
+        }
+
+        const int32 WorkloadIndex = ProjectionWorkload.Add(FNavigationProjectionWork(Location + VerticalOffset));
+        WorkloadIndexByKey.Add(Key, WorkloadIndex);
+        WorkloadIndexByPoint[Index] = WorkloadIndex;
+    }
+
+    if (ProjectionWorkload.Num() > 0)
+    {
+        NavData.BatchProjectPoints(ProjectionWorkload, ProjectionExtent, NavigationFilter, &Querier);
+    }
+
+    // Walk backwards so failed points can be removed in place
+    for (int32 Index = InOutPoints.Num() - 1; Index >= 0; Index--)
+    {
+        const FProjectionKey& Key = PointKeys[Index];
+        const int32 WorkloadIndex = WorkloadIndexByPoint[Index];
+
+        FProjectionEntry* Entry = nullptr;
+        if (WorkloadIndex != INDEX_NONE)
+        {
+            const FNavigationProjectionWork& Work = ProjectionWorkload[WorkloadIndex];
+
+            Entry = &ProjectionCache.FindOrAdd(Key);
+            Entry->bResult = Work.bResult;
+            Entry->Location = Work.OutLocation;
+            Entry->Time = Now;
+        }
+        else
+        {
+            Entry = ProjectionCache.Find(Key);
+        }
+
+        if (Entry && Entry->bResult)
+        {
+            InOutPoints[Index] = Entry->Location;
+            InOutPoints[Index].Location.Z += TraceData.PostProjectionVerticalOffset;
+        }
+        else
+        {
+            InOutPoints.RemoveAt(Index, 1, EAllowShrinking::No);
+        }
+    }
+}
+
+bool UBotEQSSubsystem::IsResultCacheEnabled()
+{
+    return CVarBotEQSResultCache.GetValueOnGameThread();
+}
+
+float UBotEQSSubsystem::GetResultCacheCellSize()
+{
+    return FMath::Max(CVarBotEQSResultCacheCellSize.GetValueOnGameThread(), 1.f);
+}
+
+float UBotEQSSubsystem::GetPointsCacheCellSize()
+{
+    return FMath::Max(CVarBotEQSPointsCacheCellSize.GetValueOnGameThread(), 1.f);
+}
+
+FBotEQSResultKey UBotEQSSubsystem::MakeResultKey(const UObject* Template, const FVector& QuerierLocation, uint8 Team, uint32 ContextHash)
+{
+    return MakeResultKey(Template, QuerierLocation, Team, ContextHash, GetResultCacheCellSize());
+}
+
+FBotEQSResultKey UBotEQSSubsystem::MakeResultKey(const UObject* Template, const FVector& QuerierLocation, uint8 Team, uint32 ContextHash, float CellSize)
+{
+    FBotEQSResultKey Key;
+    Key.Template = Template;
+    Key.Cell = FIntVector(
+        FMath::FloorToInt32(QuerierLocation.X / CellSize),
+        FMath::FloorToInt32(QuerierLocation.Y / CellSize),
+        FMath::FloorToInt32(QuerierLocation.Z / CellSize));
+    Key.Team = Team;
+    Key.ContextHash = ContextHash;
+    return Key;
+}
+
+bool UBotEQSSubsystem::IsResultFresh(float ResultTime) const
+{
+    return GetWorld()->GetTimeSeconds() - ResultTime <= CVarBotEQSResultCacheLifetime.GetValueOnGameThread();
+}
+
+const TArray<FNavLocation>* UBotEQSSubsystem::FindCachedPoints(const FBotEQSResultKey& Key) const
+{
+    const FCachedResult<FNavLocation>* Result = CachedPoints.Find(Key);
+    return Result && IsResultFresh(Result->Time) ? &Result->Items : nullptr;
+}
+
+const TArray<FNavLocation>& UBotEQSSubsystem::StoreCachedPoints(const FBotEQSResultKey& Key, const TArray<FNavLocation>& Points)
+{
+    FCachedResult<FNavLocation>& Result = CachedPoints.FindOrAdd(Key);
+    Result.Items = Points;
+    Result.Time = GetWorld()->GetTimeSeconds();
+    return Result.Items;
+}
+
+const TArray<TWeakObjectPtr<AActor>>* UBotEQSSubsystem::FindCachedActors(const FBotEQSResultKey& Key) const
+{
+    const FCachedResult<TWeakObjectPtr<AActor>>* Result = CachedActors.Find(Key);
+    return Result && IsResultFresh(Result->Time) ? &Result->Items : nullptr;
+}
+
+const TArray<TWeakObjectPtr<AActor>>& UBotEQSSubsystem::StoreCachedActors(const FBotEQSResultKey& Key, const TArray<AActor*>& Actors)
+{
+    FCachedResult<TWeakObjectPtr<AActor>>& Result = CachedActors.FindOrAdd(Key);
+    Result.Items.Reset();
+    Result.Items.Append(Actors);
+    Result.Time = GetWorld()->GetTimeSeconds();
+    return Result.Items;
+}
@@ -0,0 +1,295 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/BotFrameBudgetSubsystem.h"
+#include "Subsystems/BotSignificanceSubsystem.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+
+DECLARE_CYCLE_STAT(TEXT("Bot Perception"), STAT_BotPerception, STATGROUP_BotArena);
+DECLARE_CYCLE_STAT(TEXT("Bot Behavior"), STAT_BotBehavior, STATGROUP_BotArena);
+DECLARE_CYCLE_STAT(TEXT("Bot EQS"), STAT_BotEQS, STATGROUP_BotArena);
+DECLARE_CYCLE_STAT(TEXT("Bot Weapon"), STAT_BotWeapon, STATGROUP_BotArena);
+DECLARE_CYCLE_STAT(TEXT("Bot Movement"), STAT_BotMovement, STATGROUP_BotArena);
+
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Perception Pressure"), STAT_BotPerceptionPressure, STATGROUP_BotArena);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Behavior Pressure"), STAT_BotBehaviorPressure, STATGROUP_BotArena);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("EQS Pressure"), STAT_BotEQSPressure, STATGROUP_BotArena);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Frame Pressure"), STAT_BotFramePressure, STATGROUP_BotArena);
+
+static TAutoConsoleVariable<bool> CVarBotBudgetEnabled(
+    TEXT("BotArena.Budget.Enabled"),
+    true,
+    TEXT("Cut back the least significant bots when the bot work goes over its budget: 0=off, 1=on"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotBudgetFrameMs(
+    TEXT("BotArena.Budget.FrameMs"),
+    6.0f,
+    TEXT("Milliseconds per frame for all the bot work together, 0 for no limit"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotBudgetPerceptionMs(
+    TEXT("BotArena.Budget.PerceptionMs"),
+    2.0f,
+    TEXT("Milliseconds per frame for bot perception and target selection, 0 for no limit"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotBudgetBehaviorMs(
+    TEXT("BotArena.Budget.BehaviorMs"),
+    1.5f,
+    TEXT("Milliseconds per frame for the bot behavior trees, 0 for no limit"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotBudgetEQSMs(
+    TEXT("BotArena.Budget.EQSMs"),
+    1.0f,
+    TEXT("Milliseconds per frame for the bot EQS generators and sidestep searches, 0 for no limit"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotBudgetWeaponMs(
+    TEXT("BotArena.Budget.WeaponMs"),
+    0.5f,
+    TEXT("Milliseconds per frame for firing bot weapons, 0 for no limit"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotBudgetMovementMs(
+    TEXT("BotArena.Budget.MovementMs"),
+    1.0f,
+    TEXT("Milliseconds per frame for the bot movement updates, 0 for no limit"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotBudgetHeadroom(
+    TEXT("BotArena.Budget.Headroom"),
+    0.75f,
+    TEXT("Fraction of its budget a domain has to fall under before its bots are scaled back up"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotBudgetRaiseRate(
+    TEXT("BotArena.Budget.RaiseRate"),
+    1.0f,
+    TEXT("Pressure added per second while a domain is over budget, full pressure is 1"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotBudgetLowerRate(
+    TEXT("BotArena.Budget.LowerRate"),
+    0.25f,
+    TEXT("Pressure removed per second while a domain has headroom"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotBudgetMaxCutoff(
+    TEXT("BotArena.Budget.MaxCutoff"),
+    0.75f,
+    TEXT("Significance cutoff at full pressure, bots at or above it are never cut back"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotBudgetMinTraceScale(
+    TEXT("BotArena.Budget.MinTraceScale"),
+    0.25f,
+    TEXT("Factor applied to the sight trace budget at full perception pressure"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarBotBudgetMaxBrainStride(
+    TEXT("BotArena.Budget.MaxBrainStride"),
+    4,
+    TEXT("Turns of its bucket a cut back behavior tree waits between updates at full behavior pressure"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotBudgetMaxEQSSpacing(
+    TEXT("BotArena.Budget.MaxEQSSpacing"),
+    2.0f,
+    TEXT("Factor applied to the point spacing of the EQS rings of cut back bots at full EQS pressure"),
+    ECVF_Default);
+
+// Ramps a pressure up while the load is over 1 and down while it is under the headroom
+static float UpdatePressure(float Pressure, float Load, float Headroom, float RaiseStep, float LowerStep)
+{
+    if (Load > 1.f)
+    {
+        return FMath::Min(Pressure + RaiseStep, 1.f);
+    }
+
+    if (Load < Headroom)
+    {
+        return FMath::Max(Pressure - LowerStep, 0.f);
+    }
+
+    return Pressure;
+}
+
+static TStatId GetDomainStatId(EBotBudgetDomain Domain)
+{
+    switch (Domain)
+    {
+    case EBotBudgetDomain::Perception:
+        return GET_STATID(STAT_BotPerception);
+    case EBotBudgetDomain::Behavior:
+        return GET_STATID(STAT_BotBehavior);
+    case EBotBudgetDomain::EQS:
+        return GET_STATID(STAT_BotEQS);
+    case EBotBudgetDomain::Weapon:
+        return GET_STATID(STAT_BotWeapon);
+    default:
+        return GET_STATID(STAT_BotMovement);
+    }
+}
+
+void UBotFrameBudgetSubsystem::Deinitialize()
+{
+    for (int32 Index = 0; Index < NumDomains; Index++)
+    {
+        FrameCycles[Index] = 0;
+        CostMs[Index] = 0.f;
+        Pressure[Index] = 0.f;
+    }
+
+    FramePressure = 0.f;
+
+    Super::Deinitialize();
+}
+
+bool UBotFrameBudgetSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UBotFrameBudgetSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    // Smooth the cost over a few frames, a single hitch shouldn't cut anything back
+    constexpr float CostSmoothing = 0.1f;
+
+    const float BudgetMs[NumDomains] = {
+        CVarBotBudgetPerceptionMs.GetValueOnGameThread(),
+        CVarBotBudgetBehaviorMs.GetValueOnGameThread(),
+        CVarBotBudgetEQSMs.GetValueOnGameThread(),
+        CVarBotBudgetWeaponMs.GetValueOnGameThread(),
+        CVarBotBudgetMovementMs.GetValueOnGameThread()
+    };
+
+    const float Headroom = FMath::Clamp(CVarBotBudgetHeadroom.GetValueOnGameThread(), 0.f, 1.f);
+    const float RaiseStep = FMath::Max(CVarBotBudgetRaiseRate.GetValueOnGameThread(), 0.f) * DeltaTime;
+    const float LowerStep = FMath::Max(CVarBotBudgetLowerRate.GetValueOnGameThread(), 0.f) * DeltaTime;
+
+    float TotalMs = 0.f;
+    float Load[NumDomains];
+
+    for (int32 Index = 0; Index < NumDomains; Index++)
+    {
+        const float FrameMs = static_cast<float>(FPlatformTime::ToMilliseconds64(FrameCycles[Index]));
+        FrameCycles[Index] = 0;
+
+        CostMs[Index] = FMath::Lerp(CostMs[Index], FrameMs, CostSmoothing);
+        TotalMs += CostMs[Index];
+
+        Load[Index] = BudgetMs[Index] > 0.f ? CostMs[Index] / BudgetMs[Index] : 0.f;
+        Pressure[Index] = UpdatePressure(Pressure[Index], Load[Index], Headroom, RaiseStep, LowerStep);
+    }
+
+    // Weapon and movement can't be scaled per bot, they press on the whole frame like the total does
+    const float FrameBudgetMs = CVarBotBudgetFrameMs.GetValueOnGameThread();
+    float FrameLoad = FrameBudgetMs > 0.f ? TotalMs / FrameBudgetMs : 0.f;
+    FrameLoad = FMath::Max3(FrameLoad, Load[static_cast<int32>(EBotBudgetDomain::Weapon)], Load[static_cast<int32>(EBotBudgetDomain::Movement)]);
+    FramePressure = UpdatePressure(FramePressure, FrameLoad, Headroom, RaiseStep, LowerStep);
+
+    SET_FLOAT_STAT(STAT_BotPerceptionPressure, GetPressure(EBotBudgetDomain::Perception));
+    SET_FLOAT_STAT(STAT_BotBehaviorPressure, GetPressure(EBotBudgetDomain::Behavior));
+    SET_FLOAT_STAT(STAT_BotEQSPressure, GetPressure(EBotBudgetDomain::EQS));
+    SET_FLOAT_STAT(STAT_BotFramePressure, FramePressure);
+}
+
+TStatId UBotFrameBudgetSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UBotFrameBudgetSubsystem, STATGROUP_Tickables);
+}
+
+bool UBotFrameBudgetSubsystem::IsEnabled()
+{
+    return CVarBotBudgetEnabled.GetValueOnGameThread();
+}
+
+float UBotFrameBudgetSubsystem::GetPressure(EBotBudgetDomain Domain) const
+{
+    if (!IsEnabled())
+    {
+        return 0.f;
+    }
+
+    return FMath::Max(Pressure[static_cast<int32>(Domain)], FramePressure);
+}
+
+float UBotFrameBudgetSubsystem::GetSignificanceCutoff(EBotBudgetDomain Domain) const
+{
+    return GetPressure(Domain) * FMath::Clamp(CVarBotBudgetMaxCutoff.GetValueOnGameThread(), 0.f, 1.f);
+}
+
+float UBotFrameBudgetSubsystem::GetTraceBudgetScale() const
+{
+    const float MinTraceScale = FMath::Clamp(CVarBotBudgetMinTraceScale.GetValueOnGameThread(), 0.f, 1.f);
+    return FMath::Lerp(1.f, MinTraceScale, GetPressure(EBotBudgetDomain::Perception));
+}
+
+int32 UBotFrameBudgetSubsystem::GetBrainStride(const AActor* Bot) const
+{
+    if (!IsCutBack(EBotBudgetDomain::Behavior, Bot))
+    {
+        return 1;
+    }
+
+    const int32 MaxStride = FMath::Max(CVarBotBudgetMaxBrainStride.GetValueOnGameThread(), 1);
+    return 1 + FMath::RoundToInt32(GetPressure(EBotBudgetDomain::Behavior) * (MaxStride - 1));
+}
+
+float UBotFrameBudgetSubsystem::GetEQSSpacingScale(const AActor* Bot) const
+{
+    if (!IsCutBack(EBotBudgetDomain::EQS, Bot))
+    {
+        return 1.f;
+    }
+
+    // Steps of a half, the ring templates and result caches are keyed on the spacing
+    const float MaxSpacing = FMath::Max(CVarBotBudgetMaxEQSSpacing.GetValueOnGameThread(), 1.f);
+    return 1.f + FMath::RoundToFloat(GetPressure(EBotBudgetDomain::EQS) * (MaxSpacing - 1.f) * 2.f) * 0.5f;
+}
+
+bool UBotFrameBudgetSubsystem::IsCutBack(EBotBudgetDomain Domain, const AActor* Bot) const
+{
+    const float Cutoff = GetSignificanceCutoff(Domain);
+    if (Cutoff <= 0.f)
+    {
+        return false;
+    }
+
+    const UBotSignificanceSubsystem* Significance = UWorld::GetSubsystem<UBotSignificanceSubsystem>(GetWorld());
+    return Significance && Significance->GetSignificance(Bot) < Cutoff;
+}
+
+FBotBudgetScope::FBotBudgetScope(const UWorld* World, EBotBudgetDomain InDomain)
+    : CycleCounter(GetDomainStatId(InDomain))
+    , Budget(UWorld::GetSubsystem<UBotFrameBudgetSubsystem>(World))
+    , Domain(InDomain)
+    , StartCycles(FPlatformTime::Cycles64())
+{
+    if (Budget)
+    {
+        OuterScope = Budget->ActiveScope;
+        Budget->ActiveScope = this;
+    }
+}
+
+FBotBudgetScope::~FBotBudgetScope()
+{
+    if (!Budget)
+    {
+        return;
+    }
+
+    const uint64 Cycles = FPlatformTime::Cycles64() - StartCycles;
+    Budget->AddCost(Domain, Cycles - FMath::Min(InnerCycles, Cycles));
+    Budget->ActiveScope = OuterScope;
+
+    if (OuterScope)
+    {
+        OuterScope->InnerCycles += Cycles;
+    }
+}
@@ -0,0 +1,153 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/BotGunfireSubsystem.h"
+#include "Subsystems/BotRegistrySubsystem.h"
+#include "Subsystems/BotSignificanceSubsystem.h"
+#include "Subsystems/BotDormancySubsystem.h"
+#include "Components/BotPerceptionComponent.h"
+#include "Controllers/BotController.h"
+#include "Characters/AICharacter.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<float> CVarBotGunfireHearingRadius(
+    TEXT("BotArena.Gunfire.HearingRadius"),
+    2500.f,
+    TEXT("Distance at which bots hear gunfire"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotGunfireCellSize(
+    TEXT("BotArena.Gunfire.CellSize"),
+    1000.f,
+    TEXT("Edge length of the cells shots are bucketed in before delivery"),
+    ECVF_Default);
+
+void UBotGunfireSubsystem::Deinitialize()
+{
+    Cells.Empty();
+    CellIndexByCoord.Empty();
+    Listeners.Empty();
+
+    Super::Deinitialize();
+}
+
+bool UBotGunfireSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UBotGunfireSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    if (Cells.Num() == 0)
+    {
+        return;
+    }
+
+    const float HearingRadius = CVarBotGunfireHearingRadius.GetValueOnGameThread();
+    const float CellSize = FMath::Max(CVarBotGunfireCellSize.GetValueOnGameThread(), 100.f);
+
+    for (const FShotCell& Cell : Cells)
+    {
+        DeliverCell(Cell, HearingRadius, CellSize);
+    }
+
+    Cells.Reset();
+    CellIndexByCoord.Reset();
+}
+
+TStatId UBotGunfireSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UBotGunfireSubsystem, STATGROUP_Tickables);
+}
+
+void UBotGunfireSubsystem::ReportShot(AAICharacter* Shooter, const FVector& Location)
+{
+    if (!Shooter)
+    {
+        return;
+    }
+
+    const float CellSize = FMath::Max(CVarBotGunfireCellSize.GetValueOnGameThread(), 100.f);
+    const FIntPoint Coord(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+
+    int32& CellIndex = CellIndexByCoord.FindOrAdd(Coord, INDEX_NONE);
+    if (CellIndex == INDEX_NONE)
+    {
+        CellIndex = Cells.AddDefaulted();
+        Cells[CellIndex].Coord = Coord;
+    }
+
+    FShotCell& Cell = Cells[CellIndex];
+
+    // Automatic fire makes the same noise every shot, only keep the latest location
+    for (FShot& Shot : Cell.Shots)
+    {
+        if (Shot.Shooter.Get() == Shooter)
+        {
+            Shot.Location = Location;
+            return;
+        }
+    }
+
+    FShot& Shot = Cell.Shots.AddDefaulted_GetRef();
+    Shot.Shooter = Shooter;
+    Shot.Location = Location;
+    Shot.Team = Shooter->GetTeam();
+}
+
+void UBotGunfireSubsystem::DeliverCell(const FShotCell& Cell, float HearingRadius, float CellSize)
+{
+    UBotRegistrySubsystem* Registry = UWorld::GetSubsystem<UBotRegistrySubsystem>(GetWorld());
+    if (!Registry || HearingRadius <= 0.f)
+    {
+        return;
+    }
+
+    UBotSignificanceSubsystem* Significance = UWorld::GetSubsystem<UBotSignificanceSubsystem>(GetWorld());
+    UBotDormancySubsystem* Dormancy = UWorld::GetSubsystem<UBotDormancySubsystem>(GetWorld());
+
+    // One query covers every shot of the cell, the exact range is checked per shot
+    const FVector CellCenter((Cell.Coord.X + 0.5f) * CellSize, (Cell.Coord.Y + 0.5f) * CellSize, Cell.Shots[0].Location.Z);
+    Registry->GetBotsInRadius(CellCenter, HearingRadius + CellSize * UE_HALF_SQRT_2, Listeners);
+
+    const float HearingRadiusSquared = FMath::Square(HearingRadius);
+
+    for (AAICharacter* Listener : Listeners)
+    {
+        const ABotController* BotController = Listener->IsAlive() ? Cast<ABotController>(Listener->GetController()) : nullptr;
+        UBotPerceptionComponent* Perception = BotController ? BotController->GetBotPerceptionComponent() : nullptr;
+        if (!Perception)
+        {
+            continue;
+        }
+
+        const ETeam ListenerTeam = Listener->GetTeam();
+        const FVector ListenerLocation = Listener->GetActorLocation();
+        bool bHeardAny = false;
+
+        for (const FShot& Shot : Cell.Shots)
+        {
+            AAICharacter* Shooter = Shot.Shooter.Get();
+            if (!Shooter || Shot.Team == ListenerTeam || FVector::DistSquared(ListenerLocation, Shot.Location) > HearingRadiusSquared)
+            {
+                continue;
+            }
+
+            Perception->NoteGunfireFrom(Shooter, Shot.Location);
+            bHeardAny = true;
+        }
+
+        if (bHeardAny && Dormancy)
+        {
+            Dormancy->WakeUp(Listener);
+        }
+
+        if (bHeardAny && Significance)
+        {
+            Significance->WakeUp(Listener);
+        }
+    }
+
+    Listeners.Reset();
+}
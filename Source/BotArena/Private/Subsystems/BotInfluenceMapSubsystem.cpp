@@ -0,0 +1,324 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/BotInfluenceMapSubsystem.h"
+#include "Subsystems/BotRegistrySubsystem.h"
+#include "Characters/AICharacter.h"
+#include "Utils/BotSpatialKernels.h"
+#include "NavMesh/NavMeshBoundsVolume.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "LogBotArena.h"
+
+static TAutoConsoleVariable<float> CVarBotInfluenceCellSize(
+    TEXT("BotArena.Influence.CellSize"),
+    200.f,
+    TEXT("Edge length of an influence map cell in world units. Read when the world starts."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarBotInfluencePresenceRadius(
+    TEXT("BotArena.Influence.PresenceRadius"),
+    4,
+    TEXT("Radius in cells of the presence stamped around every bot. Read when the world starts."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarBotInfluenceFireRadius(
+    TEXT("BotArena.Influence.FireRadius"),
+    3,
+    TEXT("Radius in cells of the fire stamped around a shooting bot. Read when the world starts."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarBotInfluenceAmmoRadius(
+    TEXT("BotArena.Influence.AmmoRadius"),
+    5,
+    TEXT("Radius in cells of the ammo stamped around an ammo box. Read when the world starts."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotInfluenceFireHalfLife(
+    TEXT("BotArena.Influence.FireHalfLife"),
+    1.5f,
+    TEXT("Seconds after which the fire stamped by a shot has faded to half its strength"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarBotInfluenceIdleFrames(
+    TEXT("BotArena.Influence.IdleFrames"),
+    30,
+    TEXT("Frames without any sample after which the map stops updating. It catches up on the frame after the next sample"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotInfluenceFireStrength(
+    TEXT("BotArena.Influence.FireStrength"),
+    0.5f,
+    TEXT("Fire added at the center of the stamp by a single shot"),
+    ECVF_Default);
+
+void UBotInfluenceMapSubsystem::FStamp::Build(int32 InRadius)
+{
+    Radius = FMath::Max(InRadius, 0);
+
+    const int32 Width = 2 * Radius + 1;
+    Weights.SetNumUninitialized(Width * Width);
+
+    // Linear falloff, 1 at the center and 0 just past the radius
+    for (int32 Y = -Radius; Y <= Radius; Y++)
+    {
+        for (int32 X = -Radius; X <= Radius; X++)
+        {
+            const float Distance = FMath::Sqrt(static_cast<float>(X * X + Y * Y));
+            Weights[(Y + Radius) * Width + X + Radius] = FMath::Max(1.f - Distance / (Radius + 1), 0.f);
+        }
+    }
+}
+
+void UBotInfluenceMapSubsystem::Deinitialize()
+{
+    for (int32 Team = 0; Team < NumTeams; Team++)
+    {
+        PresenceLayers[Team].Empty();
+        FireLayers[Team].Empty();
+    }
+
+    AmmoLayer.Empty();
+    StampedBots.Empty();
+    NumCells = 0;
+
+    Super::Deinitialize();
+}
+
+bool UBotInfluenceMapSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UBotInfluenceMapSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    // The bots can't leave the nav area, so the grid only covers the nav mesh bounds volumes
+    FBox Bounds(ForceInit);
+    for (TActorIterator<ANavMeshBoundsVolume> It(&InWorld); It; ++It)
+    {
+        Bounds += It->GetComponentsBoundingBox(true);
+    }
+
+    if (!Bounds.IsValid)
+    {
+        UE_LOG(LogBotArena, Log, TEXT("No nav mesh bounds volume in %s, the influence map is disabled"), *InWorld.GetName());
+        return;
+    }
+
+    CellSize = FMath::Max(CVarBotInfluenceCellSize.GetValueOnGameThread(), 50.f);
+    Origin = FVector2D(Bounds.Min);
+    Dimensions = FIntPoint(
+        FMath::Max(FMath::CeilToInt32(Bounds.GetSize().X / CellSize), 1),
+        FMath::Max(FMath::CeilToInt32(Bounds.GetSize().Y / CellSize), 1));
+    NumCells = Dimensions.X * Dimensions.Y;
+
+    for (int32 Team = 0; Team < NumTeams; Team++)
+    {
+        PresenceLayers[Team].SetNumZeroed(NumCells);
+        FireLayers[Team].SetNumZeroed(NumCells);
+    }
+
+    AmmoLayer.SetNumZeroed(NumCells);
+
+    PresenceStamp.Build(CVarBotInfluencePresenceRadius.GetValueOnGameThread());
+    FireStamp.Build(CVarBotInfluenceFireRadius.GetValueOnGameThread());
+    AmmoStamp.Build(CVarBotInfluenceAmmoRadius.GetValueOnGameThread());
+
+    UE_LOG(LogBotArena, Log, TEXT("Influence map of %d x %d cells"), Dimensions.X, Dimensions.Y);
+}
+
+void UBotInfluenceMapSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    if (!IsInitialized())
+    {
+        return;
+    }
+
+    // Nobody reads the map, e.g. every weight using it is 0. Keep the time so the fire still fades once it's read again
+    DecayTime += DeltaTime;
+    if (GFrameCounter - LastSampleFrame > static_cast<uint64>(FMath::Max(CVarBotInfluenceIdleFrames.GetValueOnGameThread(), 0)))
+    {
+        return;
+    }
+
+    // Fire fades out exponentially, which is a single multiply over the whole layer
+    const float HalfLife = FMath::Max(CVarBotInfluenceFireHalfLife.GetValueOnGameThread(), KINDA_SMALL_NUMBER);
+    const float Decay = FMath::Pow(0.5f, DecayTime / HalfLife);
+    DecayTime = 0.f;
+
+    for (int32 Team = 0; Team < NumTeams; Team++)
+    {
+        FBotSpatialKernels::Scale(FireLayers[Team].GetData(), NumCells, Decay);
+    }
+
+    UpdatePresence();
+}
+
+TStatId UBotInfluenceMapSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UBotInfluenceMapSubsystem, STATGROUP_Tickables);
+}
+
+float UBotInfluenceMapSubsystem::GetThreat(ETeam Team, const FVector& Location) const
+{
+    LastSampleFrame = GFrameCounter;
+
+    const int32 Cell = GetCellIndex(Location);
+    if (Cell == INDEX_NONE)
+    {
+        return 0.f;
+    }
+
+    float Threat = 0.f;
+    for (int32 OtherTeam = 0; OtherTeam < NumTeams; OtherTeam++)
+    {
+        if (OtherTeam != static_cast<int32>(Team))
+        {
+            Threat += PresenceLayers[OtherTeam][Cell] + FireLayers[OtherTeam][Cell];
+        }
+    }
+
+    return Threat;
+}
+
+float UBotInfluenceMapSubsystem::GetEnemyPresence(ETeam Team, const FVector& Location) const
+{
+    LastSampleFrame = GFrameCounter;
+
+    const int32 Cell = GetCellIndex(Location);
+    if (Cell == INDEX_NONE)
+    {
+        return 0.f;
+    }
+
+    float Presence = 0.f;
+    for (int32 OtherTeam = 0; OtherTeam < NumTeams; OtherTeam++)
+    {
+        if (OtherTeam != static_cast<int32>(Team))
+        {
+            Presence += PresenceLayers[OtherTeam][Cell];
+        }
+    }
+
+    return Presence;
+}
+
+float UBotInfluenceMapSubsystem::GetAllyPresence(ETeam Team, const FVector& Location) const
+{
+    LastSampleFrame = GFrameCounter;
+
+    const int32 Cell = GetCellIndex(Location);
+    return Cell != INDEX_NONE ? PresenceLayers[static_cast<int32>(Team)][Cell] : 0.f;
+}
+
+float UBotInfluenceMapSubsystem::GetAmmo(const FVector& Location) const
+{
+    LastSampleFrame = GFrameCounter;
+
+    const int32 Cell = GetCellIndex(Location);
+    return Cell != INDEX_NONE ? AmmoLayer[Cell] : 0.f;
+}
+
+void UBotInfluenceMapSubsystem::AddFireEvent(ETeam Team, const FVector& Location)
+{
+    const int32 Cell = GetCellIndex(Location);
+    if (Cell != INDEX_NONE)
+    {
+        ApplyStamp(FireLayers[static_cast<int32>(Team)], Cell, FireStamp, CVarBotInfluenceFireStrength.GetValueOnGameThread());
+    }
+}
+
+void UBotInfluenceMapSubsystem::AddAmmo(const FVector& Location, float Amount)
+{
+    const int32 Cell = GetCellIndex(Location);
+    if (Cell != INDEX_NONE)
+    {
+        ApplyStamp(AmmoLayer, Cell, AmmoStamp, Amount);
+    }
+}
+
+int32 UBotInfluenceMapSubsystem::GetCellIndex(const FVector& Location) const
+{
+    if (!IsInitialized())
+    {
+        return INDEX_NONE;
+    }
+
+    const int32 X = FMath::FloorToInt32((Location.X - Origin.X) / CellSize);
+    const int32 Y = FMath::FloorToInt32((Location.Y - Origin.Y) / CellSize);
+    if (X < 0 || Y < 0 || X >= Dimensions.X || Y >= Dimensions.Y)
+    {
+        return INDEX_NONE;
+    }
+
+    return Y * Dimensions.X + X;
+}
+
+void UBotInfluenceMapSubsystem::ApplyStamp(TArray<float>& Layer, int32 Cell, const FStamp& Stamp, float Factor)
+{
+    const int32 CenterX = Cell % Dimensions.X;
+    const int32 CenterY = Cell / Dimensions.X;
+    const int32 Width = 2 * Stamp.Radius + 1;
+
+    // Clip the stamp to the grid, every remaining row is one contiguous run in both arrays
+    const int32 MinX = FMath::Max(CenterX - Stamp.Radius, 0);
+    const int32 MaxX = FMath::Min(CenterX + Stamp.Radius, Dimensions.X - 1);
+    const int32 MinY = FMath::Max(CenterY - Stamp.Radius, 0);
+    const int32 MaxY = FMath::Min(CenterY + Stamp.Radius, Dimensions.Y - 1);
+
+    for (int32 Y = MinY; Y <= MaxY; Y++)
+    {
+        const int32 StampRow = (Y - CenterY + Stamp.Radius) * Width;
+        const int32 StampColumn = MinX - CenterX + Stamp.Radius;
+
+        FBotSpatialKernels::AddScaled(Layer.GetData() + Y * Dimensions.X + MinX, Stamp.Weights.GetData() + StampRow + StampColumn, MaxX - MinX + 1, Factor);
+    }
+}
+
+void UBotInfluenceMapSubsystem::UpdatePresence()
+{
+    UBotRegistrySubsystem* Registry = UWorld::GetSubsystem<UBotRegistrySubsystem>(GetWorld());
+    if (!Registry)
+    {
+        return;
+    }
+
+    Registry->RefreshBots();
+
+    // Slots past the end of the registry were freed, their bots get removed like any other
+    const int32 NumSlots = FMath::Max(Registry->GetNumSlots(), StampedBots.Num());
+    StampedBots.SetNum(NumSlots, EAllowShrinking::No);
+
+    for (int32 Slot = 0; Slot < NumSlots; Slot++)
+    {
+        FStampedBot& Stamped = StampedBots[Slot];
+
+        AAICharacter* Bot = Slot < Registry->GetNumSlots() ? Registry->GetBotAtSlot(Slot) : nullptr;
+        const int32 Cell = Bot ? GetCellIndex(Registry->GetLocationAtSlot(Slot)) : INDEX_NONE;
+        const ETeam Team = Bot ? Registry->GetTeamAtSlot(Slot) : ETeam::E_Team1;
+
+        // Most bots stay in their cell from one frame to the next, nothing to do for them
+        if (Stamped.Bot.Get() == Bot && Stamped.Cell == Cell && Stamped.Team == Team)
+        {
+            continue;
+        }
+
+        if (Stamped.Cell != INDEX_NONE)
+        {
+            ApplyStamp(PresenceLayers[static_cast<int32>(Stamped.Team)], Stamped.Cell, PresenceStamp, -1.f);
+        }
+
+        if (Cell != INDEX_NONE)
+        {
+            ApplyStamp(PresenceLayers[static_cast<int32>(Team)], Cell, PresenceStamp, 1.f);
+        }
+
+        Stamped.Bot = Bot;
+        Stamped.Cell = Cell;
+        Stamped.Team = Team;
+    }
+}
@@ -0,0 +1,305 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/BotRegistrySubsystem.h"
+#include "Characters/AICharacter.h"
+#include "HAL/IConsoleManager.h"
+#include "LogBotArena.h"
+
+static TAutoConsoleVariable<float> CVarBotRegistryCellSize(
+    TEXT("BotArena.Registry.CellSize"),
+    500.0f,
+    TEXT("Edge length of a bot registry grid cell in world units. Read when the world starts."),
+    ECVF_Default);
+
+void UBotRegistrySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    CellSize = FMath::Max(CVarBotRegistryCellSize.GetValueOnGameThread(), 1.0f);
+}
+
+void UBotRegistrySubsystem::Deinitialize()
+{
+    Entries.Reset();
+    FreeSlots.Reset();
+    SlotByBot.Reset();
+    TeamGrids.Reset();
+    CellChangedSlots.Reset();
+
+    Super::Deinitialize();
+}
+
+bool UBotRegistrySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UBotRegistrySubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    RefreshBots();
+}
+
+TStatId UBotRegistrySubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UBotRegistrySubsystem, STATGROUP_Tickables);
+}
+
+void UBotRegistrySubsystem::RegisterBot(AAICharacter* Bot)
+{
+    if (!IsValid(Bot))
+    {
+        UE_LOG(LogBotArena, Warning, TEXT("RegisterBot: Invalid bot"));
+        return;
+    }
+
+    if (SlotByBot.Contains(Bot))
+    {
+        return;
+    }
+
+    const int32 Slot = FreeSlots.Num() > 0 ? FreeSlots.Pop(EAllowShrinking::No) : Entries.AddDefaulted();
+
+    FBotEntry& Entry = Entries[Slot];
+    Entry.Bot = Bot;
+    Entry.Location = Bot->GetActorLocation();
+    Entry.Team = Bot->GetTeam();
+    Entry.bInUse = true;
+
+    FBotSpatialHashGrid& Grid = GetTeamGrid(Entry.Team);
+    Entry.Cell = Grid.GetCellCoord(Entry.Location);
+    Grid.Add(Slot, Entry.Cell);
+    SlotByBot.Add(Bot, Slot);
+
+    UE_LOG(LogBotArena, Verbose, TEXT("%s: Registered in bot registry, %d bots registered"), *GetNameSafe(Bot), SlotByBot.Num());
+}
+
+void UBotRegistrySubsystem::UnregisterBot(AAICharacter* Bot)
+{
+    int32 Slot = INDEX_NONE;
+    if (!SlotByBot.RemoveAndCopyValue(Bot, Slot))
+    {
+        return;
+    }
+
+    ReleaseSlot(Slot);
+
+    UE_LOG(LogBotArena, Verbose, TEXT("%s: Unregistered from bot registry, %d bots registered"), *GetNameSafe(Bot), SlotByBot.Num());
+}
+
+void UBotRegistrySubsystem::ReleaseSlot(int32 Slot)
+{
+    FBotEntry& Entry = Entries[Slot];
+    GetTeamGrid(Entry.Team).Remove(Slot, Entry.Cell);
+    Entry = FBotEntry();
+    FreeSlots.Add(Slot);
+}
+
+void UBotRegistrySubsystem::RefreshBots()
+{
+    if (LastRefreshFrame == GFrameCounter)
+    {
+        return;
+    }
+    LastRefreshFrame = GFrameCounter;
+
+    CellChangedSlots.Reset();
+    bool bReleasedStaleBots = false;
+
+    for (int32 Slot = 0; Slot < Entries.Num(); Slot++)
+    {
+        FBotEntry& Entry = Entries[Slot];
+        if (!Entry.bInUse)
+        {
+            continue;
+        }
+
+        AAICharacter* Bot = Entry.Bot.Get();
+        if (!Bot)
+        {
+            // The bot got destroyed without going through UnregisterBot
+            ReleaseSlot(Slot);
+            bReleasedStaleBots = true;
+            continue;
+        }
+
+        Entry.Location = Bot->GetActorLocation();
+
+        // Bots switching team move over to the grid of their new team
+        const ETeam Team = Bot->GetTeam();
+        if (Team != Entry.Team)
+        {
+            GetTeamGrid(Entry.Team).Remove(Slot, Entry.Cell);
+            Entry.Team = Team;
+
+            FBotSpatialHashGrid& Grid = GetTeamGrid(Team);
+            Entry.Cell = Grid.GetCellCoord(Entry.Location);
+            Grid.Add(Slot, Entry.Cell);
+            CellChangedSlots.Add(Slot);
+        }
+        else if (GetTeamGrid(Team).Move(Slot, Entry.Cell, Entry.Location))
+        {
+            CellChangedSlots.Add(Slot);
+        }
+    }
+
+    // Stale pointers of destroyed bots can't be looked up anymore so drop them here
+    if (bReleasedStaleBots)
+    {
+        for (auto It = SlotByBot.CreateIterator(); It; ++It)
+        {
+            if (!Entries[It.Value()].bInUse)
+            {
+                It.RemoveCurrent();
+            }
+        }
+    }
+}
+
+FBotSpatialHashGrid& UBotRegistrySubsystem::GetTeamGrid(ETeam Team)
+{
+    if (FBotSpatialHashGrid* Grid = TeamGrids.Find(Team))
+    {
+        return *Grid;
+    }
+
+    return TeamGrids.Add(Team, FBotSpatialHashGrid(CellSize));
+}
+
+int32 UBotRegistrySubsystem::FindSlot(const AActor* Bot) const
+{
+    const int32* Slot = SlotByBot.Find(Bot);
+    return Slot ? *Slot : INDEX_NONE;
+}
+
+ETeam UBotRegistrySubsystem::GetQuerierTeam(const AAICharacter* Querier) const
+{
+    if (const int32* Slot = SlotByBot.Find(Querier))
+    {
+        return Entries[*Slot].Team;
+    }
+
+    return Querier->GetTeam();
+}
+
+int32 UBotRegistrySubsystem::GatherInRadius(const AAICharacter* Querier, float Radius, bool bWantHostiles, TArray<AAICharacter*>& OutBots) const
+{
+    OutBots.Reset();
+
+    if (!IsValid(Querier) || Radius <= 0.0f)
+    {
+        return 0;
+    }
+
+    const ETeam QuerierTeam = GetQuerierTeam(Querier);
+    const FVector Center = Querier->GetActorLocation();
+    const float RadiusSquared = FMath::Square(Radius);
+
+    const auto GatherFromGrid = [&](const FBotSpatialHashGrid& Grid)
+    {
+        Grid.ForEachInRadius(Center, Radius, [&](int32 Slot)
+        {
+            const FBotEntry& Entry = Entries[Slot];
+            AAICharacter* Bot = Entry.Bot.Get();
+            if (Bot && Bot != Querier && FVector::DistSquared(Entry.Location, Center) <= RadiusSquared)
+            {
+                OutBots.Add(Bot);
+            }
+        });
+    };
+
+    // Allies live in a single grid, hostiles are spread over the grids of the other teams
+    for (const TPair<ETeam, FBotSpatialHashGrid>& TeamGrid : TeamGrids)
+    {
+        if ((TeamGrid.Key != QuerierTeam) == bWantHostiles)
+        {
+            GatherFromGrid(TeamGrid.Value);
+        }
+    }
+
+    return OutBots.Num();
+}
+
+int32 UBotRegistrySubsystem::GetEnemiesInRadius(const AAICharacter* Querier, float Radius, TArray<AAICharacter*>& OutBots) const
+{
+    return GatherInRadius(Querier, Radius, true, OutBots);
+}
+
+int32 UBotRegistrySubsystem::GetAlliesInRadius(const AAICharacter* Querier, float Radius, TArray<AAICharacter*>& OutBots) const
+{
+    return GatherInRadius(Querier, Radius, false, OutBots);
+}
+
+int32 UBotRegistrySubsystem::GetBotsInRadius(const FVector& Center, float Radius, TArray<AAICharacter*>& OutBots) const
+{
+    OutBots.Reset();
+
+    if (Radius <= 0.0f)
+    {
+        return 0;
+    }
+
+    const float RadiusSquared = FMath::Square(Radius);
+
+    for (const TPair<ETeam, FBotSpatialHashGrid>& TeamGrid : TeamGrids)
+    {
+        TeamGrid.Value.ForEachInRadius(Center, Radius, [&](int32 Slot)
+        {
+            const FBotEntry& Entry = Entries[Slot];
+            AAICharacter* Bot = Entry.Bot.Get();
+            if (Bot && FVector::DistSquared(Entry.Location, Center) <= RadiusSquared)
+            {
+                OutBots.Add(Bot);
+            }
+        });
+    }
+
+    return OutBots.Num();
+}
+
+int32 UBotRegistrySubsystem::GetKNearestHostiles(const AAICharacter* Querier, int32 K, float MaxRadius, TArray<AAICharacter*>& OutBots) const
+{
+    OutBots.Reset();
+
+    if (!IsValid(Querier) || K <= 0 || MaxRadius <= 0.0f)
+    {
+        return 0;
+    }
+
+    const FVector Center = Querier->GetActorLocation();
+
+    // Start with a single cell and double the radius so that crowded areas resolve without visiting far cells
+    float Radius = FMath::Min(CellSize, MaxRadius);
+    while (true)
+    {
+        GatherInRadius(Querier, Radius, true, OutBots);
+        if (OutBots.Num() >= K || Radius >= MaxRadius)
+        {
+            break;
+        }
+        Radius = FMath::Min(Radius * 2.0f, MaxRadius);
+    }
+
+    // Rank by the registry locations the radius filter used, so the order agrees with it
+    TArray<TPair<float, AAICharacter*>, TInlineAllocator<32>> Ranked;
+    Ranked.Reserve(OutBots.Num());
+    for (AAICharacter* Bot : OutBots)
+    {
+        Ranked.Emplace(FVector::DistSquared(Entries[SlotByBot.FindChecked(Bot)].Location, Center), Bot);
+    }
+
+    Ranked.Sort([](const TPair<float, AAICharacter*>& A, const TPair<float, AAICharacter*>& B)
+    {
+        return A.Key < B.Key;
+    });
+
+    const int32 NumToKeep = FMath::Min(K, Ranked.Num());
+    OutBots.SetNum(NumToKeep, EAllowShrinking::No);
+    for (int32 Index = 0; Index < NumToKeep; Index++)
+    {
+        OutBots[Index] = Ranked[Index].Value;
+    }
+
+    return OutBots.Num();
+}
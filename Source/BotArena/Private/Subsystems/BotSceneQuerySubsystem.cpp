@@ -0,0 +1,379 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/BotSceneQuerySubsystem.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "LogBotArena.h"
+
+static TAutoConsoleVariable<int32> CVarBotSceneQueryBudget(
+    TEXT("BotArena.SceneQuery.Budget"),
+    64,
+    TEXT("Maximum number of bot scene queries dispatched to the physics scene per frame"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotSceneQueryMergeTolerance(
+    TEXT("BotArena.SceneQuery.MergeTolerance"),
+    1.0f,
+    TEXT("Start and end points closer than this (world units) are considered equal when merging duplicate queries"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarBotSceneQueryAgingFrames(
+    TEXT("BotArena.SceneQuery.AgingFrames"),
+    30,
+    TEXT("A queued query is promoted one priority level for every this many frames it waits for budget"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarBotSceneQueryResultLifetime(
+    TEXT("BotArena.SceneQuery.ResultLifetimeFrames"),
+    30,
+    TEXT("Number of frames a completed query result is kept for handles that were never released"),
+    ECVF_Default);
+
+FBotSceneQueryDesc FBotSceneQueryDesc::LineTrace(EAsyncTraceType InTraceType, const FVector& InStart, const FVector& InEnd, const FCollisionObjectQueryParams& InObjectQueryParams, FName InTraceTag)
+{
+    FBotSceneQueryDesc Desc;
+    Desc.bIsSweep = false;
+    Desc.TraceType = InTraceType;
+    Desc.Start = InStart;
+    Desc.End = InEnd;
+    Desc.ObjectQueryParams = InObjectQueryParams;
+    Desc.TraceTag = InTraceTag;
+    return Desc;
+}
+
+FBotSceneQueryDesc FBotSceneQueryDesc::LineTraceByChannel(EAsyncTraceType InTraceType, const FVector& InStart, const FVector& InEnd, ECollisionChannel InTraceChannel, FName InTraceTag)
+{
+    FBotSceneQueryDesc Desc = LineTrace(InTraceType, InStart, InEnd, FCollisionObjectQueryParams(), InTraceTag);
+    Desc.TraceChannel = InTraceChannel;
+    return Desc;
+}
+
+FBotSceneQueryDesc FBotSceneQueryDesc::Sweep(EAsyncTraceType InTraceType, const FVector& InStart, const FVector& InEnd, const FCollisionShape& InShape, const FCollisionObjectQueryParams& InObjectQueryParams, FName InTraceTag)
+{
+    FBotSceneQueryDesc Desc = LineTrace(InTraceType, InStart, InEnd, InObjectQueryParams, InTraceTag);
+    Desc.bIsSweep = true;
+    Desc.Shape = InShape;
+    return Desc;
+}
+
+FBotSceneQueryDesc& FBotSceneQueryDesc::IgnoreActor(const AActor* Actor)
+{
+    if (Actor)
+    {
+        IgnoredActors.AddUnique(Actor);
+    }
+    return *this;
+}
+
+void UBotSceneQuerySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    QueryDelegate.BindUObject(this, &UBotSceneQuerySubsystem::OnQueryCompleted);
+}
+
+void UBotSceneQuerySubsystem::Deinitialize()
+{
+    QueryDelegate.Unbind();
+    Requests.Reset();
+    Queue.Reset();
+    MergeableRequests.Reset();
+    RequestByHandle.Reset();
+
+    Super::Deinitialize();
+}
+
+bool UBotSceneQuerySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UBotSceneQuerySubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    ExpireResults();
+    DispatchQueued();
+}
+
+TStatId UBotSceneQuerySubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UBotSceneQuerySubsystem, STATGROUP_Tickables);
+}
+
+FBotSceneQueryHandle UBotSceneQuerySubsystem::Request(const FBotSceneQueryDesc& Desc, EBotSceneQueryPriority Priority)
+{
+    const uint32 Key = MakeRequestKey(Desc);
+
+    // Look for an identical request that hasn't been dispatched yet
+    uint32 RequestId = 0;
+    TArray<uint32, TInlineAllocator<4>> Candidates;
+    MergeableRequests.MultiFind(Key, Candidates);
+    for (const uint32 CandidateId : Candidates)
+    {
+        FRequest& Candidate = Requests[CandidateId];
+        if (IsSameQuery(Candidate.Desc, Desc))
+        {
+            RequestId = CandidateId;
+            Candidate.Priority = FMath::Max(Candidate.Priority, Priority);
+            break;
+        }
+    }
+
+    if (RequestId == 0)
+    {
+        RequestId = NextRequestId++;
+
+        FRequest& NewRequest = Requests.Add(RequestId);
+        NewRequest.Desc = Desc;
+        NewRequest.Key = Key;
+        NewRequest.Priority = Priority;
+        NewRequest.QueuedFrame = GFrameCounter;
+
+        Queue.Add(RequestId);
+        MergeableRequests.Add(Key, RequestId);
+    }
+
+    FBotSceneQueryHandle Handle;
+    Handle.Id = NextHandleId++;
+    if (NextHandleId == 0)
+    {
+        NextHandleId = 1;
+    }
+
+    Requests[RequestId].Handles.Add(Handle.Id);
+    RequestByHandle.Add(Handle.Id, RequestId);
+
+    return Handle;
+}
+
+EBotSceneQueryStatus UBotSceneQuerySubsystem::GetStatus(const FBotSceneQueryHandle& Handle) const
+{
+    const uint32* RequestId = RequestByHandle.Find(Handle.Id);
+    if (!RequestId)
+    {
+        return EBotSceneQueryStatus::Invalid;
+    }
+
+    return Requests[*RequestId].State == ERequestState::Done ? EBotSceneQueryStatus::Ready : EBotSceneQueryStatus::Pending;
+}
+
+EBotSceneQueryStatus UBotSceneQuerySubsystem::GetResult(const FBotSceneQueryHandle& Handle, TArray<FHitResult>& OutHits) const
+{
+    const EBotSceneQueryStatus Status = GetStatus(Handle);
+    if (Status == EBotSceneQueryStatus::Ready)
+    {
+        OutHits = Requests[RequestByHandle[Handle.Id]].Hits;
+    }
+
+    return Status;
+}
+
+void UBotSceneQuerySubsystem::Release(FBotSceneQueryHandle& Handle)
+{
+    uint32 RequestId = 0;
+    if (RequestByHandle.RemoveAndCopyValue(Handle.Id, RequestId))
+    {
+        FRequest& Request = Requests[RequestId];
+        Request.Handles.RemoveSingleSwap(Handle.Id);
+
+        // In flight requests are dropped when their results arrive
+        if (Request.Handles.Num() == 0 && Request.State != ERequestState::InFlight)
+        {
+            RemoveRequest(RequestId);
+        }
+    }
+
+    Handle.Invalidate();
+}
+
+uint32 UBotSceneQuerySubsystem::MakeRequestKey(const FBotSceneQueryDesc& Desc) const
+{
+    const float Tolerance = FMath::Max(CVarBotSceneQueryMergeTolerance.GetValueOnGameThread(), KINDA_SMALL_NUMBER);
+    const auto Quantize = [Tolerance](const FVector& Location)
+    {
+        return FIntVector(
+            FMath::RoundToInt32(Location.X / Tolerance),
+            FMath::RoundToInt32(Location.Y / Tolerance),
+            FMath::RoundToInt32(Location.Z / Tolerance));
+    };
+
+    uint32 Key = GetTypeHash(Quantize(Desc.Start));
+    Key = HashCombine(Key, GetTypeHash(Quantize(Desc.End)));
+    Key = HashCombine(Key, GetTypeHash(Desc.ObjectQueryParams.GetQueryBitfield()));
+    Key = HashCombine(Key, GetTypeHash(static_cast<uint8>(Desc.TraceChannel)));
+    Key = HashCombine(Key, GetTypeHash(static_cast<uint8>(Desc.TraceType)));
+
+    if (Desc.bIsSweep)
+    {
+        Key = HashCombine(Key, GetTypeHash(static_cast<uint8>(Desc.Shape.ShapeType)));
+        Key = HashCombine(Key, GetTypeHash(Quantize(Desc.Shape.GetExtent())));
+    }
+
+    for (const TWeakObjectPtr<const AActor>& IgnoredActor : Desc.IgnoredActors)
+    {
+        Key = HashCombine(Key, GetTypeHash(IgnoredActor));
+    }
+
+    return Key;
+}
+
+bool UBotSceneQuerySubsystem::IsSameQuery(const FBotSceneQueryDesc& A, const FBotSceneQueryDesc& B)
+{
+    const float Tolerance = CVarBotSceneQueryMergeTolerance.GetValueOnGameThread();
+
+    if (A.bIsSweep != B.bIsSweep || A.TraceType != B.TraceType || A.TraceChannel != B.TraceChannel
+        || A.ObjectQueryParams.GetQueryBitfield() != B.ObjectQueryParams.GetQueryBitfield()
+        || !A.Start.Equals(B.Start, Tolerance) || !A.End.Equals(B.End, Tolerance))
+    {
+        return false;
+    }
+
+    if (A.bIsSweep && (A.Shape.ShapeType != B.Shape.ShapeType || !A.Shape.GetExtent().Equals(B.Shape.GetExtent(), Tolerance)))
+    {
+        return false;
+    }
+
+    if (A.IgnoredActors.Num() != B.IgnoredActors.Num())
+    {
+        return false;
+    }
+
+    for (const TWeakObjectPtr<const AActor>& IgnoredActor : A.IgnoredActors)
+    {
+        if (!B.IgnoredActors.Contains(IgnoredActor))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void UBotSceneQuerySubsystem::DispatchQueued()
+{
+    UWorld* World = GetWorld();
+    if (!World || Queue.Num() == 0)
+    {
+        return;
+    }
+
+    // Older requests climb the priority ladder so a busy frame can't starve the low priority ones forever
+    const uint64 AgingFrames = FMath::Max(CVarBotSceneQueryAgingFrames.GetValueOnGameThread(), 1);
+    const auto EffectivePriority = [this, AgingFrames](uint32 RequestId)
+    {
+        const FRequest& Request = Requests[RequestId];
+        return static_cast<uint64>(Request.Priority) + (GFrameCounter - Request.QueuedFrame) / AgingFrames;
+    };
+
+    Queue.StableSort([&EffectivePriority](uint32 A, uint32 B)
+    {
+        return EffectivePriority(A) > EffectivePriority(B);
+    });
+
+    const int32 Budget = FMath::Max(CVarBotSceneQueryBudget.GetValueOnGameThread(), 0);
+    const int32 NumToDispatch = FMath::Min(Budget, Queue.Num());
+
+    for (int32 Index = 0; Index < NumToDispatch; Index++)
+    {
+        const uint32 RequestId = Queue[Index];
+        FRequest& Request = Requests[RequestId];
+        const FBotSceneQueryDesc& Desc = Request.Desc;
+
+        FCollisionQueryParams QueryParams(Desc.TraceTag);
+        for (const TWeakObjectPtr<const AActor>& IgnoredActor : Desc.IgnoredActors)
+        {
+            QueryParams.AddIgnoredActor(IgnoredActor.Get());
+        }
+
+        if (Desc.IsByChannel())
+        {
+            if (Desc.bIsSweep)
+            {
+                World->AsyncSweepByChannel(Desc.TraceType, Desc.Start, Desc.End, FQuat::Identity, Desc.TraceChannel, Desc.Shape, QueryParams, FCollisionResponseParams::DefaultResponseParam, &QueryDelegate, RequestId);
+            }
+            else
+            {
+                World->AsyncLineTraceByChannel(Desc.TraceType, Desc.Start, Desc.End, Desc.TraceChannel, QueryParams, FCollisionResponseParams::DefaultResponseParam, &QueryDelegate, RequestId);
+            }
+        }
+        else if (Desc.bIsSweep)
+        {
+            World->AsyncSweepByObjectType(Desc.TraceType, Desc.Start, Desc.End, FQuat::Identity, Desc.ObjectQueryParams, Desc.Shape, QueryParams, &QueryDelegate, RequestId);
+        }
+        else
+        {
+            World->AsyncLineTraceByObjectType(Desc.TraceType, Desc.Start, Desc.End, Desc.ObjectQueryParams, QueryParams, &QueryDelegate, RequestId);
+        }
+
+        // Once dispatched the request can't absorb duplicates anymore
+        Request.State = ERequestState::InFlight;
+        MergeableRequests.RemoveSingle(Request.Key, RequestId);
+    }
+
+    Queue.RemoveAt(0, NumToDispatch, EAllowShrinking::No);
+
+    if (Queue.Num() > 0)
+    {
+        UE_LOG(LogBotArena, Verbose, TEXT("Scene query budget of %d exhausted, %d queries carried over"), Budget, Queue.Num());
+    }
+}
+
+void UBotSceneQuerySubsystem::OnQueryCompleted(const FTraceHandle& TraceHandle, FTraceDatum& Datum)
+{
+    FRequest* Request = Requests.Find(Datum.UserData);
+    if (!Request)
+    {
+        return;
+    }
+
+    // Nobody is waiting for this one anymore
+    if (Request->Handles.Num() == 0)
+    {
+        RemoveRequest(Datum.UserData);
+        return;
+    }
+
+    Request->Hits = MoveTemp(Datum.OutHits);
+    Request->State = ERequestState::Done;
+    Request->CompletedFrame = GFrameCounter;
+}
+
+void UBotSceneQuerySubsystem::ExpireResults()
+{
+    const uint64 Lifetime = FMath::Max(CVarBotSceneQueryResultLifetime.GetValueOnGameThread(), 1);
+
+    TArray<uint32, TInlineAllocator<16>> ExpiredRequests;
+    for (const TPair<uint32, FRequest>& Pair : Requests)
+    {
+        if (Pair.Value.State == ERequestState::Done && GFrameCounter - Pair.Value.CompletedFrame > Lifetime)
+        {
+            ExpiredRequests.Add(Pair.Key);
+        }
+    }
+
+    for (const uint32 RequestId : ExpiredRequests)
+    {
+        RemoveRequest(RequestId);
+    }
+}
+
+void UBotSceneQuerySubsystem::RemoveRequest(uint32 RequestId)
+{
+    FRequest Request;
+    if (!Requests.RemoveAndCopyValue(RequestId, Request))
+    {
+        return;
+    }
+
+    for (const uint32 HandleId : Request.Handles)
+    {
+        RequestByHandle.Remove(HandleId);
+    }
+
+    if (Request.State == ERequestState::Queued)
+    {
+        Queue.RemoveSingle(RequestId);
+        MergeableRequests.RemoveSingle(Request.Key, RequestId);
+    }
+}
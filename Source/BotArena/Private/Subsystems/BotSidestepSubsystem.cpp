@@ -0,0 +1,515 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/BotSidestepSubsystem.h"
+#include "Subsystems/BotEQSSubsystem.h"
+#include "Subsystems/BotRegistrySubsystem.h"
+#include "Subsystems/BotVisibilitySubsystem.h"
+#include "Subsystems/BotInfluenceMapSubsystem.h"
+#include "Subsystems/BotFrameBudgetSubsystem.h"
+#include "Environment/BotPVSData.h"
+#include "Characters/AICharacter.h"
+#include "Components/BotHealthComponent.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "LogBotArena.h"
+
+static TAutoConsoleVariable<bool> CVarBotSidestepAsync(
+    TEXT("BotArena.Sidestep.Async"),
+    true,
+    TEXT("Generate and score the sidestep candidates on a worker task instead of the game thread: 0=off, 1=on"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarBotSidestepCommitBudget(
+    TEXT("BotArena.Sidestep.CommitBudget"),
+    8,
+    TEXT("Maximum number of sidestep results committed (nav projected) per frame"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotSidestepThreatWeight(
+    TEXT("BotArena.Sidestep.ThreatWeight"),
+    1.0f,
+    TEXT("How many ranks a unit of influence map threat costs a sidestep candidate when its best candidates are committed"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarBotSidestepCandidatesToProject(
+    TEXT("BotArena.Sidestep.CandidatesToProject"),
+    4,
+    TEXT("Number of best scored candidates of a bot that are projected on the nav mesh when its result is committed"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotSidestepUnderFireTime(
+    TEXT("BotArena.Sidestep.UnderFireTime"),
+    2.0f,
+    TEXT("Bots that took damage within this many seconds get their sidestep committed first"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarBotSidestepNearbyPointsShortlist(
+    TEXT("BotArena.Sidestep.NearbyPointsShortlist"),
+    8,
+    TEXT("EQ_NearbyPoints only tests this many of its points, the best ones by sidestep score. 0 tests them all"),
+    ECVF_Default);
+
+void UBotSidestepSubsystem::Deinitialize()
+{
+    // The worker task reads the PVS, it has to be done before anything goes away
+    if (bEvaluationInFlight)
+    {
+        EvaluationTask.Wait();
+        bEvaluationInFlight = false;
+    }
+
+    EvaluationPVS = nullptr;
+    Requests.Reset();
+
+    Super::Deinitialize();
+}
+
+bool UBotSidestepSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UBotSidestepSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    FBotBudgetScope BudgetScope(GetWorld(), EBotBudgetDomain::EQS);
+
+    CollectEvaluation();
+    CommitResults();
+    LaunchEvaluation();
+}
+
+TStatId UBotSidestepSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UBotSidestepSubsystem, STATGROUP_Tickables);
+}
+
+uint32 UBotSidestepSubsystem::RequestSidestep(AAICharacter* Bot, const AActor* Target, const FBotSidestepParams& Params)
+{
+    if (!IsValid(Bot) || Params.AngleStep <= 0.f)
+    {
+        return 0;
+    }
+
+    const uint32 RequestId = NextRequestId++;
+    if (NextRequestId == 0)
+    {
+        NextRequestId = 1;
+    }
+
+    FRequest& Request = Requests.Add(RequestId);
+    Request.Bot = Bot;
+    Request.Target = Target;
+    Request.Params = Params;
+    Request.RequestFrame = GFrameCounter;
+
+    // Over the EQS budget the least significant bots search a sparser ring
+    if (const UBotFrameBudgetSubsystem* Budget = UWorld::GetSubsystem<UBotFrameBudgetSubsystem>(GetWorld()))
+    {
+        const float SpacingScale = Budget->GetEQSSpacingScale(Bot);
+        Request.Params.AngleStep *= SpacingScale;
+        Request.Params.PointsDistance *= SpacingScale;
+    }
+
+    return RequestId;
+}
+
+EBotSidestepStatus UBotSidestepSubsystem::PollSidestep(uint32 RequestId, FVector& OutLocation)
+{
+    FRequest* Request = Requests.Find(RequestId);
+    if (!Request)
+    {
+        return EBotSidestepStatus::Invalid;
+    }
+
+    const EBotSidestepStatus Status = Request->Status;
+    if (Status == EBotSidestepStatus::Pending)
+    {
+        return Status;
+    }
+
+    OutLocation = Request->Result;
+    Requests.Remove(RequestId);
+
+    return Status;
+}
+
+void UBotSidestepSubsystem::CancelSidestep(uint32 RequestId)
+{
+    // In flight requests simply won't find their entry when the worker results come back
+    Requests.Remove(RequestId);
+}
+
+void UBotSidestepSubsystem::ShortlistCandidates(const AAICharacter& Bot, const AActor* Target, const FBotSidestepParams& Params, TArray<FNavLocation>& InOutPoints, int32 NumToKeep) const
+{
+    if (NumToKeep <= 0 || InOutPoints.Num() <= NumToKeep)
+    {
+        return;
+    }
+
+    TArray<AAICharacter*> Allies;
+    TArray<FVector, TInlineAllocator<8>> AllyLocations;
+    if (const UBotRegistrySubsystem* Registry = UWorld::GetSubsystem<UBotRegistrySubsystem>(GetWorld()))
+    {
+        Registry->GetAlliesInRadius(&Bot, Params.MaxRange + Params.AllySpacing, Allies);
+        for (const AAICharacter* Ally : Allies)
+        {
+            AllyLocations.Add(Ally->GetActorLocation());
+        }
+    }
+
+    const UBotVisibilitySubsystem* Visibility = UWorld::GetSubsystem<UBotVisibilitySubsystem>(GetWorld());
+    const FScoringContext Context(Bot.GetActorLocation(), Target ? Target->GetActorLocation() : FVector::ZeroVector, Target != nullptr, Params,
+        AllyLocations, Visibility ? Visibility->GetPVSData() : nullptr);
+
+    // Points the target can't be seen from rank last instead of being dropped, the query tests have the final say
+    TArray<TPair<float, int32>, TInlineAllocator<64>> Scored;
+    Scored.Reserve(InOutPoints.Num());
+    for (int32 Index = 0; Index < InOutPoints.Num(); Index++)
+    {
+        float Score = 0.f;
+        if (!Context.Score(InOutPoints[Index].Location, Score))
+        {
+            Score = -UE_BIG_NUMBER;
+        }
+        Scored.Emplace(Score, Index);
+    }
+
+    Scored.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B)
+    {
+        return A.Key > B.Key;
+    });
+
+    TArray<FNavLocation, TInlineAllocator<16>> Shortlist;
+    for (int32 Rank = 0; Rank < NumToKeep; Rank++)
+    {
+        Shortlist.Add(InOutPoints[Scored[Rank].Value]);
+    }
+
+    InOutPoints.Reset();
+    InOutPoints.Append(Shortlist);
+}
+
+int32 UBotSidestepSubsystem::GetNearbyPointsShortlistSize()
+{
+    return FMath::Max(CVarBotSidestepNearbyPointsShortlist.GetValueOnGameThread(), 0);
+}
+
+void UBotSidestepSubsystem::LaunchEvaluation()
+{
+    if (bEvaluationInFlight)
+    {
+        return;
+    }
+
+    UBotEQSSubsystem* EQSSubsystem = UWorld::GetSubsystem<UBotEQSSubsystem>(GetWorld());
+    UBotRegistrySubsystem* Registry = UWorld::GetSubsystem<UBotRegistrySubsystem>(GetWorld());
+    if (!EQSSubsystem || !Registry)
+    {
+        return;
+    }
+
+    Registry->RefreshBots();
+
+    TArray<FSnapshot> Snapshots;
+    TArray<AAICharacter*> Allies;
+
+    for (TPair<uint32, FRequest>& Pair : Requests)
+    {
+        FRequest& Request = Pair.Value;
+        if (Request.bInFlight || Request.bHasCandidates || Request.Status != EBotSidestepStatus::Pending)
+        {
+            continue;
+        }
+
+        AAICharacter* Bot = Request.Bot.Get();
+        if (!Bot)
+        {
+            Request.Status = EBotSidestepStatus::Failed;
+            continue;
+        }
+
+        FSnapshot& Snapshot = Snapshots.AddDefaulted_GetRef();
+        Snapshot.RequestId = Pair.Key;
+        Snapshot.BotLocation = Bot->GetActorLocation();
+        Snapshot.BotForward = Bot->GetActorForwardVector();
+        Snapshot.Params = Request.Params;
+
+        if (const AActor* Target = Request.Target.Get())
+        {
+            Snapshot.TargetLocation = Target->GetActorLocation();
+            Snapshot.bHasTarget = true;
+        }
+
+        const FBotRingTemplate& Ring = EQSSubsystem->GetRingTemplate(Request.Params.AngleStep, Request.Params.DegreesGap, Request.Params.PointsDistance, Request.Params.MaxRange);
+        Snapshot.Directions = Ring.Directions;
+        Snapshot.Distances = Ring.Distances;
+
+        // Only the allies that can be close to a candidate matter
+        Registry->GetAlliesInRadius(Bot, Request.Params.MaxRange + Request.Params.AllySpacing, Allies);
+        for (const AAICharacter* Ally : Allies)
+        {
+            Snapshot.AllyLocations.Add(Ally->GetActorLocation());
+        }
+
+        Request.bInFlight = true;
+    }
+
+    if (Snapshots.Num() == 0)
+    {
+        return;
+    }
+
+    UBotVisibilitySubsystem* Visibility = UWorld::GetSubsystem<UBotVisibilitySubsystem>(GetWorld());
+    EvaluationPVS = Visibility ? Visibility->GetPVSData() : nullptr;
+
+    const int32 NumCandidatesToKeep = FMath::Max(CVarBotSidestepCandidatesToProject.GetValueOnGameThread(), 1);
+
+    auto Evaluate = [Snapshots = MoveTemp(Snapshots), PVS = EvaluationPVS.Get(), NumCandidatesToKeep]()
+    {
+        TArray<FScoredCandidates> Results;
+        Results.SetNum(Snapshots.Num());
+        for (int32 Index = 0; Index < Snapshots.Num(); Index++)
+        {
+            EvaluateSnapshot(Snapshots[Index], PVS, NumCandidatesToKeep, Results[Index]);
+        }
+        return Results;
+    };
+
+    if (!CVarBotSidestepAsync.GetValueOnGameThread())
+    {
+        // Same work, inline, the results are committed on the next commit pass
+        TArray<FScoredCandidates> Results = Evaluate();
+        ApplyEvaluation(Results);
+        EvaluationPVS = nullptr;
+        return;
+    }
+
+    EvaluationTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, MoveTemp(Evaluate));
+    bEvaluationInFlight = true;
+}
+
+void UBotSidestepSubsystem::CollectEvaluation()
+{
+    if (!bEvaluationInFlight || !EvaluationTask.IsCompleted())
+    {
+        return;
+    }
+
+    ApplyEvaluation(EvaluationTask.GetResult());
+
+    EvaluationTask = {};
+    EvaluationPVS = nullptr;
+    bEvaluationInFlight = false;
+}
+
+void UBotSidestepSubsystem::ApplyEvaluation(TArray<FScoredCandidates>& Results)
+{
+    for (FScoredCandidates& Candidates : Results)
+    {
+        // The request may have been cancelled meanwhile
+        if (FRequest* Request = Requests.Find(Candidates.RequestId))
+        {
+            Request->bInFlight = false;
+            Request->bHasCandidates = true;
+            Request->Candidates = MoveTemp(Candidates.Locations);
+        }
+    }
+}
+
+void UBotSidestepSubsystem::CommitResults()
+{
+    TArray<TPair<float, uint32>, TInlineAllocator<32>> ReadyRequests;
+    for (const TPair<uint32, FRequest>& Pair : Requests)
+    {
+        if (Pair.Value.bHasCandidates && Pair.Value.Status == EBotSidestepStatus::Pending)
+        {
+            ReadyRequests.Emplace(GetUrgency(Pair.Value), Pair.Key);
+        }
+    }
+
+    if (ReadyRequests.Num() == 0)
+    {
+        return;
+    }
+
+    ReadyRequests.Sort([](const TPair<float, uint32>& A, const TPair<float, uint32>& B)
+    {
+        return A.Key > B.Key;
+    });
+
+    UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+    const UBotInfluenceMapSubsystem* InfluenceMap = UWorld::GetSubsystem<UBotInfluenceMapSubsystem>(GetWorld());
+    const float ThreatWeight = CVarBotSidestepThreatWeight.GetValueOnGameThread();
+    const int32 Budget = FMath::Max(CVarBotSidestepCommitBudget.GetValueOnGameThread(), 0);
+    const int32 NumToCommit = FMath::Min(Budget, ReadyRequests.Num());
+
+    TArray<FNavigationProjectionWork> Workload;
+
+    for (int32 Index = 0; Index < NumToCommit; Index++)
+    {
+        FRequest& Request = Requests[ReadyRequests[Index].Value];
+        Request.Status = EBotSidestepStatus::Failed;
+
+        AAICharacter* Bot = Request.Bot.Get();
+        const ANavigationData* NavData = (Bot && NavSys) ? NavSys->GetNavDataForActor(*Bot) : nullptr;
+        if (!NavData || Request.Candidates.Num() == 0)
+        {
+            continue;
+        }
+
+        // The worker can't read the influence map, so its ranking is adjusted here with the threat at every candidate
+        if (InfluenceMap && InfluenceMap->IsInitialized() && ThreatWeight > 0.f)
+        {
+            const ETeam Team = Bot->GetTeam();
+
+            TArray<TPair<float, FVector>, TInlineAllocator<4>> Ranked;
+            for (int32 Rank = 0; Rank < Request.Candidates.Num(); Rank++)
+            {
+                const FVector& Candidate = Request.Candidates[Rank];
+                Ranked.Emplace(Rank + ThreatWeight * InfluenceMap->GetThreat(Team, Candidate), Candidate);
+            }
+
+            Ranked.StableSort([](const TPair<float, FVector>& A, const TPair<float, FVector>& B)
+            {
+                return A.Key < B.Key;
+            });
+
+            for (int32 Rank = 0; Rank < Ranked.Num(); Rank++)
+            {
+                Request.Candidates[Rank] = Ranked[Rank].Value;
+            }
+        }
+
+        // All the candidates of a bot go in one batch, the best one that lands on the nav mesh wins
+        Workload.Reset();
+        for (const FVector& Candidate : Request.Candidates)
+        {
+            Workload.Add(FNavigationProjectionWork(Candidate));
+        }
+
+        const FVector ProjectionExtent(Request.Params.PointsDistance * 0.5f, Request.Params.PointsDistance * 0.5f, 256.f);
+        NavData->BatchProjectPoints(Workload, ProjectionExtent, NavData->GetDefaultQueryFilter(), Bot);
+
+        for (const FNavigationProjectionWork& Work : Workload)
+        {
+            if (Work.bResult)
+            {
+                Request.Result = Work.OutLocation.Location;
+                Request.Status = EBotSidestepStatus::Succeeded;
+                break;
+            }
+        }
+    }
+
+    if (ReadyRequests.Num() > NumToCommit)
+    {
+        UE_LOG(LogBotArena, Verbose, TEXT("Sidestep commit budget of %d exhausted, %d results carried over"), Budget, ReadyRequests.Num() - NumToCommit);
+    }
+}
+
+void UBotSidestepSubsystem::EvaluateSnapshot(const FSnapshot& Snapshot, const UBotPVSData* PVS, int32 NumCandidatesToKeep, FScoredCandidates& OutCandidates)
+{
+    OutCandidates.RequestId = Snapshot.RequestId;
+
+    const FVector& Forward = Snapshot.BotForward;
+    const FVector SideVector = FVector::CrossProduct(FVector::UpVector, Forward);
+    const FVector UpComponent = FVector::UpVector * Forward.Z;
+
+    const FScoringContext Context(Snapshot.BotLocation, Snapshot.TargetLocation, Snapshot.bHasTarget, Snapshot.Params, Snapshot.AllyLocations, PVS);
+
+    TArray<TPair<float, FVector>, TInlineAllocator<64>> Scored;
+    Scored.Reserve(Snapshot.Directions.Num() * Snapshot.Distances.Num());
+
+    for (const FVector2f& Direction : Snapshot.Directions)
+    {
+        const FVector RingDirection = Forward * Direction.X + SideVector * Direction.Y + UpComponent * (1.f - Direction.X);
+
+        for (const float Distance : Snapshot.Distances)
+        {
+            const FVector Candidate = Snapshot.BotLocation + RingDirection * Distance;
+
+            float Score = 0.f;
+            if (Context.Score(Candidate, Score))
+            {
+                Scored.Emplace(Score, Candidate);
+            }
+        }
+    }
+
+    Scored.Sort([](const TPair<float, FVector>& A, const TPair<float, FVector>& B)
+    {
+        return A.Key > B.Key;
+    });
+
+    const int32 NumToKeep = FMath::Min(NumCandidatesToKeep, Scored.Num());
+    for (int32 Index = 0; Index < NumToKeep; Index++)
+    {
+        OutCandidates.Locations.Add(Scored[Index].Value);
+    }
+}
+
+UBotSidestepSubsystem::FScoringContext::FScoringContext(const FVector& InBotLocation, const FVector& InTargetLocation, bool bInHasTarget,
+    const FBotSidestepParams& Params, TConstArrayView<FVector> InAllyLocations, const UBotPVSData* InPVS)
+    : BotLocation(InBotLocation)
+    , TargetLocation(InTargetLocation)
+    , bHasTarget(bInHasTarget)
+    , MaxRange(FMath::Max(Params.MaxRange, 1.f))
+    , AllySpacingSquared(FMath::Square(Params.AllySpacing))
+    , AllyLocations(InAllyLocations)
+    , PVS(InPVS)
+{
+    const FVector ToTarget = TargetLocation - BotLocation;
+    TargetDistance = ToTarget.Size2D();
+    TargetRight = FVector::CrossProduct(FVector::UpVector, ToTarget.GetSafeNormal2D());
+}
+
+bool UBotSidestepSubsystem::FScoringContext::Score(const FVector& Candidate, float& OutScore) const
+{
+    OutScore = 0.f;
+
+    if (bHasTarget)
+    {
+        // Keep shooting: the target has to stay potentially visible
+        if (PVS && !PVS->IsPotentiallyVisible(TargetLocation, Candidate))
+        {
+            return false;
+        }
+
+        // Dodge across the line of fire rather than along it, and keep the engagement distance
+        const FVector Move = Candidate - BotLocation;
+        OutScore += FMath::Abs(FVector::DotProduct(Move.GetSafeNormal2D(), TargetRight));
+        OutScore -= FMath::Abs(FVector::Dist2D(Candidate, TargetLocation) - TargetDistance) / MaxRange;
+    }
+
+    // Don't crowd the allies, they are shot at too
+    for (const FVector& AllyLocation : AllyLocations)
+    {
+        const float DistSquared = FVector::DistSquared2D(Candidate, AllyLocation);
+        if (DistSquared < AllySpacingSquared)
+        {
+            OutScore -= 1.f - DistSquared / AllySpacingSquared;
+        }
+    }
+
+    return true;
+}
+
+float UBotSidestepSubsystem::GetUrgency(const FRequest& Request) const
+{
+    // Older requests come first among bots in the same situation
+    float Urgency = static_cast<float>(GFrameCounter - Request.RequestFrame) * 0.001f;
+
+    const AAICharacter* Bot = Request.Bot.Get();
+    const UBotHealthComponent* HealthComponent = Bot ? Bot->GetHealthComponent() : nullptr;
+    if (HealthComponent && HealthComponent->GetLastDamageTime() >= 0.f
+        && GetWorld()->GetTimeSeconds() - HealthComponent->GetLastDamageTime() <= CVarBotSidestepUnderFireTime.GetValueOnGameThread())
+    {
+        Urgency += 1000.f;
+    }
+
+    return Urgency;
+}
@@ -0,0 +1,238 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/BotSignificanceSubsystem.h"
+#include "Subsystems/BotRegistrySubsystem.h"
+#include "Subsystems/BotInfluenceMapSubsystem.h"
+#include "Subsystems/BotFrameBudgetSubsystem.h"
+#include "Components/BotPerceptionComponent.h"
+#include "Components/BotHealthComponent.h"
+#include "Controllers/BotController.h"
+#include "Characters/AICharacter.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<bool> CVarBotSignificanceEnabled(
+    TEXT("BotArena.Significance.Enabled"),
+    true,
+    TEXT("Scale the perception cost of every bot with its significance: 0=off, 1=on"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotSignificanceViewerRadius(
+    TEXT("BotArena.Significance.ViewerRadius"),
+    4000.f,
+    TEXT("Distance to the nearest player viewpoint at which a bot stops being significant for being watched"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotSignificanceDamageWindow(
+    TEXT("BotArena.Significance.DamageWindow"),
+    3.f,
+    TEXT("Seconds after taking damage during which a bot stays significant, fading out linearly"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotSignificanceDecayRate(
+    TEXT("BotArena.Significance.DecayRate"),
+    0.5f,
+    TEXT("How much significance a bot loses per second once things calm down. Rising is always immediate"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotSignificanceQuietTickInterval(
+    TEXT("BotArena.Significance.QuietTickInterval"),
+    0.25f,
+    TEXT("Tick interval in seconds of the perception component of a bot with no significance. Significant bots tick every frame"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotSignificanceQuietSelectScale(
+    TEXT("BotArena.Significance.QuietSelectScale"),
+    2.f,
+    TEXT("Factor applied to the target selection interval of a bot with no significance"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarBotSignificanceQuietSightInterval(
+    TEXT("BotArena.Significance.QuietSightInterval"),
+    6,
+    TEXT("Number of sense updates between two sight updates of a bot with no significance"),
+    ECVF_Default);
+
+void UBotSignificanceSubsystem::Deinitialize()
+{
+    SignificanceBySlot.Empty();
+    BotBySlot.Empty();
+    ViewerLocations.Empty();
+
+    Super::Deinitialize();
+}
+
+bool UBotSignificanceSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UBotSignificanceSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    UBotRegistrySubsystem* Registry = UWorld::GetSubsystem<UBotRegistrySubsystem>(GetWorld());
+    if (!Registry)
+    {
+        return;
+    }
+
+    Registry->RefreshBots();
+    GatherViewers();
+
+    const bool bEnabled = IsEnabled();
+    const double Now = GetWorld()->GetTimeSeconds();
+    const float Decay = FMath::Max(CVarBotSignificanceDecayRate.GetValueOnGameThread(), 0.f) * DeltaTime;
+    const float QuietTickInterval = FMath::Max(CVarBotSignificanceQuietTickInterval.GetValueOnGameThread(), 0.f);
+    const float QuietSelectScale = FMath::Max(CVarBotSignificanceQuietSelectScale.GetValueOnGameThread(), 1.f);
+    const float BudgetCutoff = GetBudgetCutoff();
+
+    const int32 NumSlots = Registry->GetNumSlots();
+    SignificanceBySlot.SetNum(NumSlots, EAllowShrinking::No);
+    BotBySlot.SetNum(NumSlots, EAllowShrinking::No);
+
+    for (int32 Slot = 0; Slot < NumSlots; Slot++)
+    {
+        AAICharacter* Bot = Registry->GetBotAtSlot(Slot);
+        const ABotController* BotController = Bot ? Cast<ABotController>(Bot->GetController()) : nullptr;
+        UBotPerceptionComponent* Perception = BotController ? BotController->GetBotPerceptionComponent() : nullptr;
+        if (!Perception)
+        {
+            continue;
+        }
+
+        float& Significance = SignificanceBySlot[Slot];
+
+        // A recycled slot starts from scratch
+        if (BotBySlot[Slot].Get() != Bot)
+        {
+            BotBySlot[Slot] = Bot;
+            Significance = 1.f;
+        }
+
+        // Rise at once, fade out slowly
+        const float Target = bEnabled ? ComputeSignificance(*Registry, Slot, Now) : 1.f;
+        Significance = bEnabled ? FMath::Max(Target, Significance - Decay) : 1.f;
+
+        // Over the perception budget the bots under the cutoff get the quiet LOD
+        const float LODSignificance = Significance < BudgetCutoff ? 0.f : Significance;
+        Perception->SetPerceptionLOD(FMath::Lerp(QuietTickInterval, 0.f, LODSignificance), FMath::Lerp(QuietSelectScale, 1.f, LODSignificance));
+    }
+}
+
+TStatId UBotSignificanceSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UBotSignificanceSubsystem, STATGROUP_Tickables);
+}
+
+bool UBotSignificanceSubsystem::IsEnabled()
+{
+    return CVarBotSignificanceEnabled.GetValueOnGameThread();
+}
+
+float UBotSignificanceSubsystem::GetSignificance(const AActor* Bot) const
+{
+    const UBotRegistrySubsystem* Registry = UWorld::GetSubsystem<UBotRegistrySubsystem>(GetWorld());
+    const int32 Slot = Registry ? Registry->FindSlot(Bot) : INDEX_NONE;
+    if (!IsEnabled() || !SignificanceBySlot.IsValidIndex(Slot) || BotBySlot[Slot].Get() != Bot)
+    {
+        return 1.f;
+    }
+
+    return SignificanceBySlot[Slot];
+}
+
+int32 UBotSignificanceSubsystem::GetSightInterval(const AActor* Bot) const
+{
+    const int32 QuietSightInterval = FMath::Max(CVarBotSignificanceQuietSightInterval.GetValueOnGameThread(), 1);
+    const float Significance = GetSignificance(Bot);
+    const float LODSignificance = Significance < GetBudgetCutoff() ? 0.f : Significance;
+    return FMath::RoundToInt32(FMath::Lerp(static_cast<float>(QuietSightInterval), 1.f, LODSignificance));
+}
+
+float UBotSignificanceSubsystem::GetBudgetCutoff() const
+{
+    const UBotFrameBudgetSubsystem* Budget = UWorld::GetSubsystem<UBotFrameBudgetSubsystem>(GetWorld());
+    return Budget ? Budget->GetSignificanceCutoff(EBotBudgetDomain::Perception) : 0.f;
+}
+
+void UBotSignificanceSubsystem::WakeUp(const AActor* Bot)
+{
+    const UBotRegistrySubsystem* Registry = UWorld::GetSubsystem<UBotRegistrySubsystem>(GetWorld());
+    const int32 Slot = Registry ? Registry->FindSlot(Bot) : INDEX_NONE;
+    if (SignificanceBySlot.IsValidIndex(Slot) && BotBySlot[Slot].Get() == Bot)
+    {
+        SignificanceBySlot[Slot] = 1.f;
+    }
+}
+
+void UBotSignificanceSubsystem::GatherViewers()
+{
+    ViewerLocations.Reset();
+
+    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+    {
+        const APlayerController* PlayerController = It->Get();
+        if (PlayerController && PlayerController->IsLocalController())
+        {
+            FVector ViewLocation;
+            FRotator ViewRotation;
+            PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+            ViewerLocations.Add(ViewLocation);
+        }
+    }
+}
+
+float UBotSignificanceSubsystem::ComputeSignificance(const UBotRegistrySubsystem& Registry, int32 Slot, double Now) const
+{
+    const AAICharacter* Bot = Registry.GetBotAtSlot(Slot);
+    if (!Bot || !Bot->IsAlive())
+    {
+        return 0.f;
+    }
+
+    const FVector& Location = Registry.GetLocationAtSlot(Slot);
+
+    // Watched by a player
+    float ViewerFactor = 0.f;
+    const float ViewerRadius = FMath::Max(CVarBotSignificanceViewerRadius.GetValueOnGameThread(), 1.f);
+    for (const FVector& ViewerLocation : ViewerLocations)
+    {
+        ViewerFactor = FMath::Max(ViewerFactor, 1.f - FMath::Min(FVector::Dist(Location, ViewerLocation) / ViewerRadius, 1.f));
+    }
+
+    // Enemies around, the presence of a single bot is 1 at its own cell
+    float HostileFactor = 0.f;
+    const UBotInfluenceMapSubsystem* InfluenceMap = UWorld::GetSubsystem<UBotInfluenceMapSubsystem>(GetWorld());
+    if (InfluenceMap && InfluenceMap->IsInitialized())
+    {
+        HostileFactor = FMath::Min(InfluenceMap->GetEnemyPresence(Registry.GetTeamAtSlot(Slot), Location), 1.f);
+    }
+
+    // An enemy in sight counts fully, even beyond the reach of the presence stamps
+    const ABotController* BotController = Cast<ABotController>(Bot->GetController());
+    const UBotPerceptionComponent* Perception = BotController ? BotController->GetBotPerceptionComponent() : nullptr;
+    if (Perception)
+    {
+        for (const FBotThreatEntry& Threat : Perception->GetThreatTable())
+        {
+            if (Threat.bVisible)
+            {
+                HostileFactor = 1.f;
+                break;
+            }
+        }
+    }
+
+    // Recently hurt
+    float DamageFactor = 0.f;
+    const UBotHealthComponent* HealthComponent = Bot->GetHealthComponent();
+    const float DamageWindow = CVarBotSignificanceDamageWindow.GetValueOnGameThread();
+    if (HealthComponent && HealthComponent->GetLastDamageTime() > 0.f && DamageWindow > 0.f)
+    {
+        DamageFactor = 1.f - FMath::Min(static_cast<float>(Now - HealthComponent->GetLastDamageTime()) / DamageWindow, 1.f);
+    }
+
+    return FMath::Max3(ViewerFactor, HostileFactor, DamageFactor);
+}
@@ -0,0 +1,240 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/BotSquadKnowledgeSubsystem.h"
+#include "Subsystems/BotRegistrySubsystem.h"
+#include "Components/BotPerceptionComponent.h"
+#include "Controllers/BotController.h"
+#include "Characters/AICharacter.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<bool> CVarBotSquadEnabled(
+    TEXT("BotArena.Squad.Enabled"),
+    true,
+    TEXT("Share the enemies sensed by a bot with its team and reduce the sight checks of squad followers: 0=off, 1=on"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotSquadClusterRadius(
+    TEXT("BotArena.Squad.ClusterRadius"),
+    800.f,
+    TEXT("Teammates within this distance of a squad leader follow it"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotSquadShareRadius(
+    TEXT("BotArena.Squad.ShareRadius"),
+    2500.f,
+    TEXT("Enemies seen by teammates are only considered as targets within this distance of the bot"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarBotSquadFollowerSightInterval(
+    TEXT("BotArena.Squad.FollowerSightInterval"),
+    4,
+    TEXT("Squad followers only run their own sight checks once every this many sense updates"),
+    ECVF_Default);
+
+void UBotSquadKnowledgeSubsystem::Deinitialize()
+{
+    for (int32 Team = 0; Team < NumTeams; Team++)
+    {
+        KnownEnemies[Team].Empty();
+        EnemyIndexBySlot[Team].Empty();
+        WasSeenBySlot[Team].Empty();
+        MemberPerceptions[Team].Empty();
+    }
+
+    FollowerBySlot.Empty();
+    LeaderSlots.Empty();
+
+    Super::Deinitialize();
+}
+
+bool UBotSquadKnowledgeSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UBotSquadKnowledgeSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    UBotRegistrySubsystem* Registry = UWorld::GetSubsystem<UBotRegistrySubsystem>(GetWorld());
+    if (!Registry || !IsEnabled())
+    {
+        return;
+    }
+
+    Registry->RefreshBots();
+
+    MergeKnowledge(*Registry);
+    AssignFollowers(*Registry);
+}
+
+TStatId UBotSquadKnowledgeSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UBotSquadKnowledgeSubsystem, STATGROUP_Tickables);
+}
+
+bool UBotSquadKnowledgeSubsystem::IsEnabled()
+{
+    return CVarBotSquadEnabled.GetValueOnGameThread();
+}
+
+float UBotSquadKnowledgeSubsystem::GetShareRadius()
+{
+    return FMath::Max(CVarBotSquadShareRadius.GetValueOnGameThread(), 0.f);
+}
+
+int32 UBotSquadKnowledgeSubsystem::GetFollowerSightInterval()
+{
+    return FMath::Max(CVarBotSquadFollowerSightInterval.GetValueOnGameThread(), 1);
+}
+
+const TArray<FBotSharedThreat>& UBotSquadKnowledgeSubsystem::GetKnownEnemies(ETeam Team) const
+{
+    return KnownEnemies[FMath::Clamp(static_cast<int32>(Team), 0, NumTeams - 1)];
+}
+
+bool UBotSquadKnowledgeSubsystem::IsFollower(const AActor* Bot) const
+{
+    const UBotRegistrySubsystem* Registry = UWorld::GetSubsystem<UBotRegistrySubsystem>(GetWorld());
+    const int32 Slot = Registry ? Registry->FindSlot(Bot) : INDEX_NONE;
+    return IsEnabled() && FollowerBySlot.IsValidIndex(Slot) && FollowerBySlot[Slot];
+}
+
+void UBotSquadKnowledgeSubsystem::MergeKnowledge(const UBotRegistrySubsystem& Registry)
+{
+    const int32 NumSlots = Registry.GetNumSlots();
+
+    for (int32 Team = 0; Team < NumTeams; Team++)
+    {
+        // Remember which enemies were seen last frame, so members can be told when the team spots a new one
+        WasSeenBySlot[Team].SetNumUninitialized(NumSlots, EAllowShrinking::No);
+        FMemory::Memzero(WasSeenBySlot[Team].GetData(), NumSlots);
+
+        for (const FBotSharedThreat& Known : KnownEnemies[Team])
+        {
+            if (Known.NumSpotters > 0 && Known.Slot < NumSlots)
+            {
+                WasSeenBySlot[Team][Known.Slot] = true;
+            }
+        }
+
+        KnownEnemies[Team].Reset();
+        EnemyIndexBySlot[Team].SetNumUninitialized(NumSlots, EAllowShrinking::No);
+        for (int32& Index : EnemyIndexBySlot[Team])
+        {
+            Index = INDEX_NONE;
+        }
+
+        MemberPerceptions[Team].Reset();
+    }
+
+    for (int32 Slot = 0; Slot < NumSlots; Slot++)
+    {
+        const AAICharacter* Bot = Registry.GetBotAtSlot(Slot);
+        const ABotController* BotController = Bot && Bot->IsAlive() ? Cast<ABotController>(Bot->GetController()) : nullptr;
+        UBotPerceptionComponent* Perception = BotController ? BotController->GetBotPerceptionComponent() : nullptr;
+        if (!Perception)
+        {
+            continue;
+        }
+
+        const int32 Team = static_cast<int32>(Registry.GetTeamAtSlot(Slot));
+        MemberPerceptions[Team].Add(Perception);
+
+        for (const FBotThreatEntry& Threat : Perception->GetThreatTable())
+        {
+            const int32 ThreatSlot = Registry.FindSlot(Threat.Actor.Get());
+            if (ThreatSlot == INDEX_NONE || static_cast<int32>(Registry.GetTeamAtSlot(ThreatSlot)) == Team)
+            {
+                continue;
+            }
+
+            int32& Index = EnemyIndexBySlot[Team][ThreatSlot];
+            if (Index == INDEX_NONE)
+            {
+                Index = KnownEnemies[Team].AddDefaulted();
+                KnownEnemies[Team][Index].Bot = Registry.GetBotAtSlot(ThreatSlot);
+                KnownEnemies[Team][Index].Slot = ThreatSlot;
+            }
+
+            FBotSharedThreat& Known = KnownEnemies[Team][Index];
+            if (Threat.LastSeenTime >= Known.LastSeenTime)
+            {
+                Known.LastSeenLocation = Threat.LastSeenLocation;
+                Known.LastSeenTime = Threat.LastSeenTime;
+            }
+
+            if (Threat.bVisible)
+            {
+                Known.NumSpotters++;
+            }
+        }
+    }
+
+    // A newly spotted enemy is a new target candidate for the whole team
+    for (int32 Team = 0; Team < NumTeams; Team++)
+    {
+        bool bSpottedNewEnemy = false;
+        for (const FBotSharedThreat& Known : KnownEnemies[Team])
+        {
+            if (Known.NumSpotters > 0 && !WasSeenBySlot[Team][Known.Slot])
+            {
+                bSpottedNewEnemy = true;
+                break;
+            }
+        }
+
+        if (bSpottedNewEnemy)
+        {
+            for (UBotPerceptionComponent* Perception : MemberPerceptions[Team])
+            {
+                Perception->MarkTargetCandidatesChanged();
+            }
+        }
+
+        MemberPerceptions[Team].Reset();
+    }
+}
+
+void UBotSquadKnowledgeSubsystem::AssignFollowers(const UBotRegistrySubsystem& Registry)
+{
+    const int32 NumSlots = Registry.GetNumSlots();
+    const float ClusterRadiusSquared = FMath::Square(CVarBotSquadClusterRadius.GetValueOnGameThread());
+
+    FollowerBySlot.SetNumUninitialized(NumSlots, EAllowShrinking::No);
+    FMemory::Memzero(FollowerBySlot.GetData(), NumSlots);
+
+    for (int32 Team = 0; Team < NumTeams; Team++)
+    {
+        LeaderSlots.Reset();
+
+        // Slots are stable, so walking them in order keeps the same leaders from one frame to the next
+        for (int32 Slot = 0; Slot < NumSlots; Slot++)
+        {
+            const AAICharacter* Bot = Registry.GetBotAtSlot(Slot);
+            if (!Bot || !Bot->IsAlive() || static_cast<int32>(Registry.GetTeamAtSlot(Slot)) != Team)
+            {
+                continue;
+            }
+
+            const FVector& Location = Registry.GetLocationAtSlot(Slot);
+
+            bool bNearLeader = false;
+            for (const int32 LeaderSlot : LeaderSlots)
+            {
+                if (FVector::DistSquared(Location, Registry.GetLocationAtSlot(LeaderSlot)) <= ClusterRadiusSquared)
+                {
+                    bNearLeader = true;
+                    break;
+                }
+            }
+
+            FollowerBySlot[Slot] = bNearLeader;
+
+            if (!bNearLeader)
+            {
+                LeaderSlots.Add(Slot);
+            }
+        }
+    }
+}
@@ -0,0 +1,283 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/BotTargetSelectionSubsystem.h"
+#include "Subsystems/BotRegistrySubsystem.h"
+#include "Subsystems/BotInfluenceMapSubsystem.h"
+#include "Subsystems/BotSquadKnowledgeSubsystem.h"
+#include "Subsystems/BotTickManagerSubsystem.h"
+#include "Components/BotPerceptionComponent.h"
+#include "Controllers/BotController.h"
+#include "Characters/AICharacter.h"
+#include "Utils/BotSpatialKernels.h"
+#include "HAL/IConsoleManager.h"
+#include "LogBotArena.h"
+
+static TAutoConsoleVariable<bool> CVarBotTargetingBatched(
+    TEXT("BotArena.Targeting.Batched"),
+    true,
+    TEXT("Select the targets of all bots in one batched pass per frame instead of per bot: 0=off, 1=on"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotTargetingIsolationWeight(
+    TEXT("BotArena.Targeting.IsolationWeight"),
+    0.0f,
+    TEXT("How much the enemy presence around a candidate, read from the influence map, stretches its distance. 0 picks the closest hostile. Only the batched selection reads it"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBotTargetingDamageWeight(
+    TEXT("BotArena.Targeting.DamageWeight"),
+    0.02f,
+    TEXT("How much each point of damage a candidate recently dealt to the bot shrinks its distance. 0 ignores the damage"),
+    ECVF_Default);
+
+void UBotTargetSelectionSubsystem::Deinitialize()
+{
+    Perceptions.Reset();
+
+    Super::Deinitialize();
+}
+
+bool UBotTargetSelectionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UBotTargetSelectionSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    // The tick manager runs the selection itself, between the sense and act phases
+    const UBotTickManagerSubsystem* TickManager = UWorld::GetSubsystem<UBotTickManagerSubsystem>(GetWorld());
+    if (IsBatchingEnabled() && !(TickManager && TickManager->IsEnabled()))
+    {
+        SelectTargets();
+    }
+}
+
+TStatId UBotTargetSelectionSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UBotTargetSelectionSubsystem, STATGROUP_Tickables);
+}
+
+bool UBotTargetSelectionSubsystem::IsBatchingEnabled()
+{
+    return CVarBotTargetingBatched.GetValueOnGameThread();
+}
+
+void UBotTargetSelectionSubsystem::RegisterPerception(UBotPerceptionComponent* Perception)
+{
+    if (Perception)
+    {
+        Perceptions.AddUnique(Perception);
+    }
+}
+
+void UBotTargetSelectionSubsystem::UnregisterPerception(UBotPerceptionComponent* Perception)
+{
+    Perceptions.RemoveSingleSwap(Perception, EAllowShrinking::No);
+}
+
+void UBotTargetSelectionSubsystem::SelectTargets()
+{
+    UBotRegistrySubsystem* Registry = UWorld::GetSubsystem<UBotRegistrySubsystem>(GetWorld());
+    if (!Registry)
+    {
+        return;
+    }
+
+    Registry->RefreshBots();
+
+    bool bGathered = false;
+
+    for (int32 Index = Perceptions.Num() - 1; Index >= 0; Index--)
+    {
+        UBotPerceptionComponent* Perception = Perceptions[Index].Get();
+        if (!Perception)
+        {
+            Perceptions.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+            continue;
+        }
+
+        // Dormant bots have nothing to pick from, they look again once they wake up
+        if (Perception->IsDormant())
+        {
+            continue;
+        }
+
+        const bool bCandidatesChanged = Perception->HaveTargetCandidatesChanged();
+        const bool bIntervalExpired = Perception->IsTargetSelectionIntervalExpired();
+        if (!bCandidatesChanged && !bIntervalExpired)
+        {
+            continue;
+        }
+
+        Perception->MarkTargetCandidatesEvaluated();
+
+        // Like the per bot path, keep the current target until the interval expires unless it died
+        AActor* CurrentTarget = Perception->GetSelectedTarget();
+        if (!bIntervalExpired && CurrentTarget && Registry->IsRegistered(CurrentTarget))
+        {
+            continue;
+        }
+
+        // The buffers are only filled on frames where at least one bot needs them
+        if (!bGathered)
+        {
+            GatherBotData(*Registry);
+            bGathered = true;
+        }
+
+        EvaluateBot(*Perception, *Registry);
+    }
+}
+
+void UBotTargetSelectionSubsystem::GatherBotData(const UBotRegistrySubsystem& Registry)
+{
+    const int32 NumSlots = Registry.GetNumSlots();
+
+    BotX.SetNumUninitialized(NumSlots, EAllowShrinking::No);
+    BotY.SetNumUninitialized(NumSlots, EAllowShrinking::No);
+    BotZ.SetNumUninitialized(NumSlots, EAllowShrinking::No);
+    BotTeam.SetNumUninitialized(NumSlots, EAllowShrinking::No);
+    BotAlive.SetNumUninitialized(NumSlots, EAllowShrinking::No);
+
+    for (int32 Slot = 0; Slot < NumSlots; Slot++)
+    {
+        const AAICharacter* Bot = Registry.GetBotAtSlot(Slot);
+        const FVector& Location = Registry.GetLocationAtSlot(Slot);
+
+        BotX[Slot] = Location.X;
+        BotY[Slot] = Location.Y;
+        BotZ[Slot] = Location.Z;
+        BotTeam[Slot] = static_cast<uint8>(Registry.GetTeamAtSlot(Slot));
+        BotAlive[Slot] = Bot && Bot->IsAlive();
+    }
+}
+
+void UBotTargetSelectionSubsystem::EvaluateBot(UBotPerceptionComponent& Perception, const UBotRegistrySubsystem& Registry)
+{
+    const ABotController* BotController = Cast<ABotController>(Perception.GetOwner());
+    const int32 OwnerSlot = BotController ? Registry.FindSlot(BotController->GetPawn()) : INDEX_NONE;
+    if (OwnerSlot == INDEX_NONE)
+    {
+        return;
+    }
+
+    const uint8 OwnerTeam = BotTeam[OwnerSlot];
+
+    CandidateX.Reset();
+    CandidateY.Reset();
+    CandidateZ.Reset();
+    CandidateDamage.Reset();
+    CandidateSlot.Reset();
+
+    // Resolve the visible threats to registry slots and keep the live hostiles only.
+    // Team and alive state come from the gathered buffers so no casts or component lookups happen here
+    for (const FBotThreatEntry& Threat : Perception.GetThreatTable())
+    {
+        if (!Threat.bVisible)
+        {
+            continue;
+        }
+
+        const int32 Slot = Registry.FindSlot(Threat.Actor.Get());
+        if (Slot == INDEX_NONE || !BotAlive[Slot] || BotTeam[Slot] == OwnerTeam)
+        {
+            continue;
+        }
+
+        CandidateX.Add(BotX[Slot]);
+        CandidateY.Add(BotY[Slot]);
+        CandidateZ.Add(BotZ[Slot]);
+        CandidateDamage.Add(Threat.DamageDealt);
+        CandidateSlot.Add(Slot);
+    }
+
+    // Add the enemies currently seen by teammates nearby. The bot may remember damage from them while not seeing them itself
+    const UBotSquadKnowledgeSubsystem* SquadKnowledge = UWorld::GetSubsystem<UBotSquadKnowledgeSubsystem>(GetWorld());
+    if (SquadKnowledge && UBotSquadKnowledgeSubsystem::IsEnabled())
+    {
+        const FVector OwnerLocation(BotX[OwnerSlot], BotY[OwnerSlot], BotZ[OwnerSlot]);
+        const float ShareRadiusSquared = FMath::Square(UBotSquadKnowledgeSubsystem::GetShareRadius());
+
+        for (const FBotSharedThreat& Known : SquadKnowledge->GetKnownEnemies(static_cast<ETeam>(OwnerTeam)))
+        {
+            const int32 Slot = Known.Slot;
+            if (Known.NumSpotters == 0 || Slot >= BotAlive.Num() || !BotAlive[Slot] || CandidateSlot.Contains(Slot))
+            {
+                continue;
+            }
+
+            // The knowledge is a frame old, the slot may have been recycled since
+            if (Registry.GetBotAtSlot(Slot) != Known.Bot.Get())
+            {
+                continue;
+            }
+
+            if (FVector::DistSquared(Known.LastSeenLocation, OwnerLocation) > ShareRadiusSquared)
+            {
+                continue;
+            }
+
+            const FBotThreatEntry* Remembered = Perception.GetThreatTable().Find(Known.Bot.Get());
+
+            CandidateX.Add(BotX[Slot]);
+            CandidateY.Add(BotY[Slot]);
+            CandidateZ.Add(BotZ[Slot]);
+            CandidateDamage.Add(Remembered ? Remembered->DamageDealt : 0.f);
+            CandidateSlot.Add(Slot);
+        }
+    }
+
+    // Wait for the next interval before scanning the same candidates again
+    Perception.ResetTargetSelectionTimer();
+
+    if (CandidateSlot.Num() == 0)
+    {
+        UE_LOG(LogBotArena, Verbose, TEXT("%s: No suitable target found"), *GetNameSafe(BotController));
+        return;
+    }
+
+    CandidateDistSquared.SetNumUninitialized(CandidateSlot.Num(), EAllowShrinking::No);
+
+    const FVector3f Origin(BotX[OwnerSlot], BotY[OwnerSlot], BotZ[OwnerSlot]);
+    FBotSpatialKernels::DistanceSquared(CandidateX.GetData(), CandidateY.GetData(), CandidateZ.GetData(), CandidateSlot.Num(), Origin, CandidateDistSquared.GetData());
+
+    // Prefer isolated hostiles: a crowded spot is scored as if it were further away
+    const float IsolationWeight = CVarBotTargetingIsolationWeight.GetValueOnGameThread();
+    const UBotInfluenceMapSubsystem* InfluenceMap = UWorld::GetSubsystem<UBotInfluenceMapSubsystem>(GetWorld());
+    const bool bUseIsolation = IsolationWeight > 0.f && InfluenceMap && InfluenceMap->IsInitialized();
+
+    // Prefer the hostiles that hurt us: damage is scored as if they were closer
+    const float DamageWeight = FMath::Max(CVarBotTargetingDamageWeight.GetValueOnGameThread(), 0.f);
+
+    const float* Scores = CandidateDistSquared.GetData();
+
+    if (bUseIsolation || DamageWeight > 0.f)
+    {
+        CandidateScore.SetNumUninitialized(CandidateSlot.Num(), EAllowShrinking::No);
+
+        for (int32 Index = 0; Index < CandidateSlot.Num(); Index++)
+        {
+            float Score = CandidateDistSquared[Index] / (1.f + DamageWeight * CandidateDamage[Index]);
+
+            if (bUseIsolation)
+            {
+                const FVector CandidateLocation(CandidateX[Index], CandidateY[Index], CandidateZ[Index]);
+                const float EnemyPresence = InfluenceMap->GetEnemyPresence(static_cast<ETeam>(OwnerTeam), CandidateLocation);
+                Score *= 1.f + IsolationWeight * EnemyPresence;
+            }
+
+            CandidateScore[Index] = Score;
+        }
+
+        Scores = CandidateScore.GetData();
+    }
+
+    const int32 BestIndex = FBotSpatialKernels::FindMinIndex(Scores, CandidateSlot.Num());
+    AAICharacter* NewTarget = Registry.GetBotAtSlot(CandidateSlot[BestIndex]);
+    if (NewTarget)
+    {
+        Perception.ApplySelectedTarget(NewTarget, FMath::Sqrt(CandidateDistSquared[BestIndex]));
+    }
+}
@@ -0,0 +1,186 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/BotTickManagerSubsystem.h"
+#include "Subsystems/BotTargetSelectionSubsystem.h"
+#include "Components/BotPerceptionComponent.h"
+#include "Components/BotMovementComponent.h"
+#include "Subsystems/BotFrameBudgetSubsystem.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<bool> CVarBotTickManagerEnabled(
+    TEXT("BotArena.TickManager.Enabled"),
+    true,
+    TEXT("Update the bot components in phases from one central tick instead of their own tick functions: 0=off, 1=on. Read when the world starts."),
+    ECVF_Default);
+
+void UBotTickManagerSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    // Latched, so components spawned later and the ones already registered agree on who ticks them
+    bEnabled = CVarBotTickManagerEnabled.GetValueOnGameThread();
+}
+
+void UBotTickManagerSubsystem::Deinitialize()
+{
+    Perceptions.Empty();
+    Movements.Empty();
+    PerceptionElapsed.Empty();
+    PerceptionDelta.Empty();
+
+    Super::Deinitialize();
+}
+
+bool UBotTickManagerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UBotTickManagerSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    if (!bEnabled)
+    {
+        return;
+    }
+
+    RunSensePhase(DeltaTime);
+    RunThinkPhase();
+    RunActPhase();
+}
+
+TStatId UBotTickManagerSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UBotTickManagerSubsystem, STATGROUP_Tickables);
+}
+
+void UBotTickManagerSubsystem::RegisterPerception(UBotPerceptionComponent* Perception)
+{
+    if (!bEnabled || !Perception || Perceptions.Contains(Perception))
+    {
+        return;
+    }
+
+    Perception->SetComponentTickEnabled(false);
+    Perceptions.Add(Perception);
+    PerceptionElapsed.Add(0.f);
+    PerceptionDelta.Add(0.f);
+}
+
+void UBotTickManagerSubsystem::RegisterMovement(UBotMovementComponent* Movement)
+{
+    if (bEnabled && Movement)
+    {
+        Movement->SetComponentTickEnabled(false);
+        Movements.AddUnique(Movement);
+    }
+}
+
+void UBotTickManagerSubsystem::UnregisterPerception(UBotPerceptionComponent* Perception)
+{
+    const int32 Index = Perceptions.Find(Perception);
+    if (Index != INDEX_NONE)
+    {
+        Perceptions.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+        PerceptionElapsed.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+        PerceptionDelta.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    }
+}
+
+void UBotTickManagerSubsystem::UnregisterMovement(UBotMovementComponent* Movement)
+{
+    Movements.RemoveSingleSwap(Movement, EAllowShrinking::No);
+}
+
+void UBotTickManagerSubsystem::RunSensePhase(float DeltaTime)
+{
+    FBotBudgetScope BudgetScope(GetWorld(), EBotBudgetDomain::Perception);
+
+    for (int32 Index = Perceptions.Num() - 1; Index >= 0; Index--)
+    {
+        UBotPerceptionComponent* Perception = Perceptions[Index].Get();
+        if (!Perception)
+        {
+            Perceptions.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+            PerceptionElapsed.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+            PerceptionDelta.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+            continue;
+        }
+
+        if (Perception->IsDormant())
+        {
+            PerceptionElapsed[Index] = 0.f;
+            PerceptionDelta[Index] = 0.f;
+            continue;
+        }
+
+        // Honour the tick interval of the perception LOD like the tick function would
+        PerceptionElapsed[Index] += DeltaTime;
+        if (PerceptionElapsed[Index] < Perception->GetComponentTickInterval())
+        {
+            PerceptionDelta[Index] = 0.f;
+            continue;
+        }
+
+        PerceptionDelta[Index] = PerceptionElapsed[Index];
+        PerceptionElapsed[Index] = 0.f;
+
+        Perception->SenseTick(PerceptionDelta[Index]);
+    }
+}
+
+void UBotTickManagerSubsystem::RunThinkPhase()
+{
+    FBotBudgetScope BudgetScope(GetWorld(), EBotBudgetDomain::Perception);
+
+    for (int32 Index = 0; Index < Perceptions.Num(); Index++)
+    {
+        UBotPerceptionComponent* Perception = Perceptions[Index].Get();
+        if (Perception && PerceptionDelta[Index] > 0.f)
+        {
+            Perception->ThinkTick();
+        }
+    }
+
+    // The batched selection reads what every bot sensed, so it runs once all of them are done.
+    // The manager owns the pass while it's enabled, the target selection subsystem ticks it otherwise
+    UBotTargetSelectionSubsystem* TargetSelection = UWorld::GetSubsystem<UBotTargetSelectionSubsystem>(GetWorld());
+    if (TargetSelection && UBotTargetSelectionSubsystem::IsBatchingEnabled())
+    {
+        TargetSelection->SelectTargets();
+    }
+}
+
+void UBotTickManagerSubsystem::RunActPhase()
+{
+    {
+        FBotBudgetScope BudgetScope(GetWorld(), EBotBudgetDomain::Perception);
+
+        for (int32 Index = 0; Index < Perceptions.Num(); Index++)
+        {
+            UBotPerceptionComponent* Perception = Perceptions[Index].Get();
+            if (Perception && PerceptionDelta[Index] > 0.f)
+            {
+                Perception->ActTick(PerceptionDelta[Index]);
+            }
+        }
+    }
+
+    FBotBudgetScope BudgetScope(GetWorld(), EBotBudgetDomain::Movement);
+
+    for (int32 Index = Movements.Num() - 1; Index >= 0; Index--)
+    {
+        UBotMovementComponent* Movement = Movements[Index].Get();
+        if (!Movement)
+        {
+            Movements.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+            continue;
+        }
+
+        if (!Movement->IsDormant())
+        {
+            Movement->AdjustMeshForCrouch();
+        }
+    }
+}
@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/BotTimerSubsystem.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<float> CVarBotTimersResolution(
+    TEXT("BotArena.Timers.Resolution"),
+    1.0f / 60.0f,
+    TEXT("Length in seconds of a tick of the bot timer wheel, timers are rounded to it. Read when the world starts."),
+    ECVF_Default);
+
+void UBotTimerSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    Wheel = FBotTimerWheel(FMath::Max(CVarBotTimersResolution.GetValueOnGameThread(), 0.001f));
+}
+
+void UBotTimerSubsystem::Deinitialize()
+{
+    Wheel.Reset();
+
+    Super::Deinitialize();
+}
+
+bool UBotTimerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UBotTimerSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    Wheel.Advance(DeltaTime);
+}
+
+TStatId UBotTimerSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UBotTimerSubsystem, STATGROUP_Tickables);
+}
+
+FBotTimerHandle UBotTimerSubsystem::SetTimer(float Delay, TFunction<void()>&& Callback)
+{
+    return Wheel.Schedule(Delay, MoveTemp(Callback));
+}
+
+void UBotTimerSubsystem::ClearTimer(FBotTimerHandle& Handle)
+{
+    Wheel.Cancel(Handle);
+}
@@ -0,0 +1,209 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/BotVisibilitySubsystem.h"
+#include "Environment/BotPVSData.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/PackageName.h"
+#include "LogBotArena.h"
+#include "BotArenaCollision.h"
+
+static TAutoConsoleVariable<int32> CVarBotVisibilityMaxStaleFrames(
+    TEXT("BotArena.Visibility.MaxStaleFrames"),
+    6,
+    TEXT("Number of frames a cached line of sight result is used before it gets refreshed with a new trace"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<bool> CVarBotVisibilityUsePVS(
+    TEXT("BotArena.Visibility.UsePVS"),
+    true,
+    TEXT("Reject line of sight queries between cells the baked PVS marks as not visible: 0=off, 1=on"),
+    ECVF_Default);
+
+void UBotVisibilitySubsystem::Deinitialize()
+{
+    PVSData = nullptr;
+    Pairs.Reset();
+    PendingTraces.Reset();
+
+    Super::Deinitialize();
+}
+
+bool UBotVisibilitySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UBotVisibilitySubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    CollectTraceResults();
+
+    // Every now and then drop the pairs nobody asked about for a while
+    if (GFrameCounter % 60 != 0)
+    {
+        return;
+    }
+
+    const uint64 MaxAge = FMath::Max(CVarBotVisibilityMaxStaleFrames.GetValueOnGameThread(), 1) * 10;
+    for (auto It = Pairs.CreateIterator(); It; ++It)
+    {
+        const FPairEntry& Entry = It.Value();
+        if (!Entry.bTracePending && GFrameCounter - Entry.ResultFrame > MaxAge)
+        {
+            It.RemoveCurrent();
+        }
+    }
+}
+
+void UBotVisibilitySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    // PIE worlds live in a prefixed copy of the map package
+    const FString MapName = UWorld::RemovePIEPrefix(InWorld.GetOutermost()->GetName());
+    const FString PackageName = UBotPVSData::GetPackageNameForMap(MapName);
+
+    if (FPackageName::DoesPackageExist(PackageName))
+    {
+        const FString ObjectPath = PackageName + TEXT(".") + FPackageName::GetShortName(PackageName);
+        PVSData = LoadObject<UBotPVSData>(nullptr, *ObjectPath);
+    }
+
+    if (PVSData)
+    {
+        UE_LOG(LogBotArena, Log, TEXT("Loaded PVS %s with %d cells"), *PackageName, PVSData->GetNumCells());
+    }
+    else
+    {
+        UE_LOG(LogBotArena, Log, TEXT("No PVS baked for %s, every line of sight query will be traced"), *MapName);
+    }
+}
+
+TStatId UBotVisibilitySubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UBotVisibilitySubsystem, STATGROUP_Tickables);
+}
+
+bool UBotVisibilitySubsystem::CanSee(const AActor* From, const AActor* To)
+{
+    if (!IsValid(From) || !IsValid(To))
+    {
+        return false;
+    }
+
+    // Pairs separated by static geometry never need a trace
+    if (!IsPotentiallyVisible(From->GetActorLocation(), To->GetActorLocation()))
+    {
+        return false;
+    }
+
+    const FPairKey Key(From, To);
+    FPairEntry& Entry = Pairs.FindOrAdd(Key);
+
+    // A pair seen for the first time has no answer to fall back on, trace it once right away
+    if (!Entry.bHasResult)
+    {
+        Entry.bHasResult = true;
+        Entry.bVisible = TraceNow(From, To);
+        Entry.ResultFrame = GFrameCounter;
+        return Entry.bVisible;
+    }
+
+    const uint64 MaxStaleFrames = FMath::Max(CVarBotVisibilityMaxStaleFrames.GetValueOnGameThread(), 0);
+    const bool bIsStale = !Entry.bHasResult || GFrameCounter - Entry.ResultFrame > MaxStaleFrames;
+
+    if (bIsStale && !Entry.bTracePending)
+    {
+        RequestTrace(Key, Entry, From, To);
+    }
+
+    return Entry.bVisible;
+}
+
+bool UBotVisibilitySubsystem::IsPotentiallyVisible(const FVector& From, const FVector& To) const
+{
+    const UBotPVSData* PVS = GetPVSData();
+    return !PVS || PVS->IsPotentiallyVisible(From, To);
+}
+
+const UBotPVSData* UBotVisibilitySubsystem::GetPVSData() const
+{
+    return CVarBotVisibilityUsePVS.GetValueOnGameThread() ? PVSData.Get() : nullptr;
+}
+
+bool UBotVisibilitySubsystem::TraceNow(const AActor* From, const AActor* To) const
+{
+    // Same trace as RequestTrace queues
+    FCollisionQueryParams Params(FName("BotLineTrace"), false);
+    Params.AddIgnoredActor(From);
+    Params.AddIgnoredActor(To);
+
+    return !GetWorld()->LineTraceTestByChannel(From->GetActorLocation(), To->GetActorLocation(), ECC_LOSBlocker, Params);
+}
+
+void UBotVisibilitySubsystem::RequestTrace(const FPairKey& Key, FPairEntry& Entry, const AActor* From, const AActor* To)
+{
+    UBotSceneQuerySubsystem* SceneQueries = UWorld::GetSubsystem<UBotSceneQuerySubsystem>(GetWorld());
+    if (!SceneQueries)
+    {
+        return;
+    }
+
+    // The line of sight channel skips projectiles and pickups, only the level and other bots block it.
+    // Both ends are ignored so the result is the same no matter which bot of the pair asked
+    FBotSceneQueryDesc Desc = FBotSceneQueryDesc::LineTraceByChannel(EAsyncTraceType::Single, From->GetActorLocation(), To->GetActorLocation(),
+        ECC_LOSBlocker, FName("BotLineTrace"));
+    Desc.IgnoreActor(From).IgnoreActor(To);
+
+    // Line of sight decides whether bots can shoot, so it goes ahead of the other bot queries
+    PendingTraces.Emplace(Key, SceneQueries->Request(Desc, EBotSceneQueryPriority::High));
+    Entry.bTracePending = true;
+}
+
+void UBotVisibilitySubsystem::CollectTraceResults()
+{
+    UBotSceneQuerySubsystem* SceneQueries = UWorld::GetSubsystem<UBotSceneQuerySubsystem>(GetWorld());
+    if (!SceneQueries)
+    {
+        return;
+    }
+
+    for (int32 Index = PendingTraces.Num() - 1; Index >= 0; Index--)
+    {
+        TPair<FPairKey, FBotSceneQueryHandle>& PendingTrace = PendingTraces[Index];
+
+        const EBotSceneQueryStatus Status = SceneQueries->GetResult(PendingTrace.Value, TraceHits);
+        if (Status == EBotSceneQueryStatus::Pending)
+        {
+            continue;
+        }
+
+        if (FPairEntry* Entry = Pairs.Find(PendingTrace.Key))
+        {
+            Entry->bTracePending = false;
+
+            // An invalid handle means the result got lost, the next lookup will simply ask again
+            if (Status == EBotSceneQueryStatus::Ready)
+            {
+                bool bBlocked = false;
+                for (const FHitResult& Hit : TraceHits)
+                {
+                    if (Hit.bBlockingHit)
+                    {
+                        bBlocked = true;
+                        break;
+                    }
+                }
+
+                Entry->bHasResult = true;
+                Entry->bVisible = !bBlocked;
+                Entry->ResultFrame = GFrameCounter;
+            }
+        }
+
+        SceneQueries->Release(PendingTrace.Value);
+        PendingTraces.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    }
+}
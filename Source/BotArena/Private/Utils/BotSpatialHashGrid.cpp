@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Utils/BotSpatialHashGrid.h"
+#include "LogBotArena.h"
+
+FBotSpatialHashGrid::FBotSpatialHashGrid(float InCellSize)
+    : CellSize(1.0f)
+    , InvCellSize(1.0f)
+    , NumIds(0)
+{
+    SetCellSize(InCellSize);
+}
+
+void FBotSpatialHashGrid::SetCellSize(float InCellSize)
+{
+    if (NumIds > 0)
+    {
+        UE_LOG(LogBotArena, Warning, TEXT("FBotSpatialHashGrid: Cannot change the cell size of a non empty grid"));
+        return;
+    }
+
+    CellSize = FMath::Max(InCellSize, 1.0f);
+    InvCellSize = 1.0f / CellSize;
+    Cells.Reset();
+}
+
+FIntPoint FBotSpatialHashGrid::GetCellCoord(const FVector& Location) const
+{
+    return FIntPoint(
+        FMath::FloorToInt32(Location.X * InvCellSize),
+        FMath::FloorToInt32(Location.Y * InvCellSize));
+}
+
+void FBotSpatialHashGrid::Add(int32 Id, const FIntPoint& Cell)
+{
+    Cells.FindOrAdd(Cell).Add(Id);
+    NumIds++;
+}
+
+void FBotSpatialHashGrid::Remove(int32 Id, const FIntPoint& Cell)
+{
+    if (TArray<int32>* CellIds = Cells.Find(Cell))
+    {
+        if (CellIds->RemoveSingleSwap(Id, EAllowShrinking::No) > 0)
+        {
+            NumIds--;
+        }
+    }
+}
+
+bool FBotSpatialHashGrid::Move(int32 Id, FIntPoint& InOutCell, const FVector& NewLocation)
+{
+    const FIntPoint NewCell = GetCellCoord(NewLocation);
+    if (NewCell == InOutCell)
+    {
+        return false;
+    }
+
+    Remove(Id, InOutCell);
+    Add(Id, NewCell);
+    InOutCell = NewCell;
+    return true;
+}
+
+void FBotSpatialHashGrid::Reset()
+{
+    Cells.Reset();
+    NumIds = 0;
+}
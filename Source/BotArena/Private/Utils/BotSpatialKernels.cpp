@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Utils/BotSpatialKernels.h"
+#include "Math/VectorRegister.h"
+
+void FBotSpatialKernels::DistanceSquared(const float* Xs, const float* Ys, const float* Zs, int32 Num, const FVector3f& Origin, float* OutDistSquared)
+{
+    const VectorRegister4Float OriginX = VectorSetFloat1(Origin.X);
+    const VectorRegister4Float OriginY = VectorSetFloat1(Origin.Y);
+    const VectorRegister4Float OriginZ = VectorSetFloat1(Origin.Z);
+
+    int32 Index = 0;
+    for (; Index + 4 <= Num; Index += 4)
+    {
+        const VectorRegister4Float DeltaX = VectorSubtract(VectorLoad(Xs + Index), OriginX);
+        const VectorRegister4Float DeltaY = VectorSubtract(VectorLoad(Ys + Index), OriginY);
+        const VectorRegister4Float DeltaZ = VectorSubtract(VectorLoad(Zs + Index), OriginZ);
+
+        VectorRegister4Float DistSquared = VectorMultiply(DeltaX, DeltaX);
+        DistSquared = VectorMultiplyAdd(DeltaY, DeltaY, DistSquared);
+        DistSquared = VectorMultiplyAdd(DeltaZ, DeltaZ, DistSquared);
+
+        VectorStore(DistSquared, OutDistSquared + Index);
+    }
+
+    for (; Index < Num; Index++)
+    {
+        OutDistSquared[Index] = FMath::Square(Xs[Index] - Origin.X) + FMath::Square(Ys[Index] - Origin.Y) + FMath::Square(Zs[Index] - Origin.Z);
+    }
+}
+
+void FBotSpatialKernels::DotDirection(const float* Xs, const float* Ys, const float* Zs, int32 Num, const FVector3f& Origin, const FVector3f& Direction, float* OutDot)
+{
+    const VectorRegister4Float OriginX = VectorSetFloat1(Origin.X);
+    const VectorRegister4Float OriginY = VectorSetFloat1(Origin.Y);
+    const VectorRegister4Float OriginZ = VectorSetFloat1(Origin.Z);
+    const VectorRegister4Float DirectionX = VectorSetFloat1(Direction.X);
+    const VectorRegister4Float DirectionY = VectorSetFloat1(Direction.Y);
+    const VectorRegister4Float DirectionZ = VectorSetFloat1(Direction.Z);
+
+    int32 Index = 0;
+    for (; Index + 4 <= Num; Index += 4)
+    {
+        const VectorRegister4Float DeltaX = VectorSubtract(VectorLoad(Xs + Index), OriginX);
+        const VectorRegister4Float DeltaY = VectorSubtract(VectorLoad(Ys + Index), OriginY);
+        const VectorRegister4Float DeltaZ = VectorSubtract(VectorLoad(Zs + Index), OriginZ);
+
+        VectorRegister4Float Dot = VectorMultiply(DeltaX, DirectionX);
+        Dot = VectorMultiplyAdd(DeltaY, DirectionY, Dot);
+        Dot = VectorMultiplyAdd(DeltaZ, DirectionZ, Dot);
+
+        VectorStore(Dot, OutDot + Index);
+    }
+
+    for (; Index < Num; Index++)
+    {
+        OutDot[Index] = (Xs[Index] - Origin.X) * Direction.X + (Ys[Index] - Origin.Y) * Direction.Y + (Zs[Index] - Origin.Z) * Direction.Z;
+    }
+}
+
+int32 FBotSpatialKernels::FindMinIndex(const float* Values, int32 Num)
+{
+    int32 MinIndex = INDEX_NONE;
+    float MinValue = TNumericLimits<float>::Max();
+
+    for (int32 Index = 0; Index < Num; Index++)
+    {
+        if (Values[Index] < MinValue)
+        {
+            MinValue = Values[Index];
+            MinIndex = Index;
+        }
+    }
+
+    return MinIndex;
+}
+
+void FBotSpatialKernels::Scale(float* Values, int32 Num, float Factor)
+{
+    const VectorRegister4Float FactorVector = VectorSetFloat1(Factor);
+
+    int32 Index = 0;
+    for (; Index + 4 <= Num; Index += 4)
+    {
+        VectorStore(VectorMultiply(VectorLoad(Values + Index), FactorVector), Values + Index);
+    }
+
+    for (; Index < Num; Index++)
+    {
+        Values[Index] *= Factor;
+    }
+}
+
+void FBotSpatialKernels::AddScaled(float* Dst, const float* Src, int32 Num, float Factor)
+{
+    const VectorRegister4Float FactorVector = VectorSetFloat1(Factor);
+
+    int32 Index = 0;
+    for (; Index + 4 <= Num; Index += 4)
+    {
+        VectorStore(VectorMultiplyAdd(VectorLoad(Src + Index), FactorVector, VectorLoad(Dst + Index)), Dst + Index);
+    }
+
+    for (; Index < Num; Index++)
+    {
+        Dst[Index] += Src[Index] * Factor;
+    }
+}
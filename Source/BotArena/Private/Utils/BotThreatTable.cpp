@@ -0,0 +1,188 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Utils/BotThreatTable.h"
+#include "GameFramework/Actor.h"
+
+// A visible threat is worth this many seconds of age
+static constexpr float ThreatVisibleRelevance = 10.f;
+
+// Seconds of age one point of remembered damage is worth
+static constexpr float ThreatDamageRelevance = 0.1f;
+
+bool FBotThreatTable::NoteSighting(AActor* Actor, const FVector& Location, double Time, bool bVisible)
+{
+    if (!Actor)
+    {
+        return false;
+    }
+
+    int32 Index = FindIndex(Actor);
+    const bool bIsNew = Index == INDEX_NONE;
+    if (bIsNew)
+    {
+        // Losing a threat we never knew about teaches nothing
+        if (!bVisible)
+        {
+            return false;
+        }
+
+        Index = AddEntry(Time);
+        Entries[Index].Actor = Actor;
+    }
+
+    FBotThreatEntry& Entry = Entries[Index];
+    const bool bVisibilityChanged = Entry.bVisible != bVisible;
+
+    Entry.LastSeenLocation = Location;
+    Entry.LastSeenTime = Time;
+    Entry.bVisible = bVisible;
+
+    return bIsNew || bVisibilityChanged;
+}
+
+void FBotThreatTable::NoteDamage(AActor* Actor, const FVector& Location, float Damage, double Time)
+{
+    if (!Actor)
+    {
+        return;
+    }
+
+    FBotThreatEntry& Entry = FindOrAddEntry(Actor, Time);
+    Entry.DamageDealt += Damage;
+
+    // A hit tells where a hidden threat is, a visible one is tracked anyway
+    if (!Entry.bVisible)
+    {
+        Entry.LastSeenLocation = Location;
+        Entry.LastSeenTime = Time;
+    }
+}
+
+void FBotThreatTable::NoteHeard(AActor* Actor, const FVector& Location, double Time)
+{
+    if (!Actor)
+    {
+        return;
+    }
+
+    // Noise is less precise than sight, it only updates threats we can't see
+    FBotThreatEntry& Entry = FindOrAddEntry(Actor, Time);
+    if (!Entry.bVisible)
+    {
+        Entry.LastSeenLocation = Location;
+        Entry.LastSeenTime = Time;
+    }
+}
+
+void FBotThreatTable::Update(double Time, float DeltaTime, float ForgetTime, float DamageHalfLife)
+{
+    const float Decay = FMath::Pow(0.5f, DeltaTime / FMath::Max(DamageHalfLife, KINDA_SMALL_NUMBER));
+
+    for (int32 Index = NumEntries - 1; Index >= 0; Index--)
+    {
+        FBotThreatEntry& Entry = Entries[Index];
+
+        const AActor* Actor = Entry.Actor.Get();
+        if (!Actor)
+        {
+            RemoveAt(Index);
+            continue;
+        }
+
+        if (Entry.bVisible)
+        {
+            Entry.LastSeenLocation = Actor->GetActorLocation();
+            Entry.LastSeenTime = Time;
+        }
+        else if (Time - Entry.LastSeenTime > ForgetTime)
+        {
+            RemoveAt(Index);
+            continue;
+        }
+
+        Entry.DamageDealt *= Decay;
+    }
+}
+
+void FBotThreatTable::Reset()
+{
+    for (int32 Index = 0; Index < NumEntries; Index++)
+    {
+        Entries[Index] = FBotThreatEntry();
+    }
+
+    NumEntries = 0;
+}
+
+const FBotThreatEntry* FBotThreatTable::Find(const AActor* Actor) const
+{
+    const int32 Index = FindIndex(Actor);
+    return Index != INDEX_NONE ? &Entries[Index] : nullptr;
+}
+
+int32 FBotThreatTable::FindIndex(const AActor* Actor) const
+{
+    for (int32 Index = 0; Index < NumEntries; Index++)
+    {
+        if (Entries[Index].Actor.Get() == Actor)
+        {
+            return Index;
+        }
+    }
+
+    return INDEX_NONE;
+}
+
+FBotThreatEntry& FBotThreatTable::FindOrAddEntry(AActor* Actor, double Time)
+{
+    int32 Index = FindIndex(Actor);
+    if (Index == INDEX_NONE)
+    {
+        Index = AddEntry(Time);
+        Entries[Index].Actor = Actor;
+    }
+
+    return Entries[Index];
+}
+
+int32 FBotThreatTable::AddEntry(double Time)
+{
+    if (NumEntries < Capacity)
+    {
+        return NumEntries++;
+    }
+
+    int32 LeastRelevantIndex = 0;
+    float LeastRelevance = GetRelevance(Entries[0], Time);
+
+    for (int32 Index = 1; Index < NumEntries; Index++)
+    {
+        const float Relevance = GetRelevance(Entries[Index], Time);
+        if (Relevance < LeastRelevance)
+        {
+            LeastRelevance = Relevance;
+            LeastRelevantIndex = Index;
+        }
+    }
+
+    Entries[LeastRelevantIndex] = FBotThreatEntry();
+    return LeastRelevantIndex;
+}
+
+void FBotThreatTable::RemoveAt(int32 Index)
+{
+    // Keep the entries packed, the order doesn't matter
+    NumEntries--;
+    if (Index != NumEntries)
+    {
+        Entries[Index] = MoveTemp(Entries[NumEntries]);
+    }
+
+    Entries[NumEntries] = FBotThreatEntry();
+}
+
+float FBotThreatTable::GetRelevance(const FBotThreatEntry& Entry, double Time)
+{
+    const float Age = static_cast<float>(Time - Entry.LastSeenTime);
+    return (Entry.bVisible ? ThreatVisibleRelevance : 0.f) + Entry.DamageDealt * ThreatDamageRelevance - Age;
+}
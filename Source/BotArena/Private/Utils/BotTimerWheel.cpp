@@ -0,0 +1,224 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Utils/BotTimerWheel.h"
+
+FBotTimerWheel::FBotTimerWheel(double InTickLength)
+    : TickLength(FMath::Max(InTickLength, UE_KINDA_SMALL_NUMBER))
+{
+    SlotHeads.Init(INDEX_NONE, NumLevels * SlotsPerLevel);
+}
+
+FBotTimerHandle FBotTimerWheel::Schedule(double Delay, TFunction<void()>&& Callback)
+{
+    // The tick in progress fires once the pending time reaches the tick length, count from there
+    constexpr uint64 MaxTicks = (uint64(1) << (SlotBits * NumLevels)) - 1;
+    const double Remaining = Delay - (TickLength - PendingTime);
+    const uint64 Ticks = Remaining > 0.0 ? uint64(FMath::Min(FMath::CeilToDouble(Remaining / TickLength), double(MaxTicks))) : 0;
+
+    int32 NodeIndex = FirstFree;
+    if (NodeIndex != INDEX_NONE)
+    {
+        FirstFree = Nodes[NodeIndex].Next;
+    }
+    else
+    {
+        NodeIndex = Nodes.AddDefaulted();
+    }
+
+    FNode& Node = Nodes[NodeIndex];
+    Node.Callback = MoveTemp(Callback);
+    Node.ExpiryTick = CurrentTick + Ticks;
+    Link(NodeIndex);
+    NumPending++;
+
+    FBotTimerHandle Handle;
+    Handle.Index = NodeIndex;
+    Handle.Serial = Node.Serial;
+    return Handle;
+}
+
+bool FBotTimerWheel::Cancel(FBotTimerHandle& Handle)
+{
+    const bool bPending = IsPending(Handle);
+    if (bPending)
+    {
+        // A timer of the batch being fired is only freed, the batch skips it by its serial
+        if (Nodes[Handle.Index].Slot != FiringSlot)
+        {
+            Unlink(Handle.Index);
+        }
+
+        FreeNode(Handle.Index);
+        NumPending--;
+    }
+
+    Handle.Invalidate();
+    return bPending;
+}
+
+bool FBotTimerWheel::IsPending(const FBotTimerHandle& Handle) const
+{
+    return Nodes.IsValidIndex(Handle.Index) && Nodes[Handle.Index].Serial == Handle.Serial && Nodes[Handle.Index].Slot != INDEX_NONE;
+}
+
+void FBotTimerWheel::Advance(double DeltaTime)
+{
+    PendingTime += FMath::Max(DeltaTime, 0.0);
+
+    // Nothing to cascade or fire, jump straight to the current tick
+    if (NumPending == 0)
+    {
+        const uint64 Ticks = uint64(PendingTime / TickLength);
+        CurrentTick += Ticks;
+        PendingTime -= Ticks * TickLength;
+        return;
+    }
+
+    while (PendingTime >= TickLength)
+    {
+        PendingTime -= TickLength;
+        ProcessTick();
+    }
+}
+
+void FBotTimerWheel::Reset()
+{
+    // Free the nodes instead of dropping them, so handles from before the reset don't match reused nodes
+    for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); NodeIndex++)
+    {
+        if (Nodes[NodeIndex].Slot != INDEX_NONE)
+        {
+            FreeNode(NodeIndex);
+        }
+    }
+
+    for (int32& Head : SlotHeads)
+    {
+        Head = INDEX_NONE;
+    }
+
+    NumPending = 0;
+}
+
+void FBotTimerWheel::Link(int32 NodeIndex)
+{
+    FNode& Node = Nodes[NodeIndex];
+
+    // Timers due already go into the slot processed next
+    const uint64 ExpiryTick = FMath::Max(Node.ExpiryTick, CurrentTick);
+    const uint64 Delta = ExpiryTick - CurrentTick;
+
+    int32 Level = 0;
+    while (Level < NumLevels - 1 && Delta >= (uint64(1) << (SlotBits * (Level + 1))))
+    {
+        Level++;
+    }
+
+    const int32 Slot = Level * SlotsPerLevel + int32((ExpiryTick >> (SlotBits * Level)) & (SlotsPerLevel - 1));
+
+    Node.Slot = Slot;
+    Node.Prev = INDEX_NONE;
+    Node.Next = SlotHeads[Slot];
+    if (Node.Next != INDEX_NONE)
+    {
+        Nodes[Node.Next].Prev = NodeIndex;
+    }
+    SlotHeads[Slot] = NodeIndex;
+}
+
+void FBotTimerWheel::Unlink(int32 NodeIndex)
+{
+    FNode& Node = Nodes[NodeIndex];
+
+    if (Node.Prev != INDEX_NONE)
+    {
+        Nodes[Node.Prev].Next = Node.Next;
+    }
+    else
+    {
+        SlotHeads[Node.Slot] = Node.Next;
+    }
+
+    if (Node.Next != INDEX_NONE)
+    {
+        Nodes[Node.Next].Prev = Node.Prev;
+    }
+
+    Node.Prev = INDEX_NONE;
+    Node.Next = INDEX_NONE;
+}
+
+void FBotTimerWheel::FreeNode(int32 NodeIndex)
+{
+    FNode& Node = Nodes[NodeIndex];
+    Node.Callback.Reset();
+    Node.Slot = INDEX_NONE;
+    Node.Serial++;
+    Node.Prev = INDEX_NONE;
+    Node.Next = FirstFree;
+    FirstFree = NodeIndex;
+}
+
+int32 FBotTimerWheel::Cascade(int32 Level)
+{
+    const int32 Index = int32((CurrentTick >> (SlotBits * Level)) & (SlotsPerLevel - 1));
+    const int32 Slot = Level * SlotsPerLevel + Index;
+
+    int32 NodeIndex = SlotHeads[Slot];
+    SlotHeads[Slot] = INDEX_NONE;
+
+    while (NodeIndex != INDEX_NONE)
+    {
+        const int32 Next = Nodes[NodeIndex].Next;
+        Link(NodeIndex);
+        NodeIndex = Next;
+    }
+
+    return Index;
+}
+
+void FBotTimerWheel::ProcessTick()
+{
+    const int32 Index = int32(CurrentTick & (SlotsPerLevel - 1));
+
+    // Level 0 wrapped around, bring the next span of every level that wrapped as well one level down
+    if (Index == 0)
+    {
+        for (int32 Level = 1; Level < NumLevels && Cascade(Level) == 0; Level++)
+        {
+        }
+    }
+
+    // Detach the due slot first, callbacks scheduling new timers land in later ticks
+    int32 NodeIndex = SlotHeads[Index];
+    SlotHeads[Index] = INDEX_NONE;
+    CurrentTick++;
+
+    while (NodeIndex != INDEX_NONE)
+    {
+        FNode& Node = Nodes[NodeIndex];
+        Node.Slot = FiringSlot;
+        FiringBatch.Emplace(NodeIndex, Node.Serial);
+        NodeIndex = Node.Next;
+    }
+
+    for (const TPair<int32, uint32>& Entry : FiringBatch)
+    {
+        // Skip timers cancelled by an earlier callback of the batch
+        if (Nodes[Entry.Key].Serial != Entry.Value)
+        {
+            continue;
+        }
+
+        TFunction<void()> Callback = MoveTemp(Nodes[Entry.Key].Callback);
+        FreeNode(Entry.Key);
+        NumPending--;
+
+        if (Callback)
+        {
+            Callback();
+        }
+    }
+
+    FiringBatch.Reset();
+}
@@ -9,6 +9,7 @@
 /**
  * Searches for nearby Ammo Boxes in the area and updates the corresponding Blackboard values
  * Should probably rename this later on since its name is misleading
+ * The closest box nobody else is heading to is picked from the ammo registry and reserved for this bot
  */
 UCLASS()
 class BOTARENA_API UBTTask_CollectAmmo : public UBTTaskNode
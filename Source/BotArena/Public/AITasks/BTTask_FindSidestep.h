@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BTTaskNode.h"
+#include "BTTask_FindSidestep.generated.h"
+
+struct FBTFindSidestepMemory
+{
+	/* The request queued in UBotSidestepSubsystem */
+	uint32 RequestId;
+};
+
+/**
+ * Finds a location to sidestep to while shooting at the selected target and stores it in the blackboard
+ * Replaces running the EQ_NearbyPoints query: the candidates are generated and scored on a worker task by UBotSidestepSubsystem
+ * and only the final pick is made on the game thread, so bots keep dodging when the EQS manager is busy
+ * BT_Bot still runs EQ_NearbyPoints, whose generator shortlists its points with the same scoring, see UEQG_NearbyPoints
+ */
+UCLASS(Meta=(DisplayName="Find Sidestep C++"))
+class BOTARENA_API UBTTask_FindSidestep : public UBTTaskNode
+{
+	GENERATED_BODY()
+
+public:
+
+	UBTTask_FindSidestep(const FObjectInitializer& ObjectInitializer);
+
+	virtual uint16 GetInstanceMemorySize() const override;
+
+	virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+
+protected:
+
+	/*
+	 * Queues the sidestep search when we have reached the node
+	 */
+	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+	/*
+	 * Polls the sidestep search and finishes the task once its result is committed
+	 */
+	virtual void TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+
+	/*
+	 * Drops the pending search when the task gets aborted
+	 */
+	virtual EBTNodeResult::Type AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+	/* The blackboard key that receives the sidestep location */
+	UPROPERTY(EditAnywhere, Category = Blackboard)
+	FBlackboardKeySelector SidestepLocationKey;
+
+	/* The distance between each point of the same Angle */
+	UPROPERTY(EditAnywhere, Category = NearbyPoints)
+	float PointsDistance = 150.f;
+
+	/* The gap of points that will NOT be generated in front of the character */
+	UPROPERTY(EditAnywhere, Category = NearbyPoints)
+	float DegreesGap = 60.f;
+
+	/* Angle Step is the step that the angles increase. A small value means that more item will get generated */
+	UPROPERTY(EditAnywhere, Category = NearbyPoints)
+	float AngleStep = 20.f;
+
+	/* The max range of our nearby points */
+	UPROPERTY(EditAnywhere, Category = NearbyPoints)
+	float MaxRange = 500.f;
+
+	/* Points closer than this to an ally are less likely to be picked */
+	UPROPERTY(EditAnywhere, Category = NearbyPoints)
+	float AllySpacing = 200.f;
+};
@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "Components/BotTeamComponent.h"
+#include "Perception/AISightTargetInterface.h"
+#include "GenericTeamAgentInterface.h"
 #include "AICharacter.generated.h"
 
 // Forward declarations
@@ -13,7 +15,7 @@ class UBotWeaponComponent;
 class UBotMovementComponent;
 
 UCLASS()
-class BOTARENA_API AAICharacter : public ACharacter
+class BOTARENA_API AAICharacter : public ACharacter, public IAISightTargetInterface, public IGenericTeamAgentInterface
 {
     GENERATED_BODY()
     
@@ -24,8 +26,8 @@ public:
     // Called when the game starts or when spawned
     virtual void BeginPlay() override;
     
-    // Called every frame
-    virtual void Tick(float DeltaTime) override;
+    // Called when the bot is removed from the level
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
     
     // Called to bind functionality to input
     virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
@@ -40,6 +42,14 @@ public:
     UFUNCTION(BlueprintImplementableEvent, BlueprintCallable, Category = "BotArena")
     void AssignTeam(ETeam NewTeam);
 
+    // Sight sense visibility test, rejects observers the baked PVS marks as not visible before tracing
+    virtual UAISense_Sight::EVisibilityResult CanBeSeenFrom(const FCanBeSeenFromContext& Context, FVector& OutSeenLocation, int32& OutNumberOfLoSChecksPerformed,
+        int32& OutNumberOfAsyncLosCheckRequested, float& OutSightStrength, int32* UserData = nullptr, const FOnPendingVisibilityQueryProcessedDelegate* Delegate = nullptr) override;
+
+    // Team of the bot as seen by the perception system, the ETeam value of the team component
+    virtual void SetGenericTeamId(const FGenericTeamId& NewTeamID) override;
+    virtual FGenericTeamId GetGenericTeamId() const override;
+
 protected:
     // Health component
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
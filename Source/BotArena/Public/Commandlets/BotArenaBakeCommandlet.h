@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "BotArenaBakeCommandlet.generated.h"
+
+/**
+ * Base class for the commandlets that precompute AI data from the static geometry of a map.
+ * Takes care of loading the map with collision enabled and of saving the resulting asset.
+ * Usage: UnrealEditor-Cmd.exe BotArena.uproject -run=<Commandlet> -Map=/Game/Maps/TestBed
+ */
+UCLASS(Abstract)
+class BOTARENA_API UBotArenaBakeCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UBotArenaBakeCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+
+protected:
+    // Bakes the data of the loaded world. Returns the process exit code
+    virtual int32 Bake(UWorld& World, const FString& Params) { return 1; }
+
+    // Loads the map and initializes it so that scene queries work
+    UWorld* LoadWorld(const FString& MapPackageName) const;
+
+    // Tears down a world returned by LoadWorld
+    void UnloadWorld(UWorld* World) const;
+
+    // Creates the asset in a new package, replacing any previous asset with the same name
+    template<typename AssetType>
+    AssetType* CreateAsset(const FString& PackageName) const
+    {
+        UPackage* Package = CreatePackage(*PackageName);
+        Package->FullyLoad();
+        return NewObject<AssetType>(Package, *FPackageName::GetShortName(PackageName), RF_Public | RF_Standalone);
+    }
+
+    // Saves the package of the asset to disk
+    bool SaveAsset(UObject* Asset) const;
+
+    // The map used when none is given on the command line
+    FString DefaultMap = TEXT("/Game/Maps/TestBed");
+};
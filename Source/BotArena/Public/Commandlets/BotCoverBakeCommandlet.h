@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/BotArenaBakeCommandlet.h"
+#include "BotCoverBakeCommandlet.generated.h"
+
+struct FBotCoverPoint;
+
+/**
+ * Bakes the cover points of a map into a UBotCoverData asset (see UBotCoverData::GetPackageNameForMap).
+ * The nav mesh bounds volumes of the map are sampled on a regular grid, every floor of every sample is found with downward traces
+ * and the samples standing next to a wall tall enough to hide a crouching bot become cover points.
+ * Usage: UnrealEditor-Cmd.exe BotArena.uproject -run=BotCoverBake -Map=/Game/Maps/TestBed [-Spacing=100] [-CoverHeight=90] [-ExposureRange=1500]
+ */
+UCLASS()
+class BOTARENA_API UBotCoverBakeCommandlet : public UBotArenaBakeCommandlet
+{
+    GENERATED_BODY()
+
+protected:
+    virtual int32 Bake(UWorld& World, const FString& Params) override;
+
+    // Finds every floor below the given XY location, top to bottom
+    void FindFloors(UWorld& World, const FVector2D& Location, const FBox& Bounds, TArray<float>& OutFloorZ) const;
+
+    // Turns a floor sample into a cover point. Returns false if there's no wall close enough
+    bool MakeCoverPoint(UWorld& World, const FVector& FloorLocation, FBotCoverPoint& OutPoint) const;
+
+    // Distance between two samples on the XY plane
+    float Spacing = 100.f;
+
+    // Height above the floor a wall has to reach to count as cover
+    float CoverHeight = 90.f;
+
+    // Length of the rays testing the exposure of a point in every direction
+    float ExposureRange = 1500.f;
+
+    // How far from a sample the wall giving it cover may be
+    float WallDistance = 75.f;
+};
@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/BotArenaBakeCommandlet.h"
+#include "BotPVSBakeCommandlet.generated.h"
+
+class UBotPVSData;
+
+/**
+ * Bakes the potentially visible set of a map into a UBotPVSData asset (see UBotPVSData::GetPackageNameForMap).
+ * The nav mesh bounds volumes of the map are split into cells, the floor of every cell is found with a downward trace
+ * and every pair of cells is tested with line traces against the static geometry between sample points at the center,
+ * corners and edge middles of both cells, at several heights from a crouching to a standing bot. A pair is only marked as
+ * not visible when every one of these lines is blocked. A sightline squeezing between the samples, e.g. through a narrow
+ * gap, can still be missed and rejected at runtime. Lower the cell size to make that less likely.
+ * Usage: UnrealEditor-Cmd.exe BotArena.uproject -run=BotPVSBake -Map=/Game/Maps/TestBed [-CellSize=400] [-SampleHeights=40,90,160]
+ */
+UCLASS()
+class BOTARENA_API UBotPVSBakeCommandlet : public UBotArenaBakeCommandlet
+{
+    GENERATED_BODY()
+
+protected:
+    virtual int32 Bake(UWorld& World, const FString& Params) override;
+
+    // Finds the floor of every cell. Cells without a single reachable floor are marked as seeing everything
+    void FindCellFloors(UWorld& World, UBotPVSData& PVS, const FBox& Bounds, TArray<float>& OutFloorZ) const;
+
+    // Tests the sample points of both cells against each other
+    bool CanCellsSee(UWorld& World, const UBotPVSData& PVS, int32 CellA, int32 CellB, const TArray<float>& FloorZ) const;
+
+    // Size of a cell on the XY plane
+    float CellSize = 400.f;
+
+    // Heights above the floor of the points used to test the visibility, from a crouching bot's eyes to a standing one's
+    TArray<float> SampleHeights = { 40.f, 90.f, 160.f };
+};
@@ -33,6 +33,11 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Behavior")
     void InitiateRetreat();
     
+    // Initiate retreat towards the best cover against the given threat location.
+    // The cover is written to the MoveLocation key the tree moves to, and to the RetreatLocation key when the blackboard has one
+    UFUNCTION(BlueprintCallable, Category = "Behavior")
+    void InitiateRetreatFrom(const FVector& ThreatLocation);
+    
     // Set collect ammo status
     UFUNCTION(BlueprintCallable, Category = "Behavior")
     void SetCollectAmmoStatus(bool NewStatus);
@@ -56,6 +61,9 @@ protected:
     UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Behavior|Blackboard")
     FName BlackboardKey_ShouldRetreat;
     
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Behavior|Blackboard")
+    FName BlackboardKey_RetreatLocation;
+    
     UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Behavior|Blackboard")
     FName BlackboardKey_CollectAmmo;
     
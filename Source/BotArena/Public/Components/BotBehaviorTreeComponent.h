@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "BotBehaviorTreeComponent.generated.h"
+
+/**
+ * The brain of a bot: a behavior tree component that updates on the frames of its UBotBrainSchedulerSubsystem bucket
+ * instead of every frame, unless it got promoted by combat or damage.
+ * Only updates the tree asks for on the next frame are sliced. A tree waiting on a tick interval of its own, or not
+ * ticking at all while its tasks are latent, is left alone.
+ */
+UCLASS(ClassGroup=(BotArena))
+class BOTARENA_API UBotBehaviorTreeComponent : public UBehaviorTreeComponent
+{
+    GENERATED_BODY()
+
+public:
+    // Called when the game starts
+    virtual void BeginPlay() override;
+    
+    // Called when the component is removed from play
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    
+    // Called every frame the tree wants an update, skips the frames of the other buckets
+    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+    
+    // Update every frame for at least the given number of seconds
+    void PromoteFor(float Duration);
+    
+    // Check if the brain currently ignores its bucket
+    bool IsPromoted() const;
+
+protected:
+    // Bucket assigned by the scheduler, INDEX_NONE when not registered
+    int32 Bucket = INDEX_NONE;
+    
+    // World time until which the brain updates every frame
+    double PromotedUntil = 0.0;
+    
+    // Time of the frames skipped since the last update, handed to the tree when it updates
+    float SkippedDeltaTime = 0.0f;
+};
@@ -16,9 +16,6 @@ public:
 
     // Called when the game starts
     virtual void BeginPlay() override;
-    
-    // Called every frame
-    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
 protected:
     // Initialize the component with its owner
@@ -42,6 +42,10 @@ public:
     UFUNCTION(BlueprintPure, Category = "Health")
     bool ShouldRetreat() const;
     
+    // Get the world time of the last damage taken, negative if the bot was never hit
+    UFUNCTION(BlueprintPure, Category = "Health")
+    float GetLastDamageTime() const { return LastDamageTime; }
+    
     // Health changed delegate
     UPROPERTY(BlueprintAssignable, Category = "Health")
     FOnHealthChangedSignature OnHealthChanged;
@@ -70,4 +74,7 @@ protected:
     // Delay before destroying the actor after death
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Health")
     float DestroyActorDelay;
+    
+    // World time of the last damage taken
+    float LastDamageTime;
 };
\ No newline at end of file
@@ -17,7 +17,10 @@ public:
     // Called when the game starts
     virtual void BeginPlay() override;
     
-    // Called every frame
+    // Called when the component is removed from play
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    
+    // Called every frame, unless UBotTickManagerSubsystem drives the component
     virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
     
     // Initialize movement
@@ -27,6 +30,16 @@ public:
     // Get path following component
     UFUNCTION(BlueprintPure, Category = "Movement")
     class UBotPathFollowingComponent* GetPathFollowingComponent() const { return BotPathFollowingComp; }
+    
+    // Adjust mesh for crouch
+    UFUNCTION(BlueprintCallable, Category = "Movement")
+    void AdjustMeshForCrouch();
+    
+    // Stops or resumes the movement updates of an idle bot, driven by UBotDormancySubsystem
+    void SetDormant(bool bInDormant);
+    
+    // Check if the movement updates are stopped
+    bool IsDormant() const { return bDormant; }
 
 protected:
     // Path following component
@@ -37,7 +50,6 @@ protected:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement")
     FVector MeshCrouchAdjustLocation;
     
-    // Adjust mesh for crouch
-    UFUNCTION(BlueprintCallable, Category = "Movement")
-    void AdjustMeshForCrouch();
+    // Set while the bot is dormant
+    bool bDormant = false;
 };
\ No newline at end of file
@@ -4,7 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "Components/BotCoreComponent.h"
-#include "HAL/CriticalSection.h"
+#include "Containers/TripleBuffer.h"
+#include "Utils/BotThreatTable.h"
 #include "BotPerceptionComponent.generated.h"
 
 // Delegate for target selected events
@@ -21,9 +22,21 @@ public:
     // Called when the game starts
     virtual void BeginPlay() override;
     
-    // Called every frame
+    // Called when the component is removed from play
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    
+    // Called every frame, unless UBotTickManagerSubsystem drives the component
     virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
     
+    // Sense phase: takes in the latest perception update and refreshes the threat table
+    void SenseTick(float DeltaTime);
+    
+    // Think phase: selects a target when the per bot selection is used
+    void ThinkTick();
+    
+    // Act phase: turns the bot towards its target
+    void ActTick(float DeltaTime);
+    
     // Initialize perception
     UFUNCTION(BlueprintCallable, Category = "Perception")
     void InitializePerception();
@@ -43,19 +56,68 @@ public:
     // Target selected delegate
     UPROPERTY(BlueprintAssignable, Category = "Perception")
     FOnTargetSelectedSignature OnTargetSelected;
+    
+    // Writes a newly selected target to the blackboard, resets the selection timer and broadcasts OnTargetSelected
+    void ApplySelectedTarget(AActor* NewTarget, float Distance);
+    
+    // Restarts the target selection interval without changing the current target
+    void ResetTargetSelectionTimer();
+    
+    // Check if the selection interval has expired
+    bool IsTargetSelectionIntervalExpired() const { return GetTimeSinceTargetSelection() >= GetEffectiveSelectTargetInterval(); }
+    
+    /**
+     * Scales the cost of this bot's perception, driven by UBotSignificanceSubsystem
+     * @param TickInterval - The tick interval of the component, 0 to tick every frame
+     * @param InSelectTargetIntervalScale - Factor applied to SelectTargetInterval
+     */
+    void SetPerceptionLOD(float TickInterval, float InSelectTargetIntervalScale);
+    
+    // Get the target selection interval scaled by the perception LOD
+    float GetEffectiveSelectTargetInterval() const { return SelectTargetInterval * SelectTargetIntervalScale; }
+    
+    // Get the seconds since the target was last selected
+    float GetTimeSinceTargetSelection() const;
+    
+    // Get the threats this bot remembers. The visible ones are the target candidates
+    const FBotThreatTable& GetThreatTable() const { return ThreatTable; }
+    
+    // Remember the damage dealt by an attacker, even if it isn't sensed
+    void NoteDamageFrom(AActor* Attacker, float Damage);
+    
+    // Remember where gunfire of a hostile was heard, even if it isn't sensed
+    void NoteGunfireFrom(AActor* Shooter, const FVector& Location);
+    
+    // Check if a threat appeared or its visibility changed since the candidates were last evaluated (batched target selection only)
+    bool HaveTargetCandidatesChanged() const { return bTargetCandidatesChanged; }
+    
+    // Ask for the target candidates to be evaluated again, e.g. because a teammate spotted a new enemy
+    void MarkTargetCandidatesChanged() { bTargetCandidatesChanged = true; }
+    
+    // Mark the current target candidates as evaluated
+    void MarkTargetCandidatesEvaluated() { bTargetCandidatesChanged = false; }
+    
+    // Stops or resumes the perception updates of an idle bot, driven by UBotDormancySubsystem
+    void SetDormant(bool bInDormant);
+    
+    // Check if the perception updates are stopped
+    bool IsDormant() const { return bDormant; }
 
 protected:
     // Perception component reference
     UPROPERTY(Transient)
     class UAIPerceptionComponent* PerceptionComp;
     
-    // Time since target selection
-    float TimeSinceTargetSelection;
+    // World time of the last target selection
+    double TargetSelectionTime;
     
     // Target selection interval
     UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Perception")
     float SelectTargetInterval;
     
+    // Factor applied to SelectTargetInterval by the perception LOD
+    float SelectTargetIntervalScale = 1.0f;
+    
     // Target rotation speed
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Perception")
     float SelectTargetRotationSpeed;
@@ -64,10 +126,33 @@ protected:
     UFUNCTION()
     void OnPerceptionUpdated(const TArray<AActor*>& SensedActors);
     
-    // Thread safety for perception updates
-    FCriticalSection PerceptionLock;
-    TArray<AActor*> PendingSensedActors;
-    bool bHasPendingPerceptionUpdate = false;
+    // Lock free handoff of the perception updates: the update handler fills the write slot and publishes it,
+    // the tick swaps the read slot in. Both sides reuse the slot allocations, nothing is copied twice
+    TTripleBuffer<TArray<TWeakObjectPtr<AActor>>> SensedActorsBuffer;
+    
+    // Folds the latest perception update into the threat table
+    void ProcessSensedActors();
+    
+    // Adds the enemies seen by teammates nearby to a target list
+    void AppendSquadTargets(TArray<AActor*>& TargetList) const;
+    
+    // Lets the bot's behavior tree update every frame for a while, because the bot is fighting
+    void PromoteBrain();
+    
+    // Threats remembered across perception updates, target selection works from the visible ones
+    FBotThreatTable ThreatTable;
+    
+    // Set when the visible threats changed and the batched target selection pass hasn't looked at them yet
+    bool bTargetCandidatesChanged = false;
+    
+    // Set while the bot is dormant
+    bool bDormant = false;
+    
+    // The sight sense picked at initialization, switched off while the bot is dormant
+    TSubclassOf<class UAISense> ActiveSightSense;
+    
+    // Reused buffer for the per bot selection path, which takes raw pointers
+    TArray<AActor*> SelectTargetScratch;
     
     // Debug visualization
     UFUNCTION()
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Components/BotCoreComponent.h"
+#include "Utils/BotTimerWheel.h"
 #include "BotWeaponComponent.generated.h"
 
 // Delegate for weapon fired events
@@ -22,8 +23,8 @@ public:
     // Called when the game starts
     virtual void BeginPlay() override;
     
-    // Called every frame
-    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+    // Called when the component is removed from play
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
     
     // Fire the weapon
     UFUNCTION(BlueprintCallable, Category = "Weapon")
@@ -82,13 +83,19 @@ protected:
     UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Weapon")
     float DeactivateParticleDelay;
     
-    // Time since last fire
-    float LastFireWeaponTime;
+    // World time of the last shot
+    double LastFireWeaponTime;
+    
+    // Turns the muzzle effect off once it has played
+    FBotTimerHandle DeactivateParticleTimer;
     
     // Deactivate fire weapon particle
     UFUNCTION(BlueprintCallable, Category = "Weapon")
     void DeactivateFireWeaponParticle();
     
+    // Wakes the bot up if the ammo crossed the low ammo threshold
+    void NotifyAmmoThreshold(int32 OldAmmo);
+    
     // Low ammo threshold
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon")
     int32 LowAmmoThreshold;
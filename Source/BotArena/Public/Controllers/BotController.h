@@ -5,11 +5,13 @@
 #include "CoreMinimal.h"
 #include "AIController.h"
 #include "BehaviorTree/BehaviorTree.h"
+#include "Components/BotTeamComponent.h"
 #include "BotController.generated.h"
 
 // Forward declarations
 class UBotPerceptionComponent;
 class UBotBehaviorComponent;
+class UBotBehaviorTreeComponent;
 class UBotPathFollowingComponent;
 class UAIPerceptionComponent;
 class UAIPerceptionStimuliSourceComponent;
@@ -26,9 +28,6 @@ public:
     // Called when the game starts
     virtual void BeginPlay() override;
     
-    // Called every frame
-    virtual void Tick(float DeltaTime) override;
-    
     // Called when possessing a pawn
     virtual void OnPossess(APawn* InPawn) override;
     
@@ -54,10 +53,17 @@ public:
     UFUNCTION(BlueprintCallable, Category = "BotArena")
     void InitiateRetreat();
     
+    UFUNCTION(BlueprintCallable, Category = "BotArena")
+    void InitiateRetreatFrom(const FVector& ThreatLocation);
+    
     UFUNCTION(BlueprintCallable, Category = "BotArena")
     void SetCollectAmmoStatus(bool NewStatus);
 
 protected:
+    // Keeps the team id of the controller, which the perception system reads for the listener, in sync with the pawn
+    UFUNCTION()
+    void OnPawnTeamChanged(ETeam NewTeam);
+    
     // Perception component
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
     class UBotPerceptionComponent* BotPerceptionComponent;
@@ -66,6 +72,10 @@ protected:
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
     class UBotBehaviorComponent* BotBehaviorComponent;
     
+    // Time sliced behavior tree component, used as the brain component
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+    class UBotBehaviorTreeComponent* BotBehaviorTreeComp;
+    
     // The custom path following component (kept for compatibility)
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
     class UBotPathFollowingComponent* BotPathFollowingComp;
@@ -85,4 +95,7 @@ public:
     
     UFUNCTION(BlueprintPure, Category = "Components")
     class UBotBehaviorComponent* GetBotBehaviorComponent() const { return BotBehaviorComponent; }
+    
+    UFUNCTION(BlueprintPure, Category = "Components")
+    class UBotBehaviorTreeComponent* GetBotBehaviorTreeComponent() const { return BotBehaviorTreeComp; }
 };
\ No newline at end of file
@@ -6,10 +6,14 @@
 #include "EnvironmentQuery/EnvQueryContext.h"
 #include "EQC_FindAllyBots.generated.h"
 
+class AAICharacter;
+
 /**
  * This was initially created to implement an avoidance functionality via EQS for bots
  * This is an inefficient way of dealing with the mentioned problem.
  * This class is deprecated and we're currently using the default RVO avoidance which is built-in the CharacterMovementComponent
+ * Allies are read from the per team buckets of the bot registry, no physics query is involved
+ * Team mates standing in the same cell share the registry result through the EQS result cache and only filter it by distance
  */
 //UCLASS(Deprecated, meta=(DeprecationMessage="See comments above the class declaration"))
 UCLASS()
@@ -21,10 +25,15 @@ class BOTARENA_API UEQC_FindAllyBots : public UEnvQueryContext
 	virtual void ProvideContext(FEnvQueryInstance& QueryInstance, FEnvQueryContextData& ContextData) const override;
 	
 
+protected:
+
+	/* Allies further than this from the querier aren't included */
+	UPROPERTY(EditDefaultsOnly, Category = "Context")
+	float AllySearchRadius = 350.f;
+
 private:
 
-	/**
-	 * Checks if already have included the given actor in the trace
-	 */
-	bool AlreadyTracedActor(const TArray<AActor*>& TracedActors, const AActor& ActorToCheck) const;
+	/* Output buffers reused across evaluations. Contexts are evaluated on the default object, one at a time */
+	mutable TArray<AAICharacter*> AllyBotsBuffer;
+	mutable TArray<AActor*> AllyActorsBuffer;
 };
@@ -6,11 +6,19 @@
 #include "EnvironmentQuery/Generators/EnvQueryGenerator_ProjectedPoints.h"
 #include "EQG_NearbyPoints.generated.h"
 
+struct FBotRingTemplate;
+
 /**
  * A custom EQS generator that creates point in a cone-like fashion everywhere except in front of the bot
  * This generator (in addition with a few in-editor tests) is used to perform a sidestep functionality
  * while the bots are shooting at each other.
  * Place an EQS testing pawn in the level and assign this generator to its EQS template to showcase the resulting points
+ * The ring of points comes from a template cached in UBotEQSSubsystem, which also caches the nav projections
+ * With the EQS result cache on, the ring is centered on a small cell and turned to a heading step instead of the exact
+ * bot location and facing, and the projected ring is cached per cell, heading, team and projection settings.
+ * A bot querying again from the same spot, or a squad mate standing right there, reuses it. The EQS tests still run for every query
+ * Bots with a target only hand the best few points by UBotSidestepSubsystem's sidestep score over to the query tests,
+ * which still make the final pick. BotArena.Sidestep.NearbyPointsShortlist sets how many, 0 hands them all over
  */
 UCLASS()
 class BOTARENA_API UEQG_NearbyPoints : public UEnvQueryGenerator_ProjectedPoints
@@ -19,6 +27,12 @@ class BOTARENA_API UEQG_NearbyPoints : public UEnvQueryGenerator_ProjectedPoints
 
 	virtual void GenerateItems(FEnvQueryInstance& QueryInstance) const override;
 
+	/* Fills LocationCandidates with the given ring around a location, facing the given way, and projects them */
+	void GenerateProjectedRing(FEnvQueryInstance& QueryInstance, AActor& AIPawn, const FVector& PawnLocation, const FVector& PawnForwardVector, const FBotRingTemplate& Ring) const;
+
+	/* Keeps the best sidestep candidates of LocationCandidates for a bot that is fighting */
+	void ShortlistSidesteps(const AActor& AIPawn) const;
+
 	/* The distance between each point of the same Angle */
 	UPROPERTY(EditAnywhere, Category = NearbyPoints)
 	float PointsDistance = 150.f;
@@ -34,4 +48,11 @@ class BOTARENA_API UEQG_NearbyPoints : public UEnvQueryGenerator_ProjectedPoints
 	/* The max range of our nearby points */
 	UPROPERTY(EditAnywhere, Category = NearbyPoints)
 	float MaxRange = 500.f;
+
+	/* Points closer than this to an ally are less likely to be shortlisted */
+	UPROPERTY(EditAnywhere, Category = NearbyPoints)
+	float AllySpacing = 200.f;
+
+	/* Candidate buffer reused across queries. Generators run on the game thread, one at a time */
+	mutable TArray<FNavLocation> LocationCandidates;
 };
@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Templates/Function.h"
+#include "BotCoverData.generated.h"
+
+/**
+ * A spot next to static geometry that hides a bot from some directions
+ */
+USTRUCT()
+struct BOTARENA_API FBotCoverPoint
+{
+    GENERATED_BODY()
+
+    // The number of directions of the exposure mask, evenly spread around the up axis starting at +X
+    static constexpr int32 NumDirections = 16;
+
+    UPROPERTY()
+    FVector3f Location = FVector3f::ZeroVector;
+
+    // Points away from the geometry giving cover
+    UPROPERTY()
+    FVector3f Normal = FVector3f::ZeroVector;
+
+    // Bit N is set when the point is exposed to threats coming from direction N
+    UPROPERTY()
+    uint16 ExposureMask = 0;
+
+    // Get the direction index closest to the given direction
+    static int32 GetDirectionIndex(const FVector& Direction);
+
+    bool IsExposedFrom(int32 DirectionIndex) const { return (ExposureMask & (1u << DirectionIndex)) != 0; }
+};
+
+/**
+ * Cover points of a map, baked by UBotCoverBakeCommandlet.
+ * Points are sorted by the XY cell they stand in so that a query only visits the cells around the bot.
+ */
+UCLASS()
+class BOTARENA_API UBotCoverData : public UDataAsset
+{
+    GENERATED_BODY()
+
+public:
+    // Get the package the cover of the given map is baked to, for example /Game/AI/Cover/Cover_TestBed
+    static FString GetPackageNameForMap(const FString& MapName);
+
+    // Replaces the points and rebuilds the cell index
+    void SetPoints(TArray<FBotCoverPoint>&& InPoints, const FVector& InOrigin, float InCellSize, const FIntPoint& InDimensions);
+
+    /**
+     * Finds the best cover against a threat
+     * @param BotLocation - Where the bot stands
+     * @param ThreatLocation - Where the danger comes from
+     * @param MaxDistance - Points further than this from the bot are ignored
+     * @param GetPenalty - Extra cost of a point, subtracted from its score
+     * @param OutPoint - Receives the best point
+     * @return False if no point within MaxDistance hides the bot from the threat
+     */
+    bool FindBestCover(const FVector& BotLocation, const FVector& ThreatLocation, float MaxDistance, TFunctionRef<float(const FVector&)> GetPenalty, FBotCoverPoint& OutPoint) const;
+
+    int32 GetNumPoints() const { return Points.Num(); }
+
+protected:
+    // Get the cell of a location, clamped to the grid
+    FIntPoint GetCell(const FVector& Location) const;
+
+    // The minimum corner of the grid
+    UPROPERTY(VisibleAnywhere, Category = "Cover")
+    FVector Origin = FVector::ZeroVector;
+
+    UPROPERTY(VisibleAnywhere, Category = "Cover")
+    float CellSize = 0.f;
+
+    // Number of cells along X and Y
+    UPROPERTY(VisibleAnywhere, Category = "Cover")
+    FIntPoint Dimensions = FIntPoint::ZeroValue;
+
+    // Sorted by cell, row major
+    UPROPERTY()
+    TArray<FBotCoverPoint> Points;
+
+    // The points of cell N are Points[CellStart[N]] to Points[CellStart[N + 1] - 1]
+    UPROPERTY()
+    TArray<int32> CellStart;
+};
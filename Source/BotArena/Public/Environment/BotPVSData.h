@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "BotPVSData.generated.h"
+
+/**
+ * Potentially visible set of a map, baked by UBotPVSBakeCommandlet.
+ * The nav area is split into square cells on the XY plane and every pair of cells stores one bit telling if
+ * any point of the first cell may see any point of the second one through the static geometry, as far as the sample
+ * points of the bake can tell (see UBotPVSBakeCommandlet).
+ * Cells that couldn't be baked reliably (no floor, several floors on top of each other) see everything.
+ */
+UCLASS()
+class BOTARENA_API UBotPVSData : public UDataAsset
+{
+    GENERATED_BODY()
+
+public:
+    // Get the package the PVS of the given map is baked to, for example /Game/AI/PVS/PVS_TestBed
+    static FString GetPackageNameForMap(const FString& MapName);
+
+    // Sets up an empty grid where no cell sees any other cell
+    void InitializeGrid(const FVector& InOrigin, float InCellSize, const FIntPoint& InDimensions);
+
+    // Marks both cells as seeing each other
+    void SetCellsVisible(int32 CellA, int32 CellB);
+
+    // Marks the cell as seeing and being seen by every cell
+    void SetCellVisibleFromEverywhere(int32 Cell);
+
+    // Get the cell containing the location, INDEX_NONE when the location is outside of the grid
+    int32 GetCellIndex(const FVector& Location) const;
+
+    // Get the center of the cell on the XY plane
+    FVector2D GetCellCenter(int32 Cell) const;
+
+    // Checks the bit of the given pair of cells
+    bool CanCellsSee(int32 CellA, int32 CellB) const;
+
+    /**
+     * Checks if there may be a line of sight between the two locations
+     * @return False only when the static geometry is known to block every line between the two cells
+     */
+    bool IsPotentiallyVisible(const FVector& From, const FVector& To) const;
+
+    int32 GetNumCells() const { return Dimensions.X * Dimensions.Y; }
+
+    float GetCellSize() const { return CellSize; }
+
+    const FIntPoint& GetDimensions() const { return Dimensions; }
+
+protected:
+    // The minimum corner of the grid
+    UPROPERTY(VisibleAnywhere, Category = "PVS")
+    FVector Origin = FVector::ZeroVector;
+
+    UPROPERTY(VisibleAnywhere, Category = "PVS")
+    float CellSize = 0.f;
+
+    // Number of cells along X and Y
+    UPROPERTY(VisibleAnywhere, Category = "PVS")
+    FIntPoint Dimensions = FIntPoint::ZeroValue;
+
+    // NumCells x NumCells bits, row major
+    UPROPERTY()
+    TArray<uint32> VisibilityBits;
+};
@@ -26,6 +26,9 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	// Called when the box is picked up or removed from the level
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	/* The minimum amount of ammo that this box can contain */
 	UPROPERTY(EditAnywhere, meta = (ClampMin = '1'))
 	int32 MinAmmo = 1;
@@ -39,9 +42,4 @@ protected:
 
 	UPROPERTY(VisibleAnywhere)
 	class UBoxComponent* CollisionBox;
-
-public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
-
 };
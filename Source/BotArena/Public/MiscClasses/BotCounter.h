@@ -31,10 +31,7 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
-
+public:
 	/* Returns the number of blue bots */
 	UFUNCTION(BlueprintCallable, Category=Misc)
 	int32 GetBlueBotsCount() const { return Blue_Bots; }
@@ -42,9 +42,4 @@ protected:
 
 	UPROPERTY(VisibleAnywhere)
 	UProjectileMovementComponent* ProjectileMovementComp;
-
-public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
-
 };
@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Perception/AISenseConfig.h"
+#include "Perception/AIPerceptionTypes.h"
+#include "Senses/AISense_BotSight.h"
+#include "AISenseConfig_BotSight.generated.h"
+
+/**
+ * Configures UAISense_BotSight for a perception component. Same meaning as the stock sight config
+ */
+UCLASS(meta = (DisplayName = "AI BotArena Sight config"))
+class BOTARENA_API UAISenseConfig_BotSight : public UAISenseConfig
+{
+    GENERATED_BODY()
+
+public:
+    UAISenseConfig_BotSight();
+
+    virtual TSubclassOf<UAISense> GetSenseImplementation() const override;
+
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Sense", NoClear, config)
+    TSubclassOf<UAISense_BotSight> Implementation;
+
+    // Maximum distance at which a target can start being seen
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sense", config, meta = (UIMin = 0.0, ClampMin = 0.0))
+    float SightRadius = 3000.f;
+
+    // Maximum distance at which a target that is already seen stays seen
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sense", config, meta = (UIMin = 0.0, ClampMin = 0.0))
+    float LoseSightRadius = 3500.f;
+
+    // Half angle of the vision cone, 180 sees all around
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sense", config, meta = (UIMin = 0.0, ClampMin = 0.0, UIMax = 180.0, ClampMax = 180.0))
+    float PeripheralVisionAngleDegrees = 90.f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sense", config)
+    FAISenseAffiliationFilter DetectionByAffiliation;
+};
@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Perception/AISense.h"
+#include "UObject/ObjectKey.h"
+#include "Subsystems/BotSceneQuerySubsystem.h"
+#include "AISense_BotSight.generated.h"
+
+/**
+ * Sight sense for the bots, a budgeted replacement of UAISense_Sight.
+ * Every update the registered bots are gathered into structure-of-arrays buffers and each listener prefilters them
+ * with the vectorized distance and cone kernels of FBotSpatialKernels. Candidates that survive, are hostile and
+ * potentially visible according to the PVS go into a priority queue ordered by threat (proximity), whether they
+ * are the listener's current target and the time since their last check. Only the top of the queue is traced,
+ * within a fixed per frame budget, through UBotSceneQuerySubsystem. The results are collected on the next updates.
+ * Squad followers and bots of low significance only queue checks every few updates.
+ * The results are reported as regular stimuli so they reach UBotPerceptionComponent::OnPerceptionUpdated like the stock
+ * sight did.
+ */
+UCLASS(ClassGroup = AI)
+class BOTARENA_API UAISense_BotSight : public UAISense
+{
+    GENERATED_BODY()
+
+public:
+    UAISense_BotSight();
+
+protected:
+    // UAISense
+    virtual float Update() override;
+
+    void OnNewListenerImpl(const FPerceptionListener& NewListener);
+    void OnListenerUpdateImpl(const FPerceptionListener& UpdatedListener);
+    void OnListenerRemovedImpl(const FPerceptionListener& RemovedListener);
+
+    // The listener config, squared and precomputed
+    struct FDigestedProperties
+    {
+        float SightRadiusSquared = 0.f;
+        float LoseSightRadiusSquared = 0.f;
+        float SightRadius = 0.f;
+        float PeripheralVisionCos = 0.f;
+        uint8 AffiliationFlags = 0;
+    };
+
+    struct FPairKey
+    {
+        FPerceptionListenerID ListenerId;
+        FObjectKey Target;
+
+        bool operator==(const FPairKey& Other) const { return ListenerId == Other.ListenerId && Target == Other.Target; }
+
+        friend uint32 GetTypeHash(const FPairKey& Key) { return HashCombine(GetTypeHash(Key.ListenerId), GetTypeHash(Key.Target)); }
+    };
+
+    // What the sense remembers about one listener looking at one target
+    struct FPairState
+    {
+        TWeakObjectPtr<AActor> Target;
+        double LastCheckTime = 0.0;
+        // The frame the pair last passed the prefilter
+        uint64 LastCandidateFrame = 0;
+        bool bVisible = false;
+        // The trace waiting for its result, the pair isn't queued again meanwhile
+        FBotSceneQueryHandle PendingTrace;
+    };
+
+    // A line of sight check waiting for budget
+    struct FQueuedCheck
+    {
+        float Priority = 0.f;
+        FPairKey Key;
+        int32 TargetSlot = INDEX_NONE;
+
+        bool operator<(const FQueuedCheck& Other) const { return Priority > Other.Priority; }
+    };
+
+    // Fills the structure-of-arrays buffers from the bot registry
+    void GatherTargets();
+
+    // Prefilters the targets of one listener and queues the checks of the survivors
+    void QueueChecks(const FPerceptionListener& Listener, const FDigestedProperties& Properties);
+
+    // Reports to the listener that a pair became visible or stopped being visible
+    void ReportStimulus(FPerceptionListener& Listener, AActor* Target, bool bVisible);
+
+    // Drops the visibility of the pairs that didn't pass the prefilter this frame
+    void ForgetStalePairs();
+
+    // Reports the traces that came back from the scene query service
+    void CollectTraceResults();
+
+    // Releases the pending trace of a pair that is going away
+    void ReleaseTrace(FPairState& State);
+
+    TMap<FPerceptionListenerID, FDigestedProperties> DigestedProperties;
+    TMap<FPairKey, FPairState> PairStates;
+
+    // The priority queue, rebuilt every update
+    TArray<FQueuedCheck> Queue;
+
+    // The pairs waiting for a trace result
+    TArray<FPairKey> PendingTraces;
+
+    // Reused buffer of CollectTraceResults
+    TArray<FHitResult> TraceHits;
+
+    // Target data indexed by registry slot
+    TArray<float> TargetX;
+    TArray<float> TargetY;
+    TArray<float> TargetZ;
+    TArray<uint8> TargetTeam;
+    TArray<uint8> TargetAlive;
+
+    // Scratch buffers of the listener being prefiltered
+    TArray<float> DistSquared;
+    TArray<float> ForwardDot;
+};
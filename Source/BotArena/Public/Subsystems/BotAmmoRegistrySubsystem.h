@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Utils/BotSpatialHashGrid.h"
+#include "BotAmmoRegistrySubsystem.generated.h"
+
+class AAmmoBox;
+
+/**
+ * Keeps track of the ammo boxes lying in the world in a spatial hash grid and of the bots heading to them.
+ * Boxes register themselves on BeginPlay and leave when they're picked up or destroyed.
+ * A box can be reserved by a single bot at a time, so bots don't race each other for the same box.
+ * Reservations expire on their own in case the bot never makes it to the box.
+ */
+UCLASS()
+class BOTARENA_API UBotAmmoRegistrySubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // USubsystem
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+
+    // UWorldSubsystem
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    // Add an ammo box to the registry. Does nothing if the box is already registered
+    void RegisterAmmoBox(AAmmoBox* AmmoBox);
+
+    // Remove an ammo box from the registry along with its reservation
+    void UnregisterAmmoBox(AAmmoBox* AmmoBox);
+
+    // Get the number of registered ammo boxes
+    int32 GetNumAmmoBoxes() const { return SlotByBox.Num(); }
+
+    /**
+     * Finds the closest box that isn't reserved by another bot
+     * @param Bot - The bot asking. Boxes reserved by this bot are still returned
+     * @param Radius - Boxes further than this are ignored
+     * @return The closest available box, or nullptr
+     */
+    AAmmoBox* FindNearestAvailable(const AActor* Bot, float Radius) const;
+
+    /**
+     * Reserves a box for a bot. Any other box reserved by the same bot is released
+     * @return True if the box is now reserved by the bot
+     */
+    bool Reserve(AAmmoBox* AmmoBox, const AActor* Bot);
+
+    // Releases the reservation of the bot, if any
+    void ReleaseReservation(const AActor* Bot);
+
+    // Get the box reserved by the bot, or nullptr
+    AAmmoBox* GetReservedAmmoBox(const AActor* Bot) const;
+
+protected:
+    struct FAmmoBoxEntry
+    {
+        TWeakObjectPtr<AAmmoBox> AmmoBox;
+        FVector Location = FVector::ZeroVector;
+        FIntPoint Cell = FIntPoint::ZeroValue;
+        TWeakObjectPtr<const AActor> ReservedBy;
+        // Key of the holder in ReservationByBot, still usable once the holder is destroyed
+        const AActor* ReservationKey = nullptr;
+        float ReservationTime = 0.f;
+        bool bInUse = false;
+    };
+
+    // Checks if the slot is reserved by a live bot other than the given one and the reservation hasn't expired
+    bool IsReservedByOther(const FAmmoBoxEntry& Entry, const AActor* Bot) const;
+
+    // Clears the reservation stored in a slot
+    void ClearReservation(int32 Slot);
+
+    // Box slots. Freed slots are recycled so the grid can keep storing plain indices
+    TArray<FAmmoBoxEntry> Entries;
+    TArray<int32> FreeSlots;
+    TMap<const AAmmoBox*, int32> SlotByBox;
+
+    // Bot -> slot of the box it reserved
+    TMap<const AActor*, int32> ReservationByBot;
+
+    FBotSpatialHashGrid Grid;
+};
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "BotBrainSchedulerSubsystem.generated.h"
+
+/**
+ * Time slices the behavior trees of the bots. Every brain is put in one of BotArena.Brains.NumBuckets buckets, the
+ * least populated one when it registers, and the buckets take turns: a brain that wants to update every frame only
+ * does so on the frames of its bucket and gets the skipped time on its next update.
+ * Brains promoted by combat or damage (see UBotBehaviorTreeComponent::PromoteFor) ignore their bucket and update every
+ * frame until the promotion runs out.
+ */
+UCLASS()
+class BOTARENA_API UBotBrainSchedulerSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // USubsystem
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+
+    // UWorldSubsystem
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    // Get the seconds a brain keeps updating every frame after combat or damage (BotArena.Brains.PromotionTime)
+    static float GetPromotionTime();
+
+    // Assigns a brain to the least populated bucket and returns it
+    int32 RegisterBrain();
+
+    // Releases the bucket of a brain
+    void UnregisterBrain(int32 Bucket);
+
+    /**
+     * Check if the brains of a bucket update this frame. Always true for an unknown bucket
+     * @param Bucket - The bucket of the brain
+     * @param Stride - Number of turns of the bucket between two updates of the brain, more than 1 when it is cut back
+     */
+    bool IsBucketDue(int32 Bucket, int32 Stride = 1) const;
+
+protected:
+    // Number of registered brains per bucket
+    TArray<int32> BucketSizes;
+};
@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Components/BotTeamComponent.h"
+#include "BotCoverSubsystem.generated.h"
+
+class UBotCoverData;
+
+/**
+ * Answers cover queries from the cover points baked for the map by UBotCoverBakeCommandlet.
+ * A query only walks the points of the cells around the bot and tests their exposure masks, no trace is involved.
+ * Points lying where the influence map sees a lot of threat for the bot's team are avoided.
+ */
+UCLASS()
+class BOTARENA_API UBotCoverSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // USubsystem
+    virtual void Deinitialize() override;
+
+    // UWorldSubsystem
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+    /**
+     * Finds the best spot to hide from a threat
+     * @param BotLocation - Where the bot stands
+     * @param ThreatLocation - Where the danger comes from
+     * @param Team - The team of the bot, used to read the threat of the influence map
+     * @param OutLocation - Receives the cover location
+     * @return False if there's no cover data or no cover in range
+     */
+    bool FindCoverFrom(const FVector& BotLocation, const FVector& ThreatLocation, ETeam Team, FVector& OutLocation) const;
+
+    bool HasCoverData() const { return CoverData != nullptr; }
+
+protected:
+    // The cover baked for this map, if any
+    UPROPERTY()
+    TObjectPtr<UBotCoverData> CoverData;
+};
@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "BotDormancySubsystem.generated.h"
+
+class AAICharacter;
+class UBotRegistrySubsystem;
+
+/**
+ * Puts idle bots to sleep. A bot is idle when it remembers no threat, has no target, isn't low on ammo, has full health,
+ * stands on the ground and no enemy is around. Once it stayed idle for a while its perception and movement updates stop,
+ * it leaves the sight sense, its behavior tree and move are paused and its character movement stops ticking.
+ * Dormant bots cost nothing per frame until an event wakes them: damage, gunfire in hearing range, crossing the low ammo
+ * threshold or an enemy entering a cell near them. The latter is found from the registry's cell changes, so only bots
+ * crossing a cell border cost a query.
+ */
+UCLASS()
+class BOTARENA_API UBotDormancySubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // USubsystem
+    virtual void Deinitialize() override;
+
+    // UWorldSubsystem
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    // FTickableGameObject
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    // Check if idle bots are put to sleep (BotArena.Dormancy.Enabled)
+    static bool IsEnabled();
+
+    // Check if a bot is dormant
+    bool IsDormant(const AActor* Bot) const;
+
+    // Wakes a dormant bot up. An awake bot starts counting its idle time over
+    void WakeUp(const AActor* Bot);
+
+protected:
+    // Check if the bot in a slot may fall asleep
+    bool IsIdle(const UBotRegistrySubsystem& Registry, AAICharacter& Bot);
+
+    // Puts the bot in a slot to sleep or wakes it up
+    void SetDormant(AAICharacter& Bot, int32 Slot, bool bDormant);
+
+    // Wakes the dormant enemies around the bot in a slot, which just entered a new cell
+    void WakeEnemiesAround(const UBotRegistrySubsystem& Registry, int32 Slot);
+
+    // Syncs the per slot state with the registry, resetting recycled slots
+    void RefreshSlots(const UBotRegistrySubsystem& Registry);
+
+    // Whether the bot of a slot is dormant, by registry slot
+    TArray<bool> DormantBySlot;
+
+    // Seconds the bot of a slot has been idle, by registry slot
+    TArray<float> IdleTimeBySlot;
+
+    // Bot stored in each slot when its state was last refreshed, to detect recycled slots
+    TArray<TWeakObjectPtr<AAICharacter>> BotBySlot;
+
+    int32 NumDormant = 0;
+
+    // Time accumulated towards the next idle check
+    float TimeSinceIdleCheck = 0.f;
+
+    // Scratch buffer for the registry queries
+    TArray<AAICharacter*> NearbyBots;
+};
@@ -0,0 +1,178 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "EnvironmentQuery/EnvQueryTypes.h"
+#include "BotEQSSubsystem.generated.h"
+
+class ANavigationData;
+
+/**
+ * Offsets of a ring of points around a querier, in the querier's local frame.
+ * Each direction is stored as (cos, sin) of its angle from the forward vector
+ */
+struct FBotRingTemplate
+{
+    TArray<FVector2f> Directions;
+    TArray<float> Distances;
+
+    int32 GetNumPoints() const { return Directions.Num() * Distances.Num(); }
+};
+
+// Identifies a cached generator or context output shared by the bots of a team standing in the same cell
+struct FBotEQSResultKey
+{
+    // The generator or context that produced the result
+    const UObject* Template = nullptr;
+    FIntVector Cell = FIntVector::ZeroValue;
+    uint8 Team = 0;
+    // Hash of the parameters the result depends on
+    uint32 ContextHash = 0;
+
+    bool operator==(const FBotEQSResultKey& Other) const
+    {
+        return Template == Other.Template && Cell == Other.Cell && Team == Other.Team && ContextHash == Other.ContextHash;
+    }
+
+    friend uint32 GetTypeHash(const FBotEQSResultKey& Key)
+    {
+        uint32 Hash = HashCombine(GetTypeHash(Key.Template), GetTypeHash(Key.Cell));
+        return HashCombine(HashCombine(Hash, GetTypeHash(Key.Team)), Key.ContextHash);
+    }
+};
+
+/**
+ * Shared state of the bot EQS generators.
+ * Ring templates are built once per parameter set instead of rotating vectors on every query,
+ * and nav projections are cached per small cell so bots sidestepping in the same area reuse each other's results.
+ * Cache misses of a query are projected in a single batch.
+ * On top of that, generator and context outputs are cached for a short time per (template, querier cell, team, context),
+ * so squad mates standing next to each other skip the registry lookup, and queries from the same spot skip the ring generation
+ * and nav projection. The context hash covers every setting the output depends on.
+ * Only these outputs are shared, not the scored query result: the queries and their tests are run by the engine's
+ * EQS nodes in the behavior tree assets, which a generator or context can't short-circuit. Every bot still runs its query.
+ */
+UCLASS()
+class BOTARENA_API UBotEQSSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // USubsystem
+    virtual void Deinitialize() override;
+
+    // UWorldSubsystem
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    // FTickableGameObject
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    /**
+     * Get the ring template for the given parameters, building it on first use
+     * @param AngleStep - The step between two directions
+     * @param DegreesGap - No direction is generated closer than this to the forward vector
+     * @param PointsDistance - The distance between two points of the same direction
+     * @param MaxRange - Points are generated up to this distance
+     */
+    const FBotRingTemplate& GetRingTemplate(float AngleStep, float DegreesGap, float PointsDistance, float MaxRange);
+
+    /**
+     * Projects the points on the nav data like UEnvQueryGenerator_ProjectedPoints does in navigation mode,
+     * reading recent results from the cache and projecting the misses in one batch.
+     * Points that can't be projected are removed
+     */
+    void ProjectPoints(const ANavigationData& NavData, const UObject& Querier, const FEnvTraceData& TraceData, TArray<FNavLocation>& InOutPoints);
+
+    // Checks if generators and contexts should share their results through the result cache
+    static bool IsResultCacheEnabled();
+
+    // Get the size of the cells results are shared in
+    static float GetResultCacheCellSize();
+
+    // Get the size of the cells generated points are shared in, smaller since the points are generated around the cell center
+    static float GetPointsCacheCellSize();
+
+    // Builds the key of a cached result for a querier standing at the given location
+    static FBotEQSResultKey MakeResultKey(const UObject* Template, const FVector& QuerierLocation, uint8 Team, uint32 ContextHash);
+
+    // Builds the key of a cached result for a querier standing at the given location, with cells of the given size
+    static FBotEQSResultKey MakeResultKey(const UObject* Template, const FVector& QuerierLocation, uint8 Team, uint32 ContextHash, float CellSize);
+
+    // Get a cached list of points, or nullptr if there's none or it expired
+    const TArray<FNavLocation>* FindCachedPoints(const FBotEQSResultKey& Key) const;
+
+    // Caches a list of points and returns the cached copy
+    const TArray<FNavLocation>& StoreCachedPoints(const FBotEQSResultKey& Key, const TArray<FNavLocation>& Points);
+
+    // Get a cached list of actors, or nullptr if there's none or it expired
+    const TArray<TWeakObjectPtr<AActor>>* FindCachedActors(const FBotEQSResultKey& Key) const;
+
+    // Caches a list of actors and returns the cached copy
+    const TArray<TWeakObjectPtr<AActor>>& StoreCachedActors(const FBotEQSResultKey& Key, const TArray<AActor*>& Actors);
+
+protected:
+    struct FRingKey
+    {
+        float AngleStep;
+        float DegreesGap;
+        float PointsDistance;
+        float MaxRange;
+
+        bool operator==(const FRingKey& Other) const
+        {
+            return AngleStep == Other.AngleStep && DegreesGap == Other.DegreesGap && PointsDistance == Other.PointsDistance && MaxRange == Other.MaxRange;
+        }
+
+        friend uint32 GetTypeHash(const FRingKey& Key)
+        {
+            uint32 Hash = GetTypeHash(Key.AngleStep);
+            Hash = HashCombine(Hash, GetTypeHash(Key.DegreesGap));
+            Hash = HashCombine(Hash, GetTypeHash(Key.PointsDistance));
+            return HashCombine(Hash, GetTypeHash(Key.MaxRange));
+        }
+    };
+
+    struct FProjectionKey
+    {
+        FIntVector Cell;
+        // Hash of the nav data, filter and extent the projection was made with
+        uint32 SettingsHash;
+
+        bool operator==(const FProjectionKey& Other) const { return Cell == Other.Cell && SettingsHash == Other.SettingsHash; }
+
+        friend uint32 GetTypeHash(const FProjectionKey& Key) { return HashCombine(GetTypeHash(Key.Cell), Key.SettingsHash); }
+    };
+
+    struct FProjectionEntry
+    {
+        FNavLocation Location;
+        float Time = 0.f;
+        bool bResult = false;
+    };
+
+    template<typename ItemType>
+    struct FCachedResult
+    {
+        TArray<ItemType> Items;
+        float Time = 0.f;
+    };
+
+    // Checks if a cached result can still be used
+    bool IsResultFresh(float ResultTime) const;
+
+    TMap<FRingKey, FBotRingTemplate> RingTemplates;
+
+    TMap<FBotEQSResultKey, FCachedResult<FNavLocation>> CachedPoints;
+    TMap<FBotEQSResultKey, FCachedResult<TWeakObjectPtr<AActor>>> CachedActors;
+
+    TMap<FProjectionKey, FProjectionEntry> ProjectionCache;
+
+    // Reused buffers of ProjectPoints
+    TArray<FNavigationProjectionWork> ProjectionWorkload;
+    TArray<FProjectionKey> PointKeys;
+    TArray<int32> WorkloadIndexByPoint;
+};
@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "BotFrameBudgetSubsystem.generated.h"
+
+DECLARE_STATS_GROUP(TEXT("BotArena"), STATGROUP_BotArena, STATCAT_Advanced);
+
+// The kinds of bot work whose cost is measured against a budget
+enum class EBotBudgetDomain : uint8
+{
+    Perception,
+    Behavior,
+    EQS,
+    Weapon,
+    Movement,
+    Num
+};
+
+/**
+ * Holds the bot work of a frame to a millisecond budget (BotArena.Budget.*).
+ * The work is measured with FBotBudgetScope, which also feeds the cycle stats of the BotArena stats group. Every frame
+ * the smoothed cost of each domain is compared to its budget and a pressure from 0 to 1 ramps up while it is over and
+ * back down once there's headroom again. The pressure cuts back the bots whose significance is below a cutoff rising
+ * with it, so bots in a fight are never touched:
+ * - Perception: they get the quiet perception LOD and the sight sense traces fewer pairs per frame
+ * - Behavior: their behavior tree only updates every few turns of its bucket
+ * - EQS: their sidestep and nearby points rings get sparser
+ * Weapon and movement work has nothing to scale per bot, their cost and the total frame budget raise the pressure
+ * of every domain instead. The movement cost only covers the crouch mesh adjustment of UBotMovementComponent, the
+ * engine's character movement and path following tick on their own and aren't measured.
+ */
+UCLASS()
+class BOTARENA_API UBotFrameBudgetSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // USubsystem
+    virtual void Deinitialize() override;
+
+    // UWorldSubsystem
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    // FTickableGameObject
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    // Check if the governor scales the bots (BotArena.Budget.Enabled). The cost is measured either way
+    static bool IsEnabled();
+
+    // Adds measured work to the current frame
+    void AddCost(EBotBudgetDomain Domain, uint64 Cycles) { FrameCycles[static_cast<int32>(Domain)] += Cycles; }
+
+    // Get the pressure on a scalable domain, including the one of the whole frame. 0 when the governor is disabled
+    float GetPressure(EBotBudgetDomain Domain) const;
+
+    // Get the significance below which bots are cut back for a domain
+    float GetSignificanceCutoff(EBotBudgetDomain Domain) const;
+
+    // Get the factor applied to the sight trace budget
+    float GetTraceBudgetScale() const;
+
+    // Get how many turns of its bucket the behavior tree of a bot waits between updates, 1 when it isn't cut back
+    int32 GetBrainStride(const AActor* Bot) const;
+
+    // Get the factor applied to the point spacing of the EQS rings of a bot, 1 when it isn't cut back
+    float GetEQSSpacingScale(const AActor* Bot) const;
+
+protected:
+    friend class FBotBudgetScope;
+
+    static constexpr int32 NumDomains = static_cast<int32>(EBotBudgetDomain::Num);
+
+    // Check if a bot is below the significance cutoff of a domain
+    bool IsCutBack(EBotBudgetDomain Domain, const AActor* Bot) const;
+
+    // Cycles measured since the last tick, per domain
+    uint64 FrameCycles[NumDomains] = {};
+
+    // Smoothed cost in milliseconds, per domain
+    float CostMs[NumDomains] = {};
+
+    // Pressure per domain and for the whole frame
+    float Pressure[NumDomains] = {};
+    float FramePressure = 0.f;
+
+    // Innermost scope measuring right now
+    FBotBudgetScope* ActiveScope = nullptr;
+};
+
+/**
+ * Measures the work of a scope for the frame budget and the BotArena stats group.
+ * Scopes are exclusive: a nested scope, e.g. a weapon firing from a behavior tree task, takes its time out of the
+ * enclosing one so no work is counted twice
+ */
+class BOTARENA_API FBotBudgetScope
+{
+public:
+    FBotBudgetScope(const UWorld* World, EBotBudgetDomain InDomain);
+    ~FBotBudgetScope();
+
+private:
+    FScopeCycleCounter CycleCounter;
+    UBotFrameBudgetSubsystem* Budget;
+    EBotBudgetDomain Domain;
+    uint64 StartCycles;
+
+    // The scope this one is nested in and the cycles measured by the scopes nested in this one
+    FBotBudgetScope* OuterScope = nullptr;
+    uint64 InnerCycles = 0;
+};
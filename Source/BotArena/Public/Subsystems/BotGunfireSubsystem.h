@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Components/BotTeamComponent.h"
+#include "BotGunfireSubsystem.generated.h"
+
+class AAICharacter;
+
+/**
+ * Lets bots hear gunfire. Shots are only recorded when fired and bucketed by grid cell, repeated shots of the same
+ * shooter in the same cell collapse into one. Once per frame every cell that saw shots gathers its listeners with a
+ * single registry query and each hostile listener in hearing range gets one event per shooter: the shooter goes into
+ * its threat table at the noise location and the listener's significance is raised, which brings quiet bots back to
+ * full perception rate.
+ */
+UCLASS()
+class BOTARENA_API UBotGunfireSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // USubsystem
+    virtual void Deinitialize() override;
+
+    // UWorldSubsystem
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    // FTickableGameObject
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    // Records a shot, delivered to the listeners around it at the end of the frame
+    void ReportShot(AAICharacter* Shooter, const FVector& Location);
+
+protected:
+    struct FShot
+    {
+        TWeakObjectPtr<AAICharacter> Shooter;
+        FVector Location = FVector::ZeroVector;
+        ETeam Team = ETeam::E_Team1;
+    };
+
+    // The shots fired in one cell this frame, one per shooter
+    struct FShotCell
+    {
+        FIntPoint Coord = FIntPoint::ZeroValue;
+        TArray<FShot, TInlineAllocator<4>> Shots;
+    };
+
+    // Hands the shots of a cell to the listeners in hearing range
+    void DeliverCell(const FShotCell& Cell, float HearingRadius, float CellSize);
+
+    TArray<FShotCell> Cells;
+    TMap<FIntPoint, int32> CellIndexByCoord;
+
+    // Scratch buffer for the listener queries
+    TArray<AAICharacter*> Listeners;
+};
@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Components/BotTeamComponent.h"
+#include "BotInfluenceMapSubsystem.generated.h"
+
+class AAICharacter;
+
+/**
+ * A 2D grid over the nav area holding what the bots know about the battlefield, so that sampling it costs a single cell read.
+ * Every team has a presence layer and a fire layer, and one ammo layer is shared by all teams.
+ * Layers are updated incrementally: a bot's presence is only moved when it crosses a cell, dies or changes team,
+ * shots stamp the fire layer of the shooter's team and fire fades out over time. Stamping and decay go through
+ * the vectorized kernels of FBotSpatialKernels, one grid row at a time.
+ * The threat seen by a team is the presence and fire of every other team.
+ * While nothing samples the map its per frame update is skipped. Presence moves are caught up and the fire decays over
+ * the skipped time once it's sampled again.
+ */
+UCLASS()
+class BOTARENA_API UBotInfluenceMapSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // USubsystem
+    virtual void Deinitialize() override;
+
+    // UWorldSubsystem
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+    // FTickableGameObject
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    // Check if the grid was built. Every sample returns 0 otherwise
+    bool IsInitialized() const { return NumCells > 0; }
+
+    // Get the presence and fire of every team other than the given one
+    float GetThreat(ETeam Team, const FVector& Location) const;
+
+    // Get the presence of every team other than the given one
+    float GetEnemyPresence(ETeam Team, const FVector& Location) const;
+
+    // Get the presence of the given team
+    float GetAllyPresence(ETeam Team, const FVector& Location) const;
+
+    // Get how much ammo is available around the location
+    float GetAmmo(const FVector& Location) const;
+
+    // Stamps a shot into the fire layer of the team that fired
+    void AddFireEvent(ETeam Team, const FVector& Location);
+
+    // Stamps an ammo source. Pass a negative amount to remove it again
+    void AddAmmo(const FVector& Location, float Amount);
+
+protected:
+    static constexpr int32 NumTeams = 3;
+
+    // A precomputed square of falloff weights, (2 * Radius + 1) cells wide
+    struct FStamp
+    {
+        int32 Radius = 0;
+        TArray<float> Weights;
+
+        void Build(int32 InRadius);
+    };
+
+    // What is currently stamped for the bot of a registry slot
+    struct FStampedBot
+    {
+        TWeakObjectPtr<AAICharacter> Bot;
+        int32 Cell = INDEX_NONE;
+        ETeam Team = ETeam::E_Team1;
+    };
+
+    // Get the cell of a location, or INDEX_NONE outside the grid
+    int32 GetCellIndex(const FVector& Location) const;
+
+    // Adds the stamp centered on the given cell to the layer, clipped to the grid
+    void ApplyStamp(TArray<float>& Layer, int32 Cell, const FStamp& Stamp, float Factor);
+
+    // Moves the presence of the bots that crossed a cell, died or changed team since the last frame
+    void UpdatePresence();
+
+    // Origin of the grid on the XY plane
+    FVector2D Origin = FVector2D::ZeroVector;
+    float CellSize = 200.f;
+    FIntPoint Dimensions = FIntPoint::ZeroValue;
+    int32 NumCells = 0;
+
+    TArray<float> PresenceLayers[NumTeams];
+    TArray<float> FireLayers[NumTeams];
+    TArray<float> AmmoLayer;
+
+    FStamp PresenceStamp;
+    FStamp FireStamp;
+    FStamp AmmoStamp;
+
+    // Indexed by registry slot
+    TArray<FStampedBot> StampedBots;
+
+    // The last frame any layer was sampled on
+    mutable uint64 LastSampleFrame = 0;
+
+    // Time the fire layers haven't been decayed for
+    float DecayTime = 0.f;
+};
@@ -0,0 +1,141 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Components/BotTeamComponent.h"
+#include "Utils/BotSpatialHashGrid.h"
+#include "BotRegistrySubsystem.generated.h"
+
+class AAICharacter;
+
+/**
+ * Keeps track of every live bot in the world and buckets them in one spatial hash grid per team,
+ * so that "who is around me" questions cost a few cells instead of a walk over every bot,
+ * and ally queries never even look at the bots of the other teams.
+ * Bots register themselves on BeginPlay and leave on death or EndPlay.
+ * Positions are refreshed once per frame and a bot only changes bucket when it crosses a cell border.
+ */
+UCLASS()
+class BOTARENA_API UBotRegistrySubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // USubsystem
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+
+    // UWorldSubsystem
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    // FTickableGameObject
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    // Add a bot to the registry. Does nothing if the bot is already registered
+    void RegisterBot(AAICharacter* Bot);
+
+    // Remove a bot from the registry. Does nothing if the bot is not registered
+    void UnregisterBot(AAICharacter* Bot);
+
+    // Check if the given bot is currently registered
+    bool IsRegistered(const AActor* Bot) const { return SlotByBot.Contains(Bot); }
+
+    // Get the number of registered bots
+    int32 GetNumBots() const { return SlotByBot.Num(); }
+
+    // Re-reads the position and team of every registered bot and moves the ones that crossed a cell.
+    // Only does work once per frame, so consumers can call it to make sure they read fresh positions
+    void RefreshBots();
+
+    // Get the slots whose bot entered a new cell or changed team during the last refresh
+    const TArray<int32>& GetCellChangedSlots() const { return CellChangedSlots; }
+
+    // Get the number of bot slots. Slots are stable for as long as a bot is registered and may be used as array indices
+    int32 GetNumSlots() const { return Entries.Num(); }
+
+    // Get the slot of a registered bot, or INDEX_NONE. Any actor may be passed, non bots simply aren't found
+    int32 FindSlot(const AActor* Bot) const;
+
+    // Get the bot stored in a slot, or nullptr if the slot is free
+    AAICharacter* GetBotAtSlot(int32 Slot) const { return Entries[Slot].Bot.Get(); }
+
+    // Get the last refreshed location of the bot stored in a slot
+    const FVector& GetLocationAtSlot(int32 Slot) const { return Entries[Slot].Location; }
+
+    // Get the last refreshed team of the bot stored in a slot
+    ETeam GetTeamAtSlot(int32 Slot) const { return Entries[Slot].Team; }
+
+    /**
+     * Collects the registered bots that are hostile to the querier and within the given radius
+     * @param Querier - The bot asking. Its team is read from the registry
+     * @param Radius - The search radius
+     * @param OutBots - Receives the found bots. The array is reset first
+     * @return The number of found bots
+     */
+    int32 GetEnemiesInRadius(const AAICharacter* Querier, float Radius, TArray<AAICharacter*>& OutBots) const;
+
+    /**
+     * Collects the registered bots that share the querier's team and are within the given radius.
+     * The querier itself is excluded
+     */
+    int32 GetAlliesInRadius(const AAICharacter* Querier, float Radius, TArray<AAICharacter*>& OutBots) const;
+
+    /**
+     * Collects the registered bots of every team within the given radius of a location
+     * @param Center - The center of the search
+     * @param Radius - The search radius
+     * @param OutBots - Receives the found bots. The array is reset first
+     * @return The number of found bots
+     */
+    int32 GetBotsInRadius(const FVector& Center, float Radius, TArray<AAICharacter*>& OutBots) const;
+
+    /**
+     * Collects up to K hostile bots sorted by distance to the querier
+     * @param Querier - The bot asking
+     * @param K - The maximum number of bots to return
+     * @param MaxRadius - Bots further than this are never returned
+     * @param OutBots - Receives the found bots, closest first. The array is reset first
+     * @return The number of found bots
+     */
+    int32 GetKNearestHostiles(const AAICharacter* Querier, int32 K, float MaxRadius, TArray<AAICharacter*>& OutBots) const;
+
+protected:
+    struct FBotEntry
+    {
+        TWeakObjectPtr<AAICharacter> Bot;
+        FVector Location = FVector::ZeroVector;
+        FIntPoint Cell = FIntPoint::ZeroValue;
+        ETeam Team = ETeam::E_Team1;
+        bool bInUse = false;
+    };
+
+    // Get the team of the querier, preferring the registry copy over the component lookup
+    ETeam GetQuerierTeam(const AAICharacter* Querier) const;
+
+    // Shared implementation of the radius queries
+    int32 GatherInRadius(const AAICharacter* Querier, float Radius, bool bWantHostiles, TArray<AAICharacter*>& OutBots) const;
+
+    // Frees a slot and removes it from the grid
+    void ReleaseSlot(int32 Slot);
+
+    // Get the grid of a team, creating it on first use
+    FBotSpatialHashGrid& GetTeamGrid(ETeam Team);
+
+    // Bot slots. Freed slots are recycled so the grid can keep storing plain indices
+    TArray<FBotEntry> Entries;
+    TArray<int32> FreeSlots;
+    TMap<const AActor*, int32> SlotByBot;
+
+    // One grid per team, all sharing the same cell size
+    TMap<ETeam, FBotSpatialHashGrid> TeamGrids;
+    float CellSize = 500.0f;
+
+    // The frame RefreshBots last ran on
+    uint64 LastRefreshFrame = 0;
+
+    // Slots that entered a new cell during the last refresh
+    TArray<int32> CellChangedSlots;
+};
@@ -0,0 +1,170 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CollisionQueryParams.h"
+#include "CollisionShape.h"
+#include "WorldCollision.h"
+#include "BotSceneQuerySubsystem.generated.h"
+
+// The order in which queued scene queries get dispatched when the per frame budget runs out
+enum class EBotSceneQueryPriority : uint8
+{
+    Low,
+    Normal,
+    High
+};
+
+// The state of a scene query as seen through its handle
+enum class EBotSceneQueryStatus : uint8
+{
+    // The handle was never issued, got released or its result expired
+    Invalid,
+    // The query is waiting for budget or for the physics results
+    Pending,
+    // The hits are available
+    Ready
+};
+
+// Identifies a scene query request. Several handles may share the same underlying query
+struct FBotSceneQueryHandle
+{
+    uint32 Id = 0;
+
+    bool IsValid() const { return Id != 0; }
+    void Invalidate() { Id = 0; }
+};
+
+/**
+ * Describes a scene query. Build one with the LineTrace, LineTraceByChannel or Sweep helpers
+ */
+struct BOTARENA_API FBotSceneQueryDesc
+{
+    bool bIsSweep = false;
+    EAsyncTraceType TraceType = EAsyncTraceType::Single;
+    FVector Start = FVector::ZeroVector;
+    FVector End = FVector::ZeroVector;
+    FCollisionShape Shape;
+    FCollisionObjectQueryParams ObjectQueryParams;
+    // Queries against a trace channel instead of object types when not ECC_MAX
+    ECollisionChannel TraceChannel = ECC_MAX;
+    FName TraceTag;
+    TArray<TWeakObjectPtr<const AActor>, TInlineAllocator<2>> IgnoredActors;
+
+    // Describes a line trace against the given object types
+    static FBotSceneQueryDesc LineTrace(EAsyncTraceType InTraceType, const FVector& InStart, const FVector& InEnd, const FCollisionObjectQueryParams& InObjectQueryParams, FName InTraceTag);
+
+    // Describes a line trace against the given trace channel
+    static FBotSceneQueryDesc LineTraceByChannel(EAsyncTraceType InTraceType, const FVector& InStart, const FVector& InEnd, ECollisionChannel InTraceChannel, FName InTraceTag);
+
+    // Describes a shape sweep against the given object types
+    static FBotSceneQueryDesc Sweep(EAsyncTraceType InTraceType, const FVector& InStart, const FVector& InEnd, const FCollisionShape& InShape, const FCollisionObjectQueryParams& InObjectQueryParams, FName InTraceTag);
+
+    bool IsByChannel() const { return TraceChannel != ECC_MAX; }
+
+    // Adds an actor the query should not report
+    FBotSceneQueryDesc& IgnoreActor(const AActor* Actor);
+};
+
+/**
+ * The single entry point for the scene queries issued by bots.
+ * Requests are collected during the frame, identical requests (same shape, origin, end point, object types
+ * or trace channel and ignored actors) are merged into a single query, and the survivors are dispatched in batches through the
+ * async scene query API, highest priority first, without ever exceeding a per frame query budget.
+ * Callers keep a handle, poll it for the result and release it once they're done.
+ */
+UCLASS()
+class BOTARENA_API UBotSceneQuerySubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // USubsystem
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+
+    // UWorldSubsystem
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    // FTickableGameObject
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    /**
+     * Queues a scene query. If an identical query is already waiting, the new handle shares its result
+     * @param Desc - What to query
+     * @param Priority - Higher priorities are dispatched first when the budget runs out
+     * @return The handle to poll for the result
+     */
+    FBotSceneQueryHandle Request(const FBotSceneQueryDesc& Desc, EBotSceneQueryPriority Priority = EBotSceneQueryPriority::Normal);
+
+    /**
+     * Gets the result of a query
+     * @param Handle - The handle returned by Request
+     * @param OutHits - Receives the hits if the query is ready. Left untouched otherwise
+     * @return The status of the query
+     */
+    EBotSceneQueryStatus GetResult(const FBotSceneQueryHandle& Handle, TArray<FHitResult>& OutHits) const;
+
+    // Get the status of a query without copying its hits
+    EBotSceneQueryStatus GetStatus(const FBotSceneQueryHandle& Handle) const;
+
+    // Releases a handle. The query is dropped once all of its handles are released. The handle is invalidated
+    void Release(FBotSceneQueryHandle& Handle);
+
+protected:
+    enum class ERequestState : uint8
+    {
+        Queued,
+        InFlight,
+        Done
+    };
+
+    struct FRequest
+    {
+        FBotSceneQueryDesc Desc;
+        uint32 Key = 0;
+        EBotSceneQueryPriority Priority = EBotSceneQueryPriority::Normal;
+        ERequestState State = ERequestState::Queued;
+        uint64 QueuedFrame = 0;
+        uint64 CompletedFrame = 0;
+        TArray<uint32, TInlineAllocator<2>> Handles;
+        TArray<FHitResult> Hits;
+    };
+
+    // Builds the key used to merge identical requests
+    uint32 MakeRequestKey(const FBotSceneQueryDesc& Desc) const;
+
+    // Checks if two requests with the same key really describe the same query
+    static bool IsSameQuery(const FBotSceneQueryDesc& A, const FBotSceneQueryDesc& B);
+
+    // Sends the queued requests to the physics scene, highest priority first, until the budget runs out
+    void DispatchQueued();
+
+    // Frees requests whose result nobody picked up in time
+    void ExpireResults();
+
+    // Removes a request and every handle pointing to it
+    void RemoveRequest(uint32 RequestId);
+
+    // Receives the async results
+    void OnQueryCompleted(const FTraceHandle& TraceHandle, FTraceDatum& Datum);
+
+    TMap<uint32, FRequest> Requests;
+
+    // Requests waiting for budget, in the order they were issued
+    TArray<uint32> Queue;
+
+    // Requests that can still absorb duplicates, keyed by MakeRequestKey
+    TMultiMap<uint32, uint32> MergeableRequests;
+
+    // Handle id -> request id
+    TMap<uint32, uint32> RequestByHandle;
+
+    uint32 NextRequestId = 1;
+    uint32 NextHandleId = 1;
+
+    FTraceDelegate QueryDelegate;
+};
@@ -0,0 +1,178 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "Tasks/Task.h"
+#include "BotSidestepSubsystem.generated.h"
+
+class AAICharacter;
+class UBotPVSData;
+
+// Parameters of the ring of sidestep candidates, same meaning as in UEQG_NearbyPoints
+struct FBotSidestepParams
+{
+    float PointsDistance = 150.f;
+    float DegreesGap = 60.f;
+    float AngleStep = 20.f;
+    float MaxRange = 500.f;
+
+    // Candidates closer than this to an ally are penalized
+    float AllySpacing = 200.f;
+};
+
+// The state of a sidestep request as seen through its id
+enum class EBotSidestepStatus : uint8
+{
+    // Unknown id, the request was cancelled or already consumed
+    Invalid,
+    // Waiting for the worker task or for commit budget
+    Pending,
+    // A location was found
+    Succeeded,
+    // No candidate could be projected on the nav mesh
+    Failed
+};
+
+/**
+ * Finds sidestep locations for bots that are in a fight, without running EQS on the game thread.
+ * Pending requests are gathered into a read-only snapshot (bot, target and ally locations, the ring of candidates and the PVS)
+ * and generated and scored on a worker task. Back on the game thread the results are committed within a per frame budget,
+ * bots that were hit recently first, and only the few best candidates of each bot are projected on the nav mesh.
+ * The same scoring also shortlists the points of EQ_NearbyPoints through UEQG_NearbyPoints, whose tests then pick among them.
+ */
+UCLASS()
+class BOTARENA_API UBotSidestepSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // USubsystem
+    virtual void Deinitialize() override;
+
+    // UWorldSubsystem
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    // FTickableGameObject
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    /**
+     * Queues a sidestep search
+     * @param Bot - The bot that wants to sidestep
+     * @param Target - The actor the bot is fighting, may be null
+     * @param Params - The candidate ring and scoring parameters
+     * @return The id to poll, 0 if the request couldn't be queued
+     */
+    uint32 RequestSidestep(AAICharacter* Bot, const AActor* Target, const FBotSidestepParams& Params);
+
+    /**
+     * Gets the result of a request. Finished requests are consumed by this call
+     * @param RequestId - The id returned by RequestSidestep
+     * @param OutLocation - Receives the sidestep location on success
+     */
+    EBotSidestepStatus PollSidestep(uint32 RequestId, FVector& OutLocation);
+
+    // Drops a request, whatever its state
+    void CancelSidestep(uint32 RequestId);
+
+    /**
+     * Keeps the best sidestep candidates among the given points, scored like the worker task scores its ring
+     * @param Bot - The bot that wants to sidestep
+     * @param Target - The actor the bot is fighting, may be null
+     * @param Params - The scoring parameters, the ring ones are not read
+     * @param InOutPoints - The candidates, replaced by the best NumToKeep of them
+     * @param NumToKeep - How many candidates to keep
+     */
+    void ShortlistCandidates(const AAICharacter& Bot, const AActor* Target, const FBotSidestepParams& Params, TArray<FNavLocation>& InOutPoints, int32 NumToKeep) const;
+
+    // Get how many points of EQ_NearbyPoints are shortlisted for its tests, 0 when they all are
+    static int32 GetNearbyPointsShortlistSize();
+
+protected:
+    // What the worker task reads for one bot
+    struct FSnapshot
+    {
+        uint32 RequestId = 0;
+        FVector BotLocation = FVector::ZeroVector;
+        FVector BotForward = FVector::ForwardVector;
+        FVector TargetLocation = FVector::ZeroVector;
+        bool bHasTarget = false;
+        FBotSidestepParams Params;
+        TArray<FVector2f> Directions;
+        TArray<float> Distances;
+        TArray<FVector, TInlineAllocator<8>> AllyLocations;
+    };
+
+    // What the worker task produces for one bot
+    struct FScoredCandidates
+    {
+        uint32 RequestId = 0;
+        // Best first
+        TArray<FVector, TInlineAllocator<4>> Locations;
+    };
+
+    struct FRequest
+    {
+        TWeakObjectPtr<AAICharacter> Bot;
+        TWeakObjectPtr<const AActor> Target;
+        FBotSidestepParams Params;
+        EBotSidestepStatus Status = EBotSidestepStatus::Pending;
+        bool bInFlight = false;
+        uint64 RequestFrame = 0;
+        FVector Result = FVector::ZeroVector;
+        TArray<FVector, TInlineAllocator<4>> Candidates;
+        bool bHasCandidates = false;
+    };
+
+    // Builds the snapshots of the requests waiting for evaluation and launches the worker task
+    void LaunchEvaluation();
+
+    // Picks up the results of the worker task once it's done
+    void CollectEvaluation();
+
+    // Hands the scored candidates over to their requests
+    void ApplyEvaluation(TArray<FScoredCandidates>& Results);
+
+    // Projects the best candidates of the most urgent requests, within the commit budget
+    void CommitResults();
+
+    // What scoring a candidate depends on, besides the candidate
+    struct FScoringContext
+    {
+        FVector BotLocation = FVector::ZeroVector;
+        FVector TargetLocation = FVector::ZeroVector;
+        FVector TargetRight = FVector::ZeroVector;
+        float TargetDistance = 0.f;
+        bool bHasTarget = false;
+        float MaxRange = 0.f;
+        float AllySpacingSquared = 0.f;
+        TConstArrayView<FVector> AllyLocations;
+        const UBotPVSData* PVS = nullptr;
+
+        FScoringContext(const FVector& InBotLocation, const FVector& InTargetLocation, bool bInHasTarget, const FBotSidestepParams& Params,
+            TConstArrayView<FVector> InAllyLocations, const UBotPVSData* InPVS);
+
+        // Scores a candidate, higher is better. Returns false when the target can't be seen from it
+        bool Score(const FVector& Candidate, float& OutScore) const;
+    };
+
+    // Scores the ring of a single snapshot. Runs on a worker thread
+    static void EvaluateSnapshot(const FSnapshot& Snapshot, const UBotPVSData* PVS, int32 NumCandidatesToKeep, FScoredCandidates& OutCandidates);
+
+    // Checks how urgently the bot needs to sidestep, higher is more urgent
+    float GetUrgency(const FRequest& Request) const;
+
+    TMap<uint32, FRequest> Requests;
+    uint32 NextRequestId = 1;
+
+    // The worker task currently evaluating a batch of snapshots
+    UE::Tasks::TTask<TArray<FScoredCandidates>> EvaluationTask;
+    bool bEvaluationInFlight = false;
+
+    // Keeps the PVS alive while a worker task reads it
+    UPROPERTY()
+    TObjectPtr<const UBotPVSData> EvaluationPVS;
+};
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "BotSignificanceSubsystem.generated.h"
+
+class UBotRegistrySubsystem;
+
+/**
+ * Rates how much every bot matters right now, from 0 for a quiet bot to 1 for a bot in a fight, and scales the cost
+ * of its perception from that: the tick rate of its perception component, its target selection interval and how often
+ * its sight checks are queued.
+ * The score is the highest of three factors: how close the nearest player viewpoint is, how much enemy presence the
+ * influence map reports around the bot and how recently it took damage. It is evaluated every frame, so a bot wakes up
+ * at once when it gets hurt or an enemy comes close, and only fades back down over a few seconds.
+ */
+UCLASS()
+class BOTARENA_API UBotSignificanceSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // USubsystem
+    virtual void Deinitialize() override;
+
+    // UWorldSubsystem
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    // FTickableGameObject
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    // Check if perception scales with significance (BotArena.Significance.Enabled)
+    static bool IsEnabled();
+
+    // Get the significance of a bot, 1 when it isn't known or the scaling is disabled
+    float GetSignificance(const AActor* Bot) const;
+
+    // Get the number of sense updates between two sight updates of a bot
+    int32 GetSightInterval(const AActor* Bot) const;
+
+    // Raises a bot to full significance right away, e.g. because it heard gunfire. It fades out like any other
+    void WakeUp(const AActor* Bot);
+
+protected:
+    // Collects the view locations of the local players
+    void GatherViewers();
+
+    // Get the significance under which the frame budget puts bots on the quiet perception LOD
+    float GetBudgetCutoff() const;
+
+    // Computes the unsmoothed significance of the bot in a registry slot
+    float ComputeSignificance(const UBotRegistrySubsystem& Registry, int32 Slot, double Now) const;
+
+    // Smoothed significance by registry slot
+    TArray<float> SignificanceBySlot;
+
+    // Bot stored in each slot when its significance was computed, to detect recycled slots
+    TArray<TWeakObjectPtr<AActor>> BotBySlot;
+
+    TArray<FVector> ViewerLocations;
+};
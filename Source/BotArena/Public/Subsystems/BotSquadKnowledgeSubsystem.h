@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Components/BotTeamComponent.h"
+#include "BotSquadKnowledgeSubsystem.generated.h"
+
+class AAICharacter;
+class UBotPerceptionComponent;
+class UBotRegistrySubsystem;
+
+// A hostile bot known to a team
+struct FBotSharedThreat
+{
+    TWeakObjectPtr<AAICharacter> Bot;
+
+    // Registry slot of the hostile
+    int32 Slot = INDEX_NONE;
+
+    // The most recent sighting among all members
+    FVector LastSeenLocation = FVector::ZeroVector;
+    double LastSeenTime = 0.0;
+
+    // Number of members currently seeing it, 0 if it is only remembered
+    int32 NumSpotters = 0;
+};
+
+/**
+ * Knowledge shared by the members of a team, so bots fighting side by side don't all need to sense the same enemies.
+ * Every frame the threat tables of the members are merged into one set of known enemies per team, which target
+ * selection reads on top of each bot's own table. Members are also clustered into squads: the first bot of a cluster
+ * leads it and every teammate within the cluster radius follows. Followers rely on the squad and only run their own
+ * sight checks every few sense updates.
+ */
+UCLASS()
+class BOTARENA_API UBotSquadKnowledgeSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // USubsystem
+    virtual void Deinitialize() override;
+
+    // UWorldSubsystem
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    // FTickableGameObject
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    // Check if bots share their knowledge with their team (BotArena.Squad.Enabled)
+    static bool IsEnabled();
+
+    // Get how far from a bot the enemies seen by its teammates are considered as targets (BotArena.Squad.ShareRadius)
+    static float GetShareRadius();
+
+    // Get the number of sense updates between two sight updates of a follower (BotArena.Squad.FollowerSightInterval)
+    static int32 GetFollowerSightInterval();
+
+    // Get the enemies known to a team, merged from what its members sensed last frame
+    const TArray<FBotSharedThreat>& GetKnownEnemies(ETeam Team) const;
+
+    // Check if a bot follows a squad leader standing nearby
+    bool IsFollower(const AActor* Bot) const;
+
+protected:
+    static constexpr int32 NumTeams = 3;
+
+    // Merges the threat tables of the members into the known enemies of their team
+    void MergeKnowledge(const UBotRegistrySubsystem& Registry);
+
+    // Clusters the members of every team around leaders and flags the others as followers
+    void AssignFollowers(const UBotRegistrySubsystem& Registry);
+
+    TArray<FBotSharedThreat> KnownEnemies[NumTeams];
+
+    // Index into the known enemies of a team, by registry slot of the enemy
+    TArray<int32> EnemyIndexBySlot[NumTeams];
+
+    // Whether the enemy in a registry slot was seen by the team last frame
+    TArray<uint8> WasSeenBySlot[NumTeams];
+
+    // Follower flag by registry slot
+    TArray<uint8> FollowerBySlot;
+
+    // Scratch buffers, reused every frame
+    TArray<UBotPerceptionComponent*> MemberPerceptions[NumTeams];
+    TArray<int32> LeaderSlots;
+};
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "BotTargetSelectionSubsystem.generated.h"
+
+class UBotPerceptionComponent;
+class UBotRegistrySubsystem;
+
+/**
+ * Selects the target of every bot in a single pass per frame instead of running
+ * UBotPerceptionComponent::SelectTarget separately for each bot.
+ * Position, team and alive state of every registered bot are gathered once into structure-of-arrays buffers
+ * and the nearest hostile candidate of each bot is found with the vectorized kernels of FBotSpatialKernels.
+ * The candidates are the visible threats of each bot's threat table, plus the enemies its teammates nearby currently see
+ * when squad knowledge is enabled. Candidates that recently hurt the bot are treated
+ * as closer and, when the influence map is available, candidates standing among many of their allies as further away.
+ * Only bots whose visible threats changed or whose SelectTargetInterval expired are evaluated.
+ */
+UCLASS()
+class BOTARENA_API UBotTargetSelectionSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // USubsystem
+    virtual void Deinitialize() override;
+
+    // UWorldSubsystem
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    // FTickableGameObject
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    // Check if the batched selection replaces the per bot SelectTarget call (BotArena.Targeting.Batched)
+    static bool IsBatchingEnabled();
+
+    // Add a perception component to the batched selection
+    void RegisterPerception(UBotPerceptionComponent* Perception);
+
+    // Remove a perception component from the batched selection
+    void UnregisterPerception(UBotPerceptionComponent* Perception);
+
+    // Runs the batched selection for every registered bot that needs it
+    void SelectTargets();
+
+protected:
+    // Fills the structure-of-arrays buffers from the bot registry
+    void GatherBotData(const UBotRegistrySubsystem& Registry);
+
+    // Picks the closest hostile among the candidates of a single bot
+    void EvaluateBot(UBotPerceptionComponent& Perception, const UBotRegistrySubsystem& Registry);
+
+    // Registered perception components
+    TArray<TWeakObjectPtr<UBotPerceptionComponent>> Perceptions;
+
+    // Per bot data indexed by registry slot
+    TArray<float> BotX;
+    TArray<float> BotY;
+    TArray<float> BotZ;
+    TArray<uint8> BotTeam;
+    TArray<uint8> BotAlive;
+
+    // Scratch buffers holding the hostile candidates of the bot being evaluated
+    TArray<float> CandidateX;
+    TArray<float> CandidateY;
+    TArray<float> CandidateZ;
+    TArray<float> CandidateDistSquared;
+    TArray<float> CandidateScore;
+    TArray<float> CandidateDamage;
+    TArray<int32> CandidateSlot;
+};
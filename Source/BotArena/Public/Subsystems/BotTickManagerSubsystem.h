@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "BotTickManagerSubsystem.generated.h"
+
+class UBotPerceptionComponent;
+class UBotMovementComponent;
+
+/**
+ * Drives the per frame work of every bot from a single tick instead of one tick function per component.
+ * Registered components have their own tick disabled and are updated in three explicit phases, each one a walk over
+ * a contiguous array:
+ * - Sense: perception components take in their latest perception update and refresh their threat tables
+ * - Think: targets get selected, batched or per bot
+ * - Act: bots turn towards their target and meshes follow the crouch state
+ * Perception components keep the tick interval set by their perception LOD, the manager accumulates their delta time.
+ * Dormant components stay registered but are skipped.
+ */
+UCLASS()
+class BOTARENA_API UBotTickManagerSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // USubsystem
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+
+    // UWorldSubsystem
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    // FTickableGameObject
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    // Check if components register with the manager instead of ticking themselves (BotArena.TickManager.Enabled).
+    // Read when the world starts
+    bool IsEnabled() const { return bEnabled; }
+
+    // Take over the tick of a component. Its own tick function is disabled. Does nothing while the manager is disabled
+    void RegisterPerception(UBotPerceptionComponent* Perception);
+    void RegisterMovement(UBotMovementComponent* Movement);
+
+    // Stop updating a component
+    void UnregisterPerception(UBotPerceptionComponent* Perception);
+    void UnregisterMovement(UBotMovementComponent* Movement);
+
+    // Check if a component is driven by the manager
+    bool IsRegistered(UBotPerceptionComponent* Perception) const { return Perceptions.Contains(Perception); }
+    bool IsRegistered(UBotMovementComponent* Movement) const { return Movements.Contains(Movement); }
+
+protected:
+    void RunSensePhase(float DeltaTime);
+    void RunThinkPhase();
+    void RunActPhase();
+
+    // Registered components, one array per kind
+    TArray<TWeakObjectPtr<UBotPerceptionComponent>> Perceptions;
+    TArray<TWeakObjectPtr<UBotMovementComponent>> Movements;
+
+    // Per perception component, parallel to Perceptions: time since its last update and its delta for this frame,
+    // 0 when it isn't due
+    TArray<float> PerceptionElapsed;
+    TArray<float> PerceptionDelta;
+
+    bool bEnabled = true;
+};
@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Utils/BotTimerWheel.h"
+#include "BotTimerSubsystem.generated.h"
+
+/**
+ * One timer wheel for the one-shot timers of every bot: weapon effects, delayed destruction and the like.
+ * Setting and clearing a timer is constant time and the wheel fires the due timers in one batch per frame,
+ * so bots with nothing scheduled cost nothing. Timers are rounded to the wheel resolution and don't run while the
+ * game is paused.
+ */
+UCLASS()
+class BOTARENA_API UBotTimerSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // USubsystem
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+
+    // UWorldSubsystem
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    // FTickableGameObject
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    /**
+     * Runs a callback once after a delay. Capture objects weakly, the timer isn't cleared when they go away
+     * @param Delay - Seconds until the callback runs
+     * @param Callback - What to run
+     * @return The handle to clear the timer with
+     */
+    FBotTimerHandle SetTimer(float Delay, TFunction<void()>&& Callback);
+
+    // Clears a pending timer and invalidates the handle. Does nothing if it already fired
+    void ClearTimer(FBotTimerHandle& Handle);
+
+    // Check if a timer is still waiting to fire
+    bool IsTimerActive(const FBotTimerHandle& Handle) const { return Wheel.IsPending(Handle); }
+
+protected:
+    FBotTimerWheel Wheel;
+};
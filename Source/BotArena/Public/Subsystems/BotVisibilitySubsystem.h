@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "Subsystems/BotSceneQuerySubsystem.h"
+#include "BotVisibilitySubsystem.generated.h"
+
+class UBotPVSData;
+
+/**
+ * Caches the line of sight between pairs of actors so that both bots of a duel share a single trace.
+ * Pairs are unordered, so asking A->B and B->A reads the same entry.
+ * Stale entries are refreshed through a high priority line trace of UBotSceneQuerySubsystem and the last known answer
+ * is returned until the result arrives. Only the first lookup of a pair traces synchronously, it has no answer yet.
+ * When a PVS was baked for the map, pairs whose cells can't see each other are rejected without any trace.
+ */
+UCLASS()
+class BOTARENA_API UBotVisibilitySubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // USubsystem
+    virtual void Deinitialize() override;
+
+    // UWorldSubsystem
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+    // FTickableGameObject
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    /**
+     * Checks if there's a clear line of sight between the two actors
+     * @param From - One end of the line
+     * @param To - The other end of the line
+     * @return The cached visibility, traced on the spot the first time the pair is asked for
+     */
+    bool CanSee(const AActor* From, const AActor* To);
+
+    /**
+     * Checks the baked PVS of the map
+     * @return False when the static geometry blocks every line between the two locations. True when unsure or when there's no PVS
+     */
+    bool IsPotentiallyVisible(const FVector& From, const FVector& To) const;
+
+    // Get the PVS used by IsPotentiallyVisible, or nullptr when there's none or it's disabled
+    const UBotPVSData* GetPVSData() const;
+
+protected:
+    struct FPairKey
+    {
+        FObjectKey First;
+        FObjectKey Second;
+
+        FPairKey(const AActor* A, const AActor* B)
+        {
+            // Order the pair so that both directions map to the same key
+            const FObjectKey KeyA(A);
+            const FObjectKey KeyB(B);
+            First = KeyA < KeyB ? KeyA : KeyB;
+            Second = KeyA < KeyB ? KeyB : KeyA;
+        }
+
+        bool operator==(const FPairKey& Other) const { return First == Other.First && Second == Other.Second; }
+
+        friend uint32 GetTypeHash(const FPairKey& Key) { return HashCombine(GetTypeHash(Key.First), GetTypeHash(Key.Second)); }
+    };
+
+    struct FPairEntry
+    {
+        // The frame the last trace result arrived on
+        uint64 ResultFrame = 0;
+        bool bHasResult = false;
+        bool bVisible = false;
+        bool bTracePending = false;
+    };
+
+    // Traces the line of sight between the two actors synchronously
+    bool TraceNow(const AActor* From, const AActor* To) const;
+
+    // Queues a trace for the given pair
+    void RequestTrace(const FPairKey& Key, FPairEntry& Entry, const AActor* From, const AActor* To);
+
+    // Applies the results of the traces that completed since the last frame
+    void CollectTraceResults();
+
+    // The PVS baked for this map, if any
+    UPROPERTY()
+    TObjectPtr<UBotPVSData> PVSData;
+
+    TMap<FPairKey, FPairEntry> Pairs;
+
+    // Pending traces and the pair they were issued for
+    TArray<TPair<FPairKey, FBotSceneQueryHandle>> PendingTraces;
+
+    // Reused buffer for the trace hits
+    TArray<FHitResult> TraceHits;
+};
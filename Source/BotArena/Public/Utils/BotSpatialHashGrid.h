@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * A uniform 2D spatial hash grid that buckets integer ids by the XY cell they stand in.
+ * The grid does not own any positions: callers keep the id -> location mapping and tell the grid
+ * when an id has crossed into a new cell, so a frame where nobody crosses a cell costs nothing.
+ */
+class BOTARENA_API FBotSpatialHashGrid
+{
+public:
+    explicit FBotSpatialHashGrid(float InCellSize = 500.0f);
+
+    /**
+     * Changes the cell size. Only allowed while the grid is empty since existing buckets would be invalidated
+     * @param InCellSize - The new edge length of a cell in world units
+     */
+    void SetCellSize(float InCellSize);
+
+    // Get the edge length of a cell
+    float GetCellSize() const { return CellSize; }
+
+    // Get the cell that contains the given location
+    FIntPoint GetCellCoord(const FVector& Location) const;
+
+    // Add an id to the given cell
+    void Add(int32 Id, const FIntPoint& Cell);
+
+    // Remove an id from the given cell
+    void Remove(int32 Id, const FIntPoint& Cell);
+
+    /**
+     * Moves an id to the cell of NewLocation if it has crossed a cell border
+     * @param Id - The id to move
+     * @param InOutCell - The cell the id is currently stored in. Updated if the id moved
+     * @param NewLocation - The new location of the id
+     * @return True if the id changed cell
+     */
+    bool Move(int32 Id, FIntPoint& InOutCell, const FVector& NewLocation);
+
+    // Get the ids of a single cell, or nullptr if nothing was ever stored there
+    const TArray<int32>* FindCell(const FIntPoint& Cell) const { return Cells.Find(Cell); }
+
+    // Remove every id from the grid
+    void Reset();
+
+    /**
+     * Visits every id stored in a cell that overlaps the XY bounding square of the given circle.
+     * The caller is expected to do the exact distance test since cells are coarser than the radius
+     */
+    template<typename FuncType>
+    void ForEachInRadius(const FVector& Center, float Radius, FuncType&& Func) const
+    {
+        const FIntPoint MinCell = GetCellCoord(Center - FVector(Radius, Radius, 0.0f));
+        const FIntPoint MaxCell = GetCellCoord(Center + FVector(Radius, Radius, 0.0f));
+
+        for (int32 CellX = MinCell.X; CellX <= MaxCell.X; CellX++)
+        {
+            for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; CellY++)
+            {
+                if (const TArray<int32>* CellIds = Cells.Find(FIntPoint(CellX, CellY)))
+                {
+                    for (const int32 Id : *CellIds)
+                    {
+                        Func(Id);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    float CellSize;
+    float InvCellSize;
+
+    // Cells are kept once created so bots walking back and forth do not reallocate buckets
+    TMap<FIntPoint, TArray<int32>> Cells;
+    int32 NumIds;
+};
@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Vectorized math kernels that work on structure-of-arrays buffers.
+ * Every kernel processes four lanes at a time through the engine's VectorRegister abstraction
+ * and finishes the remainder with scalar code, so the buffers don't need any padding or alignment.
+ */
+class BOTARENA_API FBotSpatialKernels
+{
+public:
+    /**
+     * Computes the squared distance of every point to the origin
+     * @param Xs, Ys, Zs - The point coordinates
+     * @param Num - The number of points
+     * @param Origin - The point to measure against
+     * @param OutDistSquared - Receives Num squared distances
+     */
+    static void DistanceSquared(const float* Xs, const float* Ys, const float* Zs, int32 Num, const FVector3f& Origin, float* OutDistSquared);
+
+    /**
+     * Computes the dot product of every point's offset from the origin with a direction
+     * @param Xs, Ys, Zs - The point coordinates
+     * @param Num - The number of points
+     * @param Origin - The point the offsets are measured from
+     * @param Direction - The direction to project on, usually normalized
+     * @param OutDot - Receives Num dot products
+     */
+    static void DotDirection(const float* Xs, const float* Ys, const float* Zs, int32 Num, const FVector3f& Origin, const FVector3f& Direction, float* OutDot);
+
+    /**
+     * Finds the index of the smallest value
+     * @return The index of the smallest value, or INDEX_NONE if Num is 0
+     */
+    static int32 FindMinIndex(const float* Values, int32 Num);
+
+    /**
+     * Multiplies every value by the same factor, in place
+     * @param Values - The values to scale
+     * @param Num - The number of values
+     * @param Factor - The factor to apply
+     */
+    static void Scale(float* Values, int32 Num, float Factor);
+
+    /**
+     * Adds scaled source values to the destination values, in place (Dst += Src * Factor)
+     * @param Dst - The values to add to
+     * @param Src - The values to add, Num of them
+     * @param Num - The number of values
+     * @param Factor - The factor applied to the source values
+     */
+    static void AddScaled(float* Dst, const float* Src, int32 Num, float Factor);
+};
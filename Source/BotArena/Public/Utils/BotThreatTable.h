@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// What a bot remembers about one threat
+struct FBotThreatEntry
+{
+    TWeakObjectPtr<AActor> Actor;
+
+    // Where the threat was last seen, or where its shots came from
+    FVector LastSeenLocation = FVector::ZeroVector;
+
+    // World time of the last sighting or hit
+    double LastSeenTime = 0.0;
+
+    // Damage dealt to the bot, fading out over time
+    float DamageDealt = 0.f;
+
+    // Whether the threat is currently sensed
+    bool bVisible = false;
+};
+
+/**
+ * A fixed capacity memory of the threats a bot knows about, so target choice survives sparse or budgeted perception updates.
+ * Entries live inline and packed at the front of the table, updates never allocate. When the table is full a new threat
+ * replaces the least relevant entry: hidden threats are less relevant than visible ones, older sightings less than
+ * recent ones and threats that hurt the bot are kept longer.
+ */
+class BOTARENA_API FBotThreatTable
+{
+public:
+    static constexpr int32 Capacity = 16;
+
+    /**
+     * Records that a threat is sensed, or that it just got lost
+     * @param Actor - The threat
+     * @param Location - Where it was sensed
+     * @param Time - The current world time
+     * @param bVisible - False if the threat was lost
+     * @return True if the threat is new or its visibility changed
+     */
+    bool NoteSighting(AActor* Actor, const FVector& Location, double Time, bool bVisible);
+
+    /**
+     * Records damage dealt by a threat, which adds it to the table even when it isn't sensed
+     * @param Actor - The threat
+     * @param Location - Where the threat was when it hit
+     * @param Damage - The damage dealt
+     * @param Time - The current world time
+     */
+    void NoteDamage(AActor* Actor, const FVector& Location, float Damage, double Time);
+
+    /**
+     * Records that a threat was heard, which adds it to the table even when it isn't sensed
+     * @param Actor - The threat
+     * @param Location - Where the noise came from
+     * @param Time - The current world time
+     */
+    void NoteHeard(AActor* Actor, const FVector& Location, double Time);
+
+    /**
+     * Moves the visible threats to their current location, fades out the damage and forgets the threats that are gone
+     * or weren't seen for a while
+     * @param Time - The current world time
+     * @param DeltaTime - The time since the last update
+     * @param ForgetTime - Seconds after which a hidden threat is forgotten
+     * @param DamageHalfLife - Seconds after which the remembered damage has faded to half
+     */
+    void Update(double Time, float DeltaTime, float ForgetTime, float DamageHalfLife);
+
+    // Forget every threat the predicate returns true for
+    template<typename PredicateType>
+    void RemoveAll(PredicateType&& Predicate)
+    {
+        for (int32 Index = NumEntries - 1; Index >= 0; Index--)
+        {
+            if (Predicate(Entries[Index]))
+            {
+                RemoveAt(Index);
+            }
+        }
+    }
+
+    // Forget every threat
+    void Reset();
+
+    // Get the remembered threat of an actor, or nullptr
+    const FBotThreatEntry* Find(const AActor* Actor) const;
+
+    // Get the number of remembered threats
+    int32 Num() const { return NumEntries; }
+
+    const FBotThreatEntry& operator[](int32 Index) const
+    {
+        check(Index >= 0 && Index < NumEntries);
+        return Entries[Index];
+    }
+
+    const FBotThreatEntry* begin() const { return Entries; }
+    const FBotThreatEntry* end() const { return Entries + NumEntries; }
+
+private:
+    int32 FindIndex(const AActor* Actor) const;
+
+    // Get the entry of a threat, adding it if it isn't known yet
+    FBotThreatEntry& FindOrAddEntry(AActor* Actor, double Time);
+
+    // Get a slot for a new threat, replacing the least relevant entry if the table is full
+    int32 AddEntry(double Time);
+
+    void RemoveAt(int32 Index);
+
+    static float GetRelevance(const FBotThreatEntry& Entry, double Time);
+
+    FBotThreatEntry Entries[Capacity];
+    int32 NumEntries = 0;
+};
@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Identifies a timer scheduled on a FBotTimerWheel. Stays safe to use after the timer fired or was cancelled
+struct FBotTimerHandle
+{
+    bool IsValid() const { return Index != INDEX_NONE; }
+    void Invalidate() { Index = INDEX_NONE; Serial = 0; }
+
+private:
+    friend class FBotTimerWheel;
+
+    int32 Index = INDEX_NONE;
+    uint32 Serial = 0;
+};
+
+/**
+ * A hierarchical timer wheel: one-shot timers rounded to a fixed tick length, scheduled and cancelled in constant time.
+ * Level 0 holds one slot per tick for the next SlotsPerLevel ticks, every higher level covers SlotsPerLevel times the
+ * span of the level below with slots of the same count. When level 0 wraps around, the next slot of the level above is
+ * cascaded down, so a timer is only touched again once per level on its way to firing.
+ * Advancing the wheel fires every timer of a due slot in one batch. Timers live in a pooled node array linked into
+ * their slot, nothing is allocated once the pool has grown to the number of pending timers.
+ */
+class BOTARENA_API FBotTimerWheel
+{
+public:
+    static constexpr int32 SlotBits = 6;
+    static constexpr int32 SlotsPerLevel = 1 << SlotBits;
+    static constexpr int32 NumLevels = 4;
+
+    explicit FBotTimerWheel(double InTickLength = 1.0 / 60.0);
+
+    /**
+     * Schedules a callback
+     * @param Delay - Seconds until it fires, rounded to the tick length. Fires on the next tick when not positive
+     * @param Callback - What to run. It may schedule and cancel timers itself
+     * @return The handle to cancel the timer with
+     */
+    FBotTimerHandle Schedule(double Delay, TFunction<void()>&& Callback);
+
+    // Cancels a pending timer and invalidates the handle. Returns false if the timer already fired or was cancelled
+    bool Cancel(FBotTimerHandle& Handle);
+
+    // Check if a timer is still waiting to fire
+    bool IsPending(const FBotTimerHandle& Handle) const;
+
+    // Moves the wheel forward and fires the timers that came due
+    void Advance(double DeltaTime);
+
+    // Drops every pending timer without firing it
+    void Reset();
+
+    // Get the number of pending timers
+    int32 Num() const { return NumPending; }
+
+    double GetTickLength() const { return TickLength; }
+
+private:
+    struct FNode
+    {
+        TFunction<void()> Callback;
+        uint64 ExpiryTick = 0;
+        int32 Prev = INDEX_NONE;
+        int32 Next = INDEX_NONE;
+
+        // Slot the node is linked into, FiringSlot while its batch fires or INDEX_NONE when free
+        int32 Slot = INDEX_NONE;
+
+        // Bumped whenever the node is freed, so stale handles don't match
+        uint32 Serial = 1;
+    };
+
+    static constexpr int32 FiringSlot = -2;
+
+    // Links a node into the slot matching its expiry tick
+    void Link(int32 NodeIndex);
+    void Unlink(int32 NodeIndex);
+    void FreeNode(int32 NodeIndex);
+
+    // Re-links the timers of a slot of a higher level into the levels below. Returns the slot index within the level
+    int32 Cascade(int32 Level);
+
+    // Processes CurrentTick: cascades if level 0 wrapped, then fires the due slot
+    void ProcessTick();
+
+    double TickLength;
+
+    // Time accumulated towards the next tick
+    double PendingTime = 0.0;
+
+    // The next tick to process
+    uint64 CurrentTick = 0;
+
+    TArray<FNode> Nodes;
+
+    // First node of every slot, level after level
+    TArray<int32> SlotHeads;
+
+    // Chain of free nodes through FNode::Next
+    int32 FirstFree = INDEX_NONE;
+
+    int32 NumPending = 0;
+
+    // Scratch buffer for the batch being fired, as node index and serial
+    TArray<TPair<int32, uint32>> FiringBatch;
+};